@@ -0,0 +1,199 @@
+#include "allocator.h"
+#include "math/math.h"
+#include "util.h"
+#include <stdlib.h>
+
+#define ALIGNMENT 16
+#define ALIGN(n) (((n) + ALIGNMENT - 1) & ~((size_t) ALIGNMENT - 1))
+#define ARENA_HEADER_SIZE ALIGN(sizeof(ArenaBlock))
+
+#ifdef _MSC_VER
+#define lovrAtomicExchange(p, x) _InterlockedExchange((volatile long*) (p), (x))
+#else
+#define lovrAtomicExchange(p, x) __atomic_exchange_n((p), (x), __ATOMIC_ACQ_REL)
+#endif
+
+static _Thread_local Arena arena;
+static Pool* pools[MAX_POOLS];
+static int poolCount;
+static int poolLock;
+static bool tracking;
+static int frameAllocations;
+static int lastFrameAllocations;
+static uint64_t allocations;
+
+// Pool locks are only held for a few instructions, so a spinlock is cheaper than a mutex and can be
+// used without any initialization
+static void lovrSpinLock(int* lock) {
+  while (lovrAtomicExchange(lock, 1)) {}
+}
+
+static void lovrSpinUnlock(int* lock) {
+  lovrAtomicExchange(lock, 0);
+}
+
+static ArenaBlock* lovrArenaGrow(size_t size) {
+  size_t blockSize = MAX(size, ARENA_BLOCK_SIZE);
+  ArenaBlock* block = malloc(ARENA_HEADER_SIZE + blockSize);
+  lovrAssert(block, "Out of memory");
+  block->prev = arena.block;
+  block->size = blockSize;
+  block->used = 0;
+  arena.block = block;
+  return block;
+}
+
+void* lovrArenaAlloc(size_t size) {
+  size = ALIGN(size);
+  ArenaBlock* block = arena.block;
+
+  if (!block || block->used + size > block->size) {
+    block = lovrArenaGrow(size);
+  }
+
+  void* p = (char*) block + ARENA_HEADER_SIZE + block->used;
+  block->used += size;
+  arena.used += size;
+  arena.peak = MAX(arena.peak, arena.used);
+  return p;
+}
+
+ArenaMark lovrArenaMark() {
+  return (ArenaMark) { arena.block, arena.block ? arena.block->used : 0, arena.used };
+}
+
+void lovrArenaRestore(ArenaMark mark) {
+  while (arena.block != mark.block) {
+    ArenaBlock* prev = arena.block->prev;
+    free(arena.block);
+    arena.block = prev;
+  }
+
+  if (arena.block) {
+    arena.block->used = mark.blockUsed;
+  }
+
+  arena.used = mark.used;
+}
+
+// If the arena overflowed into multiple blocks, they're replaced with a single block large enough
+// to hold all of them, so a steady workload settles into one block and never hits malloc.  Blocks
+// bigger than ARENA_MAX_SIZE are given back instead of being kept around.
+void lovrArenaReset() {
+  if (arena.block && (arena.block->prev || arena.block->size > ARENA_MAX_SIZE)) {
+    size_t size = 0;
+    while (arena.block) {
+      ArenaBlock* prev = arena.block->prev;
+      size += arena.block->size;
+      free(arena.block);
+      arena.block = prev;
+    }
+
+    if (size <= ARENA_MAX_SIZE) {
+      lovrArenaGrow(size);
+    }
+  }
+
+  if (arena.block) {
+    arena.block->used = 0;
+  }
+
+  arena.used = 0;
+  arena.peak = 0;
+}
+
+void* lovrPoolAlloc(Pool* pool) {
+  lovrSpinLock(&pool->lock);
+
+  if (!pool->registered) {
+    lovrSpinLock(&poolLock);
+    if (poolCount < MAX_POOLS) {
+      pools[poolCount++] = pool;
+    }
+    lovrSpinUnlock(&poolLock);
+    pool->registered = true;
+  }
+
+  // Chunks are never returned to the system, the pool keeps them until the program exits
+  if (!pool->next) {
+    size_t stride = ALIGN(MAX(pool->size, sizeof(void*)));
+    char* chunk = malloc(stride * POOL_CHUNK_COUNT);
+    if (!chunk) {
+      lovrSpinUnlock(&pool->lock);
+      return NULL;
+    }
+
+    vec_push(&pool->chunks, chunk);
+    for (int i = POOL_CHUNK_COUNT - 1; i >= 0; i--) {
+      void** item = (void**) (chunk + i * stride);
+      *item = pool->next;
+      pool->next = item;
+    }
+  }
+
+  void* p = pool->next;
+  pool->next = *(void**) p;
+  pool->count++;
+  pool->peak = MAX(pool->peak, pool->count);
+  pool->allocations++;
+  lovrSpinUnlock(&pool->lock);
+
+  lovrMemoryCount();
+  return p;
+}
+
+void lovrPoolFree(Pool* pool, void* p) {
+  if (!p) return;
+  lovrSpinLock(&pool->lock);
+  *(void**) p = pool->next;
+  pool->next = p;
+  pool->count--;
+  lovrSpinUnlock(&pool->lock);
+}
+
+void* lovrAllocPooled(Pool* pool, void (*destructor)(void* object)) {
+  void* object = lovrPoolAlloc(pool);
+  if (!object) return NULL;
+  *((Ref*) object) = (Ref) { destructor, 1, 0, false };
+  return object;
+}
+
+bool lovrMemoryIsTracking() {
+  return tracking;
+}
+
+void lovrMemorySetTracking(bool enabled) {
+  tracking = enabled;
+}
+
+void lovrMemoryCount() {
+  if (tracking) {
+    lovrAtomicIncrement(&frameAllocations);
+  }
+}
+
+void lovrMemoryFrame() {
+  lastFrameAllocations = lovrAtomicExchange(&frameAllocations, 0);
+  allocations += lastFrameAllocations;
+  lovrArenaReset();
+}
+
+// Arena statistics describe the arena of the calling thread
+void lovrMemoryGetStats(MemoryStats* stats) {
+  stats->frameAllocations = frameAllocations;
+  stats->lastFrameAllocations = lastFrameAllocations;
+  stats->allocations = allocations + frameAllocations;
+  stats->arenaUsed = arena.used;
+  stats->arenaPeak = arena.peak;
+  stats->arenaSize = 0;
+  for (ArenaBlock* block = arena.block; block; block = block->prev) {
+    stats->arenaSize += block->size;
+  }
+}
+
+Pool** lovrMemoryGetPools(int* count) {
+  lovrSpinLock(&poolLock);
+  *count = poolCount;
+  lovrSpinUnlock(&poolLock);
+  return pools;
+}
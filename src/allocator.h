@@ -0,0 +1,73 @@
+#include "lib/vec/vec.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#pragma once
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_MAX_SIZE (4 * 1024 * 1024)
+#define POOL_CHUNK_COUNT 64
+#define MAX_POOLS 16
+
+// Linear allocator for temporary memory.  Each thread has its own arena, so allocations don't need
+// to be synchronized.  Memory is released in bulk, either by restoring a mark taken earlier or by
+// resetting the arena (the main thread's arena is reset once per frame).
+typedef struct ArenaBlock {
+  struct ArenaBlock* prev;
+  size_t size;
+  size_t used;
+} ArenaBlock;
+
+typedef struct {
+  ArenaBlock* block;
+  size_t used;
+  size_t peak;
+} Arena;
+
+typedef struct {
+  ArenaBlock* block;
+  size_t blockUsed;
+  size_t used;
+} ArenaMark;
+
+// Free list allocator for objects of a single type.  Pools are usually declared as static
+// variables next to the type they hold and are registered lazily the first time they're used.
+typedef struct {
+  const char* name;
+  size_t size;
+  void* next;
+  vec_void_t chunks;
+  size_t count;
+  size_t peak;
+  uint64_t allocations;
+  int lock;
+  bool registered;
+} Pool;
+
+#define POOL_INIT(name, type) { name, sizeof(type), NULL, { NULL, 0, 0 }, 0, 0, 0, 0, false }
+
+typedef struct {
+  uint64_t allocations;
+  uint64_t frameAllocations;
+  uint64_t lastFrameAllocations;
+  size_t arenaUsed;
+  size_t arenaPeak;
+  size_t arenaSize;
+} MemoryStats;
+
+void* lovrArenaAlloc(size_t size);
+ArenaMark lovrArenaMark();
+void lovrArenaRestore(ArenaMark mark);
+void lovrArenaReset();
+
+void* lovrPoolAlloc(Pool* pool);
+void lovrPoolFree(Pool* pool, void* p);
+void* lovrAllocPooled(Pool* pool, void (*destructor)(void* object));
+
+bool lovrMemoryIsTracking();
+void lovrMemorySetTracking(bool tracking);
+void lovrMemoryCount();
+void lovrMemoryFrame();
+void lovrMemoryGetStats(MemoryStats* stats);
+Pool** lovrMemoryGetPools(int* count);
@@ -4,6 +4,7 @@
 #include "math/math.h"
 #include "math/randomGenerator.h"
 #include "physics/physics.h"
+#include "thread/channel.h"
 #include "lib/map/map.h"
 
 // Module loaders
@@ -45,18 +46,23 @@ extern const luaL_Reg lovrController[];
 extern const luaL_Reg lovrCylinderShape[];
 extern const luaL_Reg lovrCollider[];
 extern const luaL_Reg lovrDistanceJoint[];
+extern const luaL_Reg lovrFile[];
 extern const luaL_Reg lovrFont[];
+extern const luaL_Reg lovrHeightfieldShape[];
 extern const luaL_Reg lovrHingeJoint[];
 extern const luaL_Reg lovrJoint[];
 extern const luaL_Reg lovrMaterial[];
 extern const luaL_Reg lovrMesh[];
+extern const luaL_Reg lovrMeshShape[];
 extern const luaL_Reg lovrModel[];
 extern const luaL_Reg lovrModelData[];
 extern const luaL_Reg lovrRandomGenerator[];
 extern const luaL_Reg lovrRasterizer[];
+extern const luaL_Reg lovrReadRequest[];
 extern const luaL_Reg lovrShader[];
 extern const luaL_Reg lovrShape[];
 extern const luaL_Reg lovrSliderJoint[];
+extern const luaL_Reg lovrSoundData[];
 extern const luaL_Reg lovrSource[];
 extern const luaL_Reg lovrSphereShape[];
 extern const luaL_Reg lovrTexture[];
@@ -76,8 +82,12 @@ extern map_int_t ControllerAxes;
 extern map_int_t ControllerButtons;
 extern map_int_t ControllerHands;
 extern map_int_t DrawModes;
+extern map_int_t EventOverflowModes;
 extern map_int_t EventTypes;
+extern map_int_t FileModes;
 extern map_int_t FilterModes;
+extern map_int_t GraphicsPassTypes;
+extern map_int_t GraphicsStatTypes;
 extern map_int_t HeadsetEyes;
 extern map_int_t HeadsetOrigins;
 extern map_int_t HeadsetTypes;
@@ -90,10 +100,17 @@ extern map_int_t MatrixTypes;
 extern map_int_t MeshDrawModes;
 extern map_int_t MeshUsages;
 extern map_int_t PolygonWindings;
+extern map_int_t ProfileTracks;
+extern map_int_t RandomDistributions;
+extern map_int_t ReadStatuses;
 extern map_int_t ShapeTypes;
+extern map_int_t SmoothingModes;
+extern map_int_t SourceTypes;
+extern map_int_t StereoModes;
 extern map_int_t TextureFormats;
 extern map_int_t TextureTypes;
 extern map_int_t TimeUnits;
+extern map_int_t TransformFormats;
 extern map_int_t VerticalAligns;
 extern map_int_t WrapModes;
 
@@ -108,4 +125,6 @@ int luax_readtransform(lua_State* L, int index, mat4 transform, bool uniformScal
 Blob* luax_readblob(lua_State* L, int index, const char* debug);
 int luax_pushshape(lua_State* L, Shape* shape);
 int luax_pushjoint(lua_State* L, Joint* joint);
+void luax_checkvariant(lua_State* L, int index, Variant* variant);
+int luax_pushvariant(lua_State* L, Variant* variant);
 Seed luax_checkrandomseed(lua_State* L, int index);
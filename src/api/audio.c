@@ -2,7 +2,9 @@
 #include "audio/audio.h"
 #include "audio/source.h"
 #include "data/audioStream.h"
+#include "data/soundData.h"
 
+map_int_t SourceTypes;
 map_int_t TimeUnits;
 
 int l_lovrAudioInit(lua_State* L) {
@@ -10,11 +12,29 @@ int l_lovrAudioInit(lua_State* L) {
   luaL_register(L, NULL, lovrAudio);
   luax_registertype(L, "Source", lovrSource);
 
+  map_init(&SourceTypes);
+  map_set(&SourceTypes, "static", SOURCE_STATIC);
+  map_set(&SourceTypes, "stream", SOURCE_STREAM);
+
   map_init(&TimeUnits);
   map_set(&TimeUnits, "seconds", UNIT_SECONDS);
   map_set(&TimeUnits, "samples", UNIT_SAMPLES);
 
-  lovrAudioInit();
+  // The conf table keeps the device name alive after it's popped
+  const char* device = NULL;
+  luax_pushconf(L);
+  if (lua_istable(L, -1)) {
+    lua_getfield(L, -1, "audio");
+    if (lua_istable(L, -1)) {
+      lua_getfield(L, -1, "device");
+      device = lua_tostring(L, -1);
+      lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+  }
+  lua_pop(L, 1);
+
+  lovrAudioInit(device);
   return 1;
 }
 
@@ -23,6 +43,11 @@ int l_lovrAudioUpdate(lua_State* L) {
   return 0;
 }
 
+int l_lovrAudioClearCache(lua_State* L) {
+  lovrAudioClearCache();
+  return 0;
+}
+
 int l_lovrAudioGetDopplerEffect(lua_State* L) {
   float factor, speedOfSound;
   lovrAudioGetDopplerEffect(&factor, &speedOfSound);
@@ -59,6 +84,15 @@ int l_lovrAudioGetVelocity(lua_State* L) {
   return 3;
 }
 
+int l_lovrAudioGetVoiceCount(lua_State* L) {
+  int active, virtual, total;
+  lovrAudioGetVoiceCount(&active, &virtual, &total);
+  lua_pushinteger(L, active);
+  lua_pushinteger(L, virtual);
+  lua_pushinteger(L, total);
+  return 3;
+}
+
 int l_lovrAudioGetVolume(lua_State* L) {
   lua_pushnumber(L, lovrAudioGetVolume());
   return 1;
@@ -69,22 +103,72 @@ int l_lovrAudioIsSpatialized(lua_State* L) {
   return 1;
 }
 
-int l_lovrAudioNewSource(lua_State* L) {
+static AudioStream* luax_checkaudiostream(lua_State* L, int index, size_t bufferSize) {
+  Blob* blob = luax_readblob(L, index, "Source");
+  AudioStream* stream = lovrAudioStreamCreate(blob, bufferSize);
+  lovrRelease(blob);
+  if (!stream) {
+    luaL_error(L, "Could not decode Ogg audio source at '%s'", luaL_checkstring(L, index));
+    return NULL;
+  }
+  return stream;
+}
+
+// Static sources loaded from a path are decoded once and then served from the cache
+static SoundData* luax_checksounddata(lua_State* L, int index) {
   void** type;
-  AudioStream* stream;
-  if ((type = luax_totype(L, 1, AudioStream)) != NULL) {
-    stream = *type;
+  if ((type = luax_totype(L, index, SoundData)) != NULL) {
+    lovrRetain(*type);
+    return *type;
+  } else if ((type = luax_totype(L, index, AudioStream)) != NULL) {
+    return lovrSoundDataCreate(*type);
+  }
+
+  const char* path = lua_type(L, index) == LUA_TSTRING ? lua_tostring(L, index) : NULL;
+  SoundData* soundData = path ? lovrAudioGetCachedSound(path) : NULL;
+  if (soundData) {
+    lovrRetain(soundData);
+    return soundData;
+  }
+
+  AudioStream* stream = luax_checkaudiostream(L, index, 4096);
+  soundData = lovrSoundDataCreate(stream);
+  lovrRelease(stream);
+
+  if (path) {
+    lovrAudioCacheSound(path, soundData);
+  }
+
+  return soundData;
+}
+
+int l_lovrAudioNewSource(lua_State* L) {
+  const char* defaultType = luax_totype(L, 1, SoundData) ? "static" : "stream";
+  SourceType type = *(SourceType*) luax_optenum(L, 2, defaultType, &SourceTypes, "source type");
+  Source* source;
+
+  if (type == SOURCE_STATIC) {
+    SoundData* soundData = luax_checksounddata(L, 1);
+    source = lovrSourceCreateStatic(soundData);
+    lovrRelease(soundData);
   } else {
-    Blob* blob = luax_readblob(L, 1, "Source");
-    stream = lovrAudioStreamCreate(blob, 4096);
-    lovrRelease(blob);
-    if (!stream) {
-      luaL_error(L, "Could not decode Ogg audio source at '%s'", luaL_checkstring(L, 1));
-      return 0;
+    void** userdata;
+    AudioStream* stream;
+    lovrAssert(!luax_totype(L, 1, SoundData), "SoundData can only be used with static Sources");
+    int bufferCount = luaL_optinteger(L, 3, 4);
+    int bufferSize = luaL_optinteger(L, 4, 4096);
+    lovrAssert(bufferCount > 0 && bufferCount <= MAX_SOURCE_BUFFERS, "Source buffer count must be between 1 and %d", MAX_SOURCE_BUFFERS);
+    lovrAssert(bufferSize > 0, "Source buffer size must be positive");
+    if ((userdata = luax_totype(L, 1, AudioStream)) != NULL) {
+      stream = *userdata;
+      lovrRetain(stream);
+    } else {
+      stream = luax_checkaudiostream(L, 1, bufferSize);
     }
+    source = lovrSourceCreate(stream, bufferCount);
+    lovrRelease(stream);
   }
 
-  Source* source = lovrSourceCreate(stream);
   luax_pushtype(L, Source, source);
   lovrRelease(source);
   return 1;
@@ -150,10 +234,12 @@ int l_lovrAudioStop(lua_State* L) {
 
 const luaL_Reg lovrAudio[] = {
   { "update", l_lovrAudioUpdate },
+  { "clearCache", l_lovrAudioClearCache },
   { "getDopplerEffect", l_lovrAudioGetDopplerEffect },
   { "getOrientation", l_lovrAudioGetOrientation },
   { "getPosition", l_lovrAudioGetPosition },
   { "getVelocity", l_lovrAudioGetVelocity },
+  { "getVoiceCount", l_lovrAudioGetVoiceCount },
   { "getVolume", l_lovrAudioGetVolume },
   { "isSpatialized", l_lovrAudioIsSpatialized },
   { "newSource", l_lovrAudioNewSource },
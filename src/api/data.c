@@ -3,6 +3,7 @@
 #include "data/audioStream.h"
 #include "data/modelData.h"
 #include "data/rasterizer.h"
+#include "data/soundData.h"
 #include "data/textureData.h"
 
 int l_lovrDataInit(lua_State* L) {
@@ -11,6 +12,7 @@ int l_lovrDataInit(lua_State* L) {
   luax_registertype(L, "AudioStream", lovrAudioStream);
   luax_registertype(L, "ModelData", lovrModelData);
   luax_registertype(L, "Rasterizer", lovrRasterizer);
+  luax_registertype(L, "SoundData", lovrSoundData);
   luax_registertype(L, "TextureData", lovrTextureData);
   luax_registertype(L, "VertexData", lovrVertexData);
   return 1;
@@ -73,6 +75,28 @@ int l_lovrDataNewRasterizer(lua_State* L) {
   return 1;
 }
 
+int l_lovrDataNewSoundData(lua_State* L) {
+  void** type;
+  AudioStream* stream;
+  if ((type = luax_totype(L, 1, AudioStream)) != NULL) {
+    stream = *type;
+    lovrRetain(stream);
+  } else {
+    Blob* blob = luax_readblob(L, 1, "Sound");
+    stream = lovrAudioStreamCreate(blob, 4096);
+    lovrRelease(blob);
+    if (!stream) {
+      return luaL_error(L, "Could not decode Ogg audio at '%s'", luaL_checkstring(L, 1));
+    }
+  }
+
+  SoundData* soundData = lovrSoundDataCreate(stream);
+  luax_pushtype(L, SoundData, soundData);
+  lovrRelease(stream);
+  lovrRelease(soundData);
+  return 1;
+}
+
 int l_lovrDataNewTextureData(lua_State* L) {
   TextureData* textureData = NULL;
   if (lua_type(L, 1) == LUA_TNUMBER) {
@@ -106,6 +130,7 @@ const luaL_Reg lovrData[] = {
   { "newAudioStream", l_lovrDataNewAudioStream },
   { "newModelData", l_lovrDataNewModelData },
   { "newRasterizer", l_lovrDataNewRasterizer },
+  { "newSoundData", l_lovrDataNewSoundData },
   { "newTextureData", l_lovrDataNewTextureData },
   { "newVertexData", l_lovrDataNewVertexData },
   { NULL, NULL }
@@ -1,15 +1,53 @@
 #include "api.h"
 #include "event/event.h"
+#include "lib/glfw.h"
 
+map_int_t EventOverflowModes;
 map_int_t EventTypes;
 
+#define EVENT_BATCH_SIZE 64
+
 static int pollRef;
 
+// Events are taken off the queue in batches so polling doesn't lock it once per event
+static Event batch[EVENT_BATCH_SIZE];
+static int batchIndex;
+static int batchCount;
+
+// Finished async reads are delivered as events on the main thread
+// Releases events that were taken off the queue but never returned to Lua
+static void clearBatch() {
+  while (batchIndex < batchCount) {
+    lovrEventDestroyData(&batch[batchIndex++]);
+  }
+  batchIndex = batchCount = 0;
+}
+
+static void pumpFileReads() {
+  ReadRequest* request;
+  while (lovrReaderPoll(&request)) {
+    Event event = { .type = EVENT_FILE_READ, .data.fileread = { request } };
+    lovrEventPush(event);
+  }
+}
+
 static int nextEvent(lua_State* L) {
-  Event event;
+  if (batchIndex == batchCount) {
+    batchCount = lovrEventPollBatch(batch, EVENT_BATCH_SIZE);
+    batchIndex = 0;
+    if (batchCount == 0) {
+      return 0;
+    }
+  }
+
+  Event event = batch[batchIndex++];
 
-  if (!lovrEventPoll(&event)) {
-    return 0;
+  if (event.type == EVENT_CUSTOM) {
+    lua_pushstring(L, event.data.custom.name);
+    for (int i = 0; i < event.data.custom.count; i++) {
+      luax_pushvariant(L, &event.data.custom.data[i]);
+    }
+    return event.data.custom.count + 1;
   }
 
   luax_pushenum(L, &EventTypes, event.type);
@@ -34,8 +72,15 @@ static int nextEvent(lua_State* L) {
     case EVENT_THREAD_ERROR:
       luax_pushtype(L, Thread, event.data.threaderror.thread);
       lua_pushstring(L, event.data.threaderror.error);
+      lovrRelease(event.data.threaderror.thread);
+      free(event.data.threaderror.error);
       return 3;
 
+    case EVENT_FILE_READ:
+      luax_pushtype(L, ReadRequest, event.data.fileread.request);
+      lovrRelease(event.data.fileread.request);
+      return 2;
+
     case EVENT_CONTROLLER_ADDED:
       luax_pushtype(L, Controller, event.data.controlleradded.controller);
       lovrRelease(event.data.controlleradded.controller);
@@ -43,7 +88,7 @@ static int nextEvent(lua_State* L) {
 
     case EVENT_CONTROLLER_REMOVED:
       luax_pushtype(L, Controller, event.data.controllerremoved.controller);
-      lovrRelease(event.data.controlleradded.controller);
+      lovrRelease(event.data.controllerremoved.controller);
       return 2;
 
     case EVENT_CONTROLLER_PRESSED:
@@ -65,29 +110,67 @@ int l_lovrEventInit(lua_State* L) {
   lua_newtable(L);
   luaL_register(L, NULL, lovrEvent);
 
+  // Quitting returns out of the poll loop, so a restart can leave events from the last session
+  clearBatch();
+
   // Store nextEvent in the registry to avoid creating a closure every time we poll for events.
   lua_pushcfunction(L, nextEvent);
   pollRef = luaL_ref(L, LUA_REGISTRYINDEX);
 
+  map_init(&EventOverflowModes);
+  map_set(&EventOverflowModes, "grow", OVERFLOW_GROW);
+  map_set(&EventOverflowModes, "drop", OVERFLOW_DROP);
+  map_set(&EventOverflowModes, "block", OVERFLOW_BLOCK);
+
   map_init(&EventTypes);
   map_set(&EventTypes, "quit", EVENT_QUIT);
   map_set(&EventTypes, "focus", EVENT_FOCUS);
   map_set(&EventTypes, "mount", EVENT_MOUNT);
   map_set(&EventTypes, "threaderror", EVENT_THREAD_ERROR);
+  map_set(&EventTypes, "fileread", EVENT_FILE_READ);
   map_set(&EventTypes, "controlleradded", EVENT_CONTROLLER_ADDED);
   map_set(&EventTypes, "controllerremoved", EVENT_CONTROLLER_REMOVED);
   map_set(&EventTypes, "controllerpressed", EVENT_CONTROLLER_PRESSED);
   map_set(&EventTypes, "controllerreleased", EVENT_CONTROLLER_RELEASED);
 
   lovrEventInit();
+  lovrEventAddPump(glfwPollEvents);
+
+  if (!lovrReaderIsNotifying()) {
+    lovrEventAddPump(pumpFileReads);
+    lovrReaderSetNotify(true);
+  }
+
   return 1;
 }
 
 int l_lovrEventClear(lua_State* L) {
+  clearBatch();
   lovrEventClear();
   return 0;
 }
 
+int l_lovrEventGetCount(lua_State* L) {
+  lua_pushinteger(L, lovrEventGetCount() + (batchCount - batchIndex));
+  return 1;
+}
+
+int l_lovrEventGetDroppedCount(lua_State* L) {
+  lua_pushnumber(L, lovrEventGetDropped());
+  return 1;
+}
+
+int l_lovrEventGetOverflowMode(lua_State* L) {
+  luax_pushenum(L, &EventOverflowModes, lovrEventGetOverflow());
+  return 1;
+}
+
+int l_lovrEventSetOverflowMode(lua_State* L) {
+  EventOverflow overflow = *(EventOverflow*) luax_checkenum(L, 1, &EventOverflowModes, "event overflow mode");
+  lovrEventSetOverflow(overflow);
+  return 0;
+}
+
 int l_lovrEventPoll(lua_State* L) {
   lua_rawgeti(L, LUA_REGISTRYINDEX, pollRef);
   return 1;
@@ -98,8 +181,64 @@ int l_lovrEventPump(lua_State* L) {
   return 0;
 }
 
+// Converting strings and objects to variants copies or retains them, so every value is checked
+// before any of them are converted, otherwise an error partway through would leak the earlier ones
+static bool luax_isvariant(lua_State* L, int index) {
+  switch (lua_type(L, index)) {
+    case LUA_TNIL:
+    case LUA_TBOOLEAN:
+    case LUA_TNUMBER:
+    case LUA_TSTRING:
+      return true;
+
+    case LUA_TUSERDATA: {
+      if (!lua_getmetatable(L, index)) {
+        return false;
+      }
+
+      lua_getfield(L, -1, "name");
+      bool object = lua_type(L, -1) == LUA_TSTRING;
+      lua_pop(L, 2);
+      return object;
+    }
+
+    default:
+      return false;
+  }
+}
+
+// Events with names that aren't built in are custom events, which carry up to 4 values of the
+// same types that can be sent through a Channel.  They can be pushed from any thread.
+static int luax_pushcustomevent(lua_State* L) {
+  size_t length;
+  const char* name = luaL_checklstring(L, 1, &length);
+  int count = lua_gettop(L) - 1;
+  lovrAssert(length < MAX_EVENT_NAME_LENGTH, "Event name '%s' is too long (the maximum length is %d)", name, MAX_EVENT_NAME_LENGTH - 1);
+  lovrAssert(count <= MAX_EVENT_ARGUMENTS, "Too many values for event '%s' (the maximum is %d)", name, MAX_EVENT_ARGUMENTS);
+
+  for (int i = 0; i < count; i++) {
+    if (!luax_isvariant(L, i + 2)) {
+      return luaL_argerror(L, i + 2, "nil, boolean, number, string, or object expected");
+    }
+  }
+
+  Event event = { .type = EVENT_CUSTOM };
+  memcpy(event.data.custom.name, name, length + 1);
+  for (int i = 0; i < count; i++) {
+    luax_checkvariant(L, i + 2, &event.data.custom.data[i]);
+  }
+  event.data.custom.count = count;
+  lovrEventPush(event);
+  return 0;
+}
+
 int l_lovrEventPush(lua_State* L) {
-  EventType type = *(EventType*) luax_checkenum(L, 1, &EventTypes, "event type");
+  int* known = map_get(&EventTypes, luaL_checkstring(L, 1));
+  if (!known) {
+    return luax_pushcustomevent(L);
+  }
+
+  EventType type = *known;
   EventData data;
 
   switch (type) {
@@ -121,15 +260,23 @@ int l_lovrEventPush(lua_State* L) {
 
     case EVENT_THREAD_ERROR:
       data.threaderror.thread = luax_checktype(L, 2, Thread);
-      data.threaderror.error = luaL_checkstring(L, 3);
+      data.threaderror.error = strdup(luaL_checkstring(L, 3));
+      lovrRetain(data.threaderror.thread);
+      break;
+
+    case EVENT_FILE_READ:
+      data.fileread.request = luax_checktype(L, 2, ReadRequest);
+      lovrRetain(data.fileread.request);
       break;
 
     case EVENT_CONTROLLER_ADDED:
       data.controlleradded.controller = luax_checktype(L, 2, Controller);
+      lovrRetain(data.controlleradded.controller);
       break;
 
     case EVENT_CONTROLLER_REMOVED:
       data.controllerremoved.controller = luax_checktype(L, 2, Controller);
+      lovrRetain(data.controllerremoved.controller);
       break;
 
     case EVENT_CONTROLLER_PRESSED:
@@ -141,6 +288,9 @@ int l_lovrEventPush(lua_State* L) {
       data.controllerreleased.controller = luax_checktype(L, 2, Controller);
       data.controllerreleased.button = *(ControllerButton*) luax_checkenum(L, 3, &ControllerButtons, "button");
       break;
+
+    case EVENT_CUSTOM:
+      break;
   }
 
   Event event = { .type = type, .data = data };
@@ -170,6 +320,10 @@ int l_lovrEventQuit(lua_State* L) {
 
 const luaL_Reg lovrEvent[] = {
   { "clear", l_lovrEventClear },
+  { "getCount", l_lovrEventGetCount },
+  { "getDroppedCount", l_lovrEventGetDroppedCount },
+  { "getOverflowMode", l_lovrEventGetOverflowMode },
+  { "setOverflowMode", l_lovrEventSetOverflowMode },
   { "poll", l_lovrEventPoll },
   { "pump", l_lovrEventPump },
   { "push", l_lovrEventPush },
@@ -1,8 +1,127 @@
 #include "api.h"
 #include "filesystem/filesystem.h"
+#include "filesystem/file.h"
+#include "filesystem/reader.h"
 #include "data/blob.h"
 #include <stdlib.h>
 #include <string.h>
+#ifndef EMSCRIPTEN
+#include <luajit.h>
+#endif
+
+#ifdef LUAJIT_VERSION
+#define BYTECODE_VERSION LUAJIT_VERSION
+#else
+#define BYTECODE_VERSION LUA_RELEASE
+#endif
+
+#define BYTECODE_DIRECTORY ".bytecode"
+#define MAX_MODULE_TIMES 256
+
+map_int_t FileModes;
+map_int_t ReadStatuses;
+
+static struct {
+  bool enabled;
+  int modules;
+  int cached;
+  double readTime;
+  double compileTime;
+  double cacheTime;
+  int moduleTimesRef;
+  int moduleTimesCount;
+} loadStats;
+
+// Cached chunks are stored under a hash of their path, with a header recording the path, the
+// modification time of the source, and the Lua version that compiled them.
+static void getBytecodePath(const char* path, char* dest, size_t size) {
+  uint32_t hash = 2166136261u;
+  for (const char* c = path; *c; c++) {
+    hash = (hash ^ (uint8_t) *c) * 16777619u;
+  }
+  snprintf(dest, size, "%s/%08x.luac", BYTECODE_DIRECTORY, hash);
+}
+
+static int getBytecodeHeader(const char* path, char* dest, size_t size) {
+  long modified = lovrFilesystemGetLastModified(path);
+  return modified < 0 ? -1 : snprintf(dest, size, "LOVRBC\n%s\n%ld\n%s\n", BYTECODE_VERSION, modified, path);
+}
+
+static int writeBytecode(lua_State* L, const void* data, size_t size, void* userdata) {
+  vec_char_t* buffer = userdata;
+  vec_pusharr(buffer, (const char*) data, size);
+  return 0;
+}
+
+// The index only notices lovr's own writes, so the source is stat'd again in case it was edited
+// outside of lovr since the index was built
+static bool loadCachedChunk(lua_State* L, const char* path) {
+  lovrFilesystemUpdateIndex(path);
+  char header[LOVR_PATH_MAX + 128];
+  int headerSize = getBytecodeHeader(path, header, sizeof(header));
+  if (headerSize < 0 || headerSize >= (int) sizeof(header)) {
+    return false;
+  }
+
+  char cachePath[LOVR_PATH_MAX];
+  getBytecodePath(path, cachePath, LOVR_PATH_MAX);
+  if (!lovrFilesystemIsFile(cachePath)) {
+    return false;
+  }
+
+  size_t size;
+  char* data = lovrFilesystemRead(cachePath, &size);
+  if (!data) {
+    return false;
+  }
+
+  bool loaded = false;
+  if (size > (size_t) headerSize && !memcmp(data, header, headerSize)) {
+    if (luaL_loadbuffer(L, data + headerSize, size - headerSize, path) == 0) {
+      loaded = true;
+    } else {
+      lua_pop(L, 1);
+    }
+  }
+
+  free(data);
+  return loaded;
+}
+
+// Dumps the function on top of the stack to the cache, failures are ignored since it's only a cache
+static void cacheChunk(lua_State* L, const char* path) {
+  char header[LOVR_PATH_MAX + 128];
+  int headerSize = getBytecodeHeader(path, header, sizeof(header));
+  if (headerSize < 0 || headerSize >= (int) sizeof(header) || !lovrFilesystemGetSaveDirectory()) {
+    return;
+  }
+
+  vec_char_t buffer;
+  vec_init(&buffer);
+  vec_pusharr(&buffer, header, headerSize);
+  if (lua_dump(L, writeBytecode, &buffer) == 0) {
+    char cachePath[LOVR_PATH_MAX];
+    getBytecodePath(path, cachePath, LOVR_PATH_MAX);
+    lovrFilesystemCreateDirectory(BYTECODE_DIRECTORY);
+    lovrFilesystemWrite(cachePath, buffer.data, buffer.length, false);
+  }
+  vec_deinit(&buffer);
+}
+
+// Only the most recent modules are kept, in a ring buffer, so requiring in a loop doesn't grow it
+static void recordModuleTime(lua_State* L, const char* path, double time, bool cached) {
+  int slot = loadStats.moduleTimesCount++ % MAX_MODULE_TIMES;
+  lua_rawgeti(L, LUA_REGISTRYINDEX, loadStats.moduleTimesRef);
+  lua_createtable(L, 0, 3);
+  lua_pushstring(L, path);
+  lua_setfield(L, -2, "path");
+  lua_pushnumber(L, time);
+  lua_setfield(L, -2, "time");
+  lua_pushboolean(L, cached);
+  lua_setfield(L, -2, "cached");
+  lua_rawseti(L, -2, slot + 1);
+  lua_pop(L, 1);
+}
 
 // Returns a Blob, leaving stack unchanged.  The Blob must be released when finished.
 Blob* luax_readblob(lua_State* L, int index, const char* debug) {
@@ -12,14 +131,12 @@ Blob* luax_readblob(lua_State* L, int index, const char* debug) {
     return blob;
   } else {
     const char* path = luaL_checkstring(L, index);
-
-    size_t size;
-    void* data = lovrFilesystemRead(path, &size);
-    if (!data) {
+    Blob* blob = lovrFilesystemLoadBlob(path);
+    if (!blob) {
       luaL_error(L, "Could not read %s from '%s'", debug, path);
     }
 
-    return lovrBlobCreate(data, size, path);
+    return blob;
   }
 }
 
@@ -77,6 +194,20 @@ int l_lovrFilesystemInit(lua_State* L) {
   lua_newtable(L);
   luaL_register(L, NULL, lovrFilesystem);
   luax_registertype(L, "Blob", lovrBlob);
+  luax_registertype(L, "File", lovrFile);
+  luax_registertype(L, "ReadRequest", lovrReadRequest);
+
+  map_init(&FileModes);
+  map_set(&FileModes, "read", OPEN_READ);
+  map_set(&FileModes, "write", OPEN_WRITE);
+  map_set(&FileModes, "append", OPEN_APPEND);
+
+  map_init(&ReadStatuses);
+  map_set(&ReadStatuses, "pending", READ_PENDING);
+  map_set(&ReadStatuses, "active", READ_ACTIVE);
+  map_set(&ReadStatuses, "complete", READ_COMPLETE);
+  map_set(&ReadStatuses, "failed", READ_FAILED);
+  map_set(&ReadStatuses, "canceled", READ_CANCELED);
 
   lua_getglobal(L, "arg");
   lua_rawgeti(L, -1, -2);
@@ -86,6 +217,13 @@ int l_lovrFilesystemInit(lua_State* L) {
   lovrFilesystemInit(arg0, arg1);
   lua_pop(L, 3);
 
+  // Load timings start over when the Lua state is recreated on restart
+  bool bytecodeCacheEnabled = loadStats.enabled;
+  memset(&loadStats, 0, sizeof(loadStats));
+  loadStats.enabled = bytecodeCacheEnabled;
+  lua_newtable(L);
+  loadStats.moduleTimesRef = luaL_ref(L, LUA_REGISTRYINDEX);
+
   // Add custom package loader
   lua_getglobal(L, "table");
   lua_getfield(L, -1, "insert");
@@ -171,6 +309,60 @@ int l_lovrFilesystemGetLastModified(lua_State* L) {
   return 1;
 }
 
+int l_lovrFilesystemGetLoadStats(lua_State* L) {
+  lua_newtable(L);
+  lua_pushinteger(L, loadStats.modules);
+  lua_setfield(L, -2, "modules");
+  lua_pushinteger(L, loadStats.cached);
+  lua_setfield(L, -2, "cached");
+  lua_pushnumber(L, loadStats.readTime);
+  lua_setfield(L, -2, "readTime");
+  lua_pushnumber(L, loadStats.compileTime);
+  lua_setfield(L, -2, "compileTime");
+  lua_pushnumber(L, loadStats.cacheTime);
+  lua_setfield(L, -2, "cacheTime");
+  lua_pushnumber(L, loadStats.readTime + loadStats.compileTime + loadStats.cacheTime);
+  lua_setfield(L, -2, "totalTime");
+
+  // Files are listed oldest first, starting after the slot that will be overwritten next
+  int count = MIN(loadStats.moduleTimesCount, MAX_MODULE_TIMES);
+  int first = loadStats.moduleTimesCount - count;
+  lua_createtable(L, count, 0);
+  lua_rawgeti(L, LUA_REGISTRYINDEX, loadStats.moduleTimesRef);
+  for (int i = 0; i < count; i++) {
+    lua_rawgeti(L, -1, (first + i) % MAX_MODULE_TIMES + 1);
+    lua_rawseti(L, -3, i + 1);
+  }
+  lua_pop(L, 1);
+  lua_setfield(L, -2, "files");
+  return 1;
+}
+
+int l_lovrFilesystemGetReadStats(lua_State* L) {
+  ReaderStats stats = lovrReaderGetStats();
+  int finished = stats.completed + stats.failed;
+  lua_newtable(L);
+  lua_pushinteger(L, stats.requests);
+  lua_setfield(L, -2, "requests");
+  lua_pushinteger(L, lovrReaderGetPendingCount());
+  lua_setfield(L, -2, "pending");
+  lua_pushinteger(L, stats.completed);
+  lua_setfield(L, -2, "completed");
+  lua_pushinteger(L, stats.failed);
+  lua_setfield(L, -2, "failed");
+  lua_pushinteger(L, stats.canceled);
+  lua_setfield(L, -2, "canceled");
+  lua_pushnumber(L, stats.bytes);
+  lua_setfield(L, -2, "bytes");
+  lua_pushnumber(L, stats.readTime > 0 ? stats.bytes / stats.readTime : 0);
+  lua_setfield(L, -2, "throughput");
+  lua_pushnumber(L, finished > 0 ? stats.waitTime / finished : 0);
+  lua_setfield(L, -2, "averageWait");
+  lua_pushnumber(L, finished > 0 ? stats.readTime / finished : 0);
+  lua_setfield(L, -2, "averageRead");
+  return 1;
+}
+
 int l_lovrFilesystemGetRealDirectory(lua_State* L) {
   const char* path = luaL_checkstring(L, 1);
   lua_pushstring(L, lovrFilesystemGetRealDirectory(path));
@@ -221,6 +413,16 @@ int l_lovrFilesystemIsFile(lua_State* L) {
   return 1;
 }
 
+int l_lovrFilesystemIsBytecodeCacheEnabled(lua_State* L) {
+  lua_pushboolean(L, loadStats.enabled);
+  return 1;
+}
+
+int l_lovrFilesystemIsIndexEnabled(lua_State* L) {
+  lua_pushboolean(L, lovrFilesystemIsIndexEnabled());
+  return 1;
+}
+
 int l_lovrFilesystemIsFused(lua_State* L) {
   lua_pushboolean(L, lovrFilesystemIsFused());
   return 1;
@@ -228,6 +430,17 @@ int l_lovrFilesystemIsFused(lua_State* L) {
 
 int l_lovrFilesystemLoad(lua_State* L) {
   const char* path = luaL_checkstring(L, 1);
+  double start = lovrGetTicks() / 1e9;
+  loadStats.modules++;
+
+  if (loadStats.enabled && loadCachedChunk(L, path)) {
+    double time = lovrGetTicks() / 1e9 - start;
+    loadStats.cached++;
+    loadStats.cacheTime += time;
+    recordModuleTime(L, path, time, true);
+    return 1;
+  }
+
   size_t size;
   char* content = lovrFilesystemRead(path, &size);
 
@@ -235,12 +448,23 @@ int l_lovrFilesystemLoad(lua_State* L) {
     return luaL_error(L, "Could not read file '%s'", path);
   }
 
+  double readEnd = lovrGetTicks() / 1e9;
   int status = luaL_loadbuffer(L, content, size, path);
   free(content);
+  double compileEnd = lovrGetTicks() / 1e9;
+  loadStats.readTime += readEnd - start;
+  loadStats.compileTime += compileEnd - readEnd;
+
   switch (status) {
     case LUA_ERRMEM: return luaL_error(L, "Memory allocation error: %s", lua_tostring(L, -1));
     case LUA_ERRSYNTAX: return luaL_error(L, "Syntax error: %s", lua_tostring(L, -1));
-    default: return 1;
+    default:
+      if (loadStats.enabled) {
+        cacheChunk(L, path);
+        loadStats.cacheTime += lovrGetTicks() / 1e9 - compileEnd;
+      }
+      recordModuleTime(L, path, lovrGetTicks() / 1e9 - start, false);
+      return 1;
   }
 }
 
@@ -253,16 +477,32 @@ int l_lovrFilesystemMount(lua_State* L) {
 }
 
 int l_lovrFilesystemNewBlob(lua_State* L) {
-  size_t size;
   const char* path = luaL_checkstring(L, 1);
-  uint8_t* data = lovrFilesystemRead(path, &size);
-  lovrAssert(data, "Could not load file '%s'", path);
-  Blob* blob = lovrBlobCreate((void*) data, size, path);
+  Blob* blob = lovrFilesystemLoadBlob(path);
+  lovrAssert(blob, "Could not load file '%s'", path);
   luax_pushtype(L, Blob, blob);
   lovrRelease(blob);
   return 1;
 }
 
+int l_lovrFilesystemNewFile(lua_State* L) {
+  const char* path = luaL_checkstring(L, 1);
+  FileMode* mode = (FileMode*) luax_optenum(L, 2, "read", &FileModes, "file mode");
+  File* file = lovrFileCreate(path);
+  if (lovrFileOpen(file, *mode)) {
+    lovrRelease(file);
+    return luaL_error(L, "Could not open file '%s'", path);
+  }
+
+  if (lua_isnumber(L, 3)) {
+    lovrFileSetBuffer(file, lua_tointeger(L, 3));
+  }
+
+  luax_pushtype(L, File, file);
+  lovrRelease(file);
+  return 1;
+}
+
 int l_lovrFilesystemRead(lua_State* L) {
   const char* path = luaL_checkstring(L, 1);
   size_t size;
@@ -273,12 +513,40 @@ int l_lovrFilesystemRead(lua_State* L) {
   return 1;
 }
 
+int l_lovrFilesystemReadAsync(lua_State* L) {
+  const char* path = luaL_checkstring(L, 1);
+  int priority = luaL_optinteger(L, 2, 0);
+
+  // Without the event module nobody collects finished requests, so drop the queue's references here
+  if (!lovrReaderIsNotifying()) {
+    ReadRequest* finished;
+    while (lovrReaderPoll(&finished)) {
+      lovrRelease(finished);
+    }
+  }
+
+  ReadRequest* request = lovrReaderQueue(path, priority);
+  luax_pushtype(L, ReadRequest, request);
+  lovrRelease(request);
+  return 1;
+}
+
 int l_lovrFilesystemRemove(lua_State* L) {
   const char* path = luaL_checkstring(L, 1);
   lua_pushboolean(L, !lovrFilesystemRemove(path));
   return 1;
 }
 
+int l_lovrFilesystemSetBytecodeCacheEnabled(lua_State* L) {
+  loadStats.enabled = lua_toboolean(L, 1);
+  return 0;
+}
+
+int l_lovrFilesystemSetIndexEnabled(lua_State* L) {
+  lovrFilesystemSetIndexEnabled(lua_toboolean(L, 1));
+  return 0;
+}
+
 int l_lovrFilesystemSetIdentity(lua_State* L) {
   if (lua_isnoneornil(L, 1)) {
     lovrFilesystemSetIdentity(NULL);
@@ -311,20 +579,28 @@ const luaL_Reg lovrFilesystem[] = {
   { "getExecutablePath", l_lovrFilesystemGetExecutablePath },
   { "getIdentity", l_lovrFilesystemGetIdentity },
   { "getLastModified", l_lovrFilesystemGetLastModified },
+  { "getLoadStats", l_lovrFilesystemGetLoadStats },
+  { "getReadStats", l_lovrFilesystemGetReadStats },
   { "getRealDirectory", l_lovrFilesystemGetRealDirectory },
   { "getSaveDirectory", l_lovrFilesystemGetSaveDirectory },
   { "getSize", l_lovrFilesystemGetSize },
   { "getSource", l_lovrFilesystemGetSource },
   { "getUserDirectory", l_lovrFilesystemGetUserDirectory },
+  { "isBytecodeCacheEnabled", l_lovrFilesystemIsBytecodeCacheEnabled },
   { "isDirectory", l_lovrFilesystemIsDirectory },
   { "isFile", l_lovrFilesystemIsFile },
   { "isFused", l_lovrFilesystemIsFused },
+  { "isIndexEnabled", l_lovrFilesystemIsIndexEnabled },
   { "load", l_lovrFilesystemLoad },
   { "mount", l_lovrFilesystemMount },
   { "newBlob", l_lovrFilesystemNewBlob },
+  { "newFile", l_lovrFilesystemNewFile },
   { "read", l_lovrFilesystemRead },
+  { "readAsync", l_lovrFilesystemReadAsync },
   { "remove", l_lovrFilesystemRemove },
+  { "setBytecodeCacheEnabled", l_lovrFilesystemSetBytecodeCacheEnabled },
   { "setIdentity", l_lovrFilesystemSetIdentity },
+  { "setIndexEnabled", l_lovrFilesystemSetIndexEnabled },
   { "write", l_lovrFilesystemWrite },
   { NULL, NULL }
 };
@@ -20,6 +20,8 @@ map_int_t BlendModes;
 map_int_t CompareModes;
 map_int_t DrawModes;
 map_int_t FilterModes;
+map_int_t GraphicsPassTypes;
+map_int_t GraphicsStatTypes;
 map_int_t HorizontalAligns;
 map_int_t MaterialColors;
 map_int_t MaterialScalars;
@@ -170,6 +172,23 @@ int l_lovrGraphicsInit(lua_State* L) {
   map_set(&MaterialTextures, "normal", TEXTURE_NORMAL);
   map_set(&MaterialTextures, "environment", TEXTURE_ENVIRONMENT_MAP);
 
+  map_init(&GraphicsPassTypes);
+  map_set(&GraphicsPassTypes, "display", PASS_DISPLAY);
+  map_set(&GraphicsPassTypes, "canvas", PASS_CANVAS);
+
+  map_init(&GraphicsStatTypes);
+  map_set(&GraphicsStatTypes, "drawcalls", STAT_DRAW_CALLS);
+  map_set(&GraphicsStatTypes, "shaderswitches", STAT_SHADER_SWITCHES);
+  map_set(&GraphicsStatTypes, "texturebinds", STAT_TEXTURE_BINDS);
+  map_set(&GraphicsStatTypes, "vertexarraybinds", STAT_VERTEX_ARRAY_BINDS);
+  map_set(&GraphicsStatTypes, "bufferbinds", STAT_BUFFER_BINDS);
+  map_set(&GraphicsStatTypes, "framebufferswitches", STAT_FRAMEBUFFER_SWITCHES);
+  map_set(&GraphicsStatTypes, "uniformuploads", STAT_UNIFORM_UPLOADS);
+  map_set(&GraphicsStatTypes, "bufferbytes", STAT_BUFFER_BYTES);
+  map_set(&GraphicsStatTypes, "texturebytes", STAT_TEXTURE_BYTES);
+  map_set(&GraphicsStatTypes, "vertices", STAT_VERTICES);
+  map_set(&GraphicsStatTypes, "triangles", STAT_TRIANGLES);
+
   map_init(&MatrixTypes);
   map_set(&MatrixTypes, "model", MATRIX_MODEL);
   map_set(&MatrixTypes, "view", MATRIX_VIEW);
@@ -262,7 +281,11 @@ int l_lovrGraphicsInit(lua_State* L) {
     const char* icon = luaL_optstring(L, -1, NULL);
     lua_pop(L, 1);
 
-    lovrGraphicsCreateWindow(width, height, fullscreen, msaa, title, icon);
+    lua_getfield(L, -1, "visible");
+    bool visible = lua_isnil(L, -1) || lua_toboolean(L, -1);
+    lua_pop(L, 1);
+
+    lovrGraphicsCreateWindow(width, height, fullscreen, msaa, title, icon, visible);
   }
 
   lua_pop(L, 2);
@@ -329,7 +352,8 @@ int l_lovrGraphicsCreateWindow(lua_State* L) {
   int msaa = luaL_optnumber(L, 4, 0);
   const char* title = luaL_optstring(L, 5, "LÖVR");
   const char* icon = luaL_optstring(L, 6, NULL);
-  lovrGraphicsCreateWindow(width, height, fullscreen, msaa, title, icon);
+  bool visible = lua_isnoneornil(L, 7) || lua_toboolean(L, 7);
+  lovrGraphicsCreateWindow(width, height, fullscreen, msaa, title, icon, visible);
   return 0;
 }
 
@@ -349,22 +373,51 @@ int l_lovrGraphicsGetDimensions(lua_State* L) {
   return 2;
 }
 
+static void luax_setstats(lua_State* L, int index, GraphicsStats* stats) {
+  for (int i = 0; i < MAX_GRAPHICS_STATS; i++) {
+    luax_pushenum(L, &GraphicsStatTypes, i);
+    lua_pushnumber(L, stats->values[i]);
+    lua_settable(L, index);
+  }
+}
+
 int l_lovrGraphicsGetStats(lua_State* L) {
   if (lua_gettop(L) > 0) {
     luaL_checktype(L, 1, LUA_TTABLE);
     lua_settop(L, 1);
   } else {
-    lua_createtable(L, 0, 2);
+    lua_createtable(L, 0, MAX_GRAPHICS_STATS);
   }
 
   GraphicsStats stats = lovrGraphicsGetStats();
+  luax_setstats(L, 1, &stats);
+  return 1;
+}
 
-  lua_pushinteger(L, stats.drawCalls);
-  lua_setfield(L, 1, "drawcalls");
-
-  lua_pushinteger(L, stats.shaderSwitches);
-  lua_setfield(L, 1, "shaderswitches");
+int l_lovrGraphicsGetPassStats(lua_State* L) {
+  int count;
+  GraphicsPass* passes = lovrGraphicsGetPasses(&count);
+  lua_createtable(L, count, 0);
+  for (int i = 0; i < count; i++) {
+    lua_createtable(L, 0, MAX_GRAPHICS_STATS + 1);
+    luax_pushenum(L, &GraphicsPassTypes, passes[i].type);
+    lua_setfield(L, -2, "type");
+    luax_setstats(L, lua_gettop(L), &passes[i].stats);
+    lua_rawseti(L, -2, i + 1);
+  }
+  return 1;
+}
 
+int l_lovrGraphicsGetStatsHistory(lua_State* L) {
+  GraphicsStat stat = *(GraphicsStat*) luax_checkenum(L, 1, &GraphicsStatTypes, "graphics stat");
+  int count = MIN(luaL_optinteger(L, 2, GRAPHICS_STATS_HISTORY), GRAPHICS_STATS_HISTORY);
+  GraphicsStats history[GRAPHICS_STATS_HISTORY];
+  count = lovrGraphicsGetStatsHistory(history, MAX(count, 0));
+  lua_createtable(L, count, 0);
+  for (int i = 0; i < count; i++) {
+    lua_pushnumber(L, history[i].values[stat]);
+    lua_rawseti(L, -2, i + 1);
+  }
   return 1;
 }
 
@@ -702,7 +755,7 @@ int l_lovrGraphicsTriangle(lua_State* L) {
 int l_lovrGraphicsPlane(lua_State* L) {
   if (lua_isuserdata(L, 1) && lua_gettop(L) == 1) {
     Texture* texture = luax_checktypeof(L, 1, Texture);
-    lovrGraphicsPlaneFullscreen(texture);
+    lovrGraphicsPlaneFullscreen(texture, 1.f);
     return 0;
   }
 
@@ -1129,7 +1182,9 @@ const luaL_Reg lovrGraphics[] = {
   { "getWidth", l_lovrGraphicsGetWidth },
   { "getHeight", l_lovrGraphicsGetHeight },
   { "getDimensions", l_lovrGraphicsGetDimensions },
+  { "getPassStats", l_lovrGraphicsGetPassStats },
   { "getStats", l_lovrGraphicsGetStats },
+  { "getStatsHistory", l_lovrGraphicsGetStatsHistory },
   { "getBackgroundColor", l_lovrGraphicsGetBackgroundColor },
   { "setBackgroundColor", l_lovrGraphicsSetBackgroundColor },
   { "getBlendMode", l_lovrGraphicsGetBlendMode },
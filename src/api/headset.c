@@ -1,5 +1,6 @@
 #include "api.h"
 #include "headset/headset.h"
+#include "headset/recording.h"
 
 map_int_t ControllerAxes;
 map_int_t ControllerButtons;
@@ -8,6 +9,7 @@ map_int_t HeadsetDrivers;
 map_int_t HeadsetEyes;
 map_int_t HeadsetOrigins;
 map_int_t HeadsetTypes;
+map_int_t StereoModes;
 
 typedef struct {
   lua_State* L;
@@ -54,6 +56,7 @@ int l_lovrHeadsetInit(lua_State* L) {
   map_init(&HeadsetEyes);
   map_set(&HeadsetEyes, "left", EYE_LEFT);
   map_set(&HeadsetEyes, "right", EYE_RIGHT);
+  map_set(&HeadsetEyes, "both", EYE_BOTH);
 
   map_init(&HeadsetOrigins);
   map_set(&HeadsetOrigins, "head", ORIGIN_HEAD);
@@ -68,8 +71,13 @@ int l_lovrHeadsetInit(lua_State* L) {
   map_init(&HeadsetDrivers);
   map_set(&HeadsetDrivers, "fake", DRIVER_FAKE);
   map_set(&HeadsetDrivers, "openvr", DRIVER_OPENVR);
+  map_set(&HeadsetDrivers, "replay", DRIVER_REPLAY);
   map_set(&HeadsetDrivers, "webvr", DRIVER_WEBVR);
 
+  map_init(&StereoModes);
+  map_set(&StereoModes, "multipass", STEREO_MULTIPASS);
+  map_set(&StereoModes, "singlepass", STEREO_SINGLEPASS);
+
   luax_pushconf(L);
   lua_getfield(L, -1, "headset");
 
@@ -77,6 +85,7 @@ int l_lovrHeadsetInit(lua_State* L) {
   vec_init(&drivers);
 
   bool mirror = false;
+  StereoMode stereo = STEREO_MULTIPASS;
 
   if (lua_istable(L, -1)) {
 
@@ -94,10 +103,21 @@ int l_lovrHeadsetInit(lua_State* L) {
     lua_getfield(L, -1, "mirror");
     mirror = lua_toboolean(L, -1);
     lua_pop(L, 1);
+
+    // Stereo
+    lua_getfield(L, -1, "stereo");
+    stereo = *(StereoMode*) luax_optenum(L, -1, "multipass", &StereoModes, "stereo mode");
+    lua_pop(L, 1);
+
+    // Replay
+    lua_getfield(L, -1, "replay");
+    lovrHeadsetSetReplayPath(lua_isstring(L, -1) ? lua_tostring(L, -1) : NULL);
+    lua_pop(L, 1);
   }
 
   lovrHeadsetInit(drivers.data, drivers.length);
   lovrHeadsetSetMirrored(mirror);
+  lovrHeadsetSetStereoMode(stereo);
 
   vec_deinit(&drivers);
   lua_pop(L, 2);
@@ -143,6 +163,17 @@ int l_lovrHeadsetSetMirrored(lua_State* L) {
   return 0;
 }
 
+int l_lovrHeadsetGetStereoMode(lua_State* L) {
+  luax_pushenum(L, &StereoModes, lovrHeadsetGetStereoMode());
+  return 1;
+}
+
+int l_lovrHeadsetSetStereoMode(lua_State* L) {
+  StereoMode mode = *(StereoMode*) luax_checkenum(L, 1, &StereoModes, "stereo mode");
+  lovrHeadsetSetStereoMode(mode);
+  return 0;
+}
+
 int l_lovrHeadsetGetDisplayWidth(lua_State* L) {
   int width;
   lovrHeadsetGetDisplayDimensions(&width, NULL);
@@ -196,10 +227,22 @@ int l_lovrHeadsetGetBoundsDimensions(lua_State* L) {
   return 2;
 }
 
+// Poses take an optional eye and an optional number of seconds to predict the pose into the future
 static void luax_getPose(lua_State* L, float* x, float* y, float* z, float* angle, float* ax, float* ay, float* az) {
-  if (lua_type(L, 1) == LUA_TSTRING) {
+  bool hasEye = lua_type(L, 1) == LUA_TSTRING;
+  bool predict = lua_type(L, hasEye ? 2 : 1) == LUA_TNUMBER;
+  float time = predict ? lua_tonumber(L, hasEye ? 2 : 1) : 0.f;
+
+  if (hasEye) {
     HeadsetEye eye = *(HeadsetEye*) luax_checkenum(L, 1, &HeadsetEyes, "eye");
-    lovrHeadsetGetEyePose(eye, x, y, z, angle, ax, ay, az);
+    lovrAssert(eye != EYE_BOTH, "Expected 'left' or 'right' eye");
+    if (predict) {
+      lovrHeadsetGetPredictedEyePose(eye, time, x, y, z, angle, ax, ay, az);
+    } else {
+      lovrHeadsetGetEyePose(eye, x, y, z, angle, ax, ay, az);
+    }
+  } else if (predict) {
+    lovrHeadsetGetPredictedPose(time, x, y, z, angle, ax, ay, az);
   } else {
     lovrHeadsetGetPose(x, y, z, angle, ax, ay, az);
   }
@@ -295,6 +338,48 @@ int l_lovrHeadsetRenderTo(lua_State* L) {
   return 0;
 }
 
+int l_lovrHeadsetGetPoseStats(lua_State* L) {
+  PoseStats* stats = lovrHeadsetGetPoseStats();
+
+  if (lua_istable(L, 1)) {
+    lua_settop(L, 1);
+  } else {
+    lua_settop(L, 0);
+    lua_newtable(L);
+  }
+
+  lua_pushnumber(L, stats->frames);
+  lua_setfield(L, 1, "frames");
+  lua_pushnumber(L, stats->age);
+  lua_setfield(L, 1, "age");
+  lua_pushnumber(L, stats->averageAge);
+  lua_setfield(L, 1, "averageAge");
+  lua_pushnumber(L, stats->maxAge);
+  lua_setfield(L, 1, "maxAge");
+  return 1;
+}
+
+int l_lovrHeadsetResetPoseStats(lua_State* L) {
+  lovrHeadsetResetPoseStats();
+  return 0;
+}
+
+int l_lovrHeadsetStartRecording(lua_State* L) {
+  const char* path = luaL_checkstring(L, 1);
+  lovrHeadsetStartRecording(path);
+  return 0;
+}
+
+int l_lovrHeadsetStopRecording(lua_State* L) {
+  lovrHeadsetStopRecording();
+  return 0;
+}
+
+int l_lovrHeadsetIsRecording(lua_State* L) {
+  lua_pushboolean(L, lovrHeadsetIsRecording());
+  return 1;
+}
+
 int l_lovrHeadsetUpdate(lua_State* L) {
   float dt = luaL_checknumber(L, 1);
   lovrHeadsetUpdate(dt);
@@ -308,6 +393,8 @@ const luaL_Reg lovrHeadset[] = {
   { "isMounted", l_lovrHeadsetIsMounted },
   { "isMirrored", l_lovrHeadsetIsMirrored },
   { "setMirrored", l_lovrHeadsetSetMirrored },
+  { "getStereoMode", l_lovrHeadsetGetStereoMode },
+  { "setStereoMode", l_lovrHeadsetSetStereoMode },
   { "getDisplayWidth", l_lovrHeadsetGetDisplayWidth },
   { "getDisplayHeight", l_lovrHeadsetGetDisplayHeight },
   { "getDisplayDimensions", l_lovrHeadsetGetDisplayDimensions },
@@ -324,6 +411,11 @@ const luaL_Reg lovrHeadset[] = {
   { "getControllers", l_lovrHeadsetGetControllers },
   { "getControllerCount", l_lovrHeadsetGetControllerCount },
   { "renderTo", l_lovrHeadsetRenderTo },
+  { "getPoseStats", l_lovrHeadsetGetPoseStats },
+  { "resetPoseStats", l_lovrHeadsetResetPoseStats },
+  { "startRecording", l_lovrHeadsetStartRecording },
+  { "stopRecording", l_lovrHeadsetStopRecording },
+  { "isRecording", l_lovrHeadsetIsRecording },
   { "update", l_lovrHeadsetUpdate },
   { NULL, NULL }
 };
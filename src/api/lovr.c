@@ -1,5 +1,6 @@
 #include "api.h"
 #include "lovr.h"
+#include "allocator.h"
 #include "resources/logo.png.h"
 #include "lib/lua-cjson/lua_cjson.h"
 #include "lib/lua-enet/enet.h"
@@ -26,6 +27,56 @@ int l_lovrInit(lua_State* L) {
   return 1;
 }
 
+int l_lovrGetMemoryStats(lua_State* L) {
+  MemoryStats stats;
+  lovrMemoryGetStats(&stats);
+
+  if (lua_istable(L, 1)) {
+    lua_settop(L, 1);
+  } else {
+    lua_settop(L, 0);
+    lua_newtable(L);
+  }
+
+  lua_pushnumber(L, stats.allocations);
+  lua_setfield(L, 1, "allocations");
+  lua_pushnumber(L, stats.frameAllocations);
+  lua_setfield(L, 1, "frameAllocations");
+  lua_pushnumber(L, stats.lastFrameAllocations);
+  lua_setfield(L, 1, "lastFrameAllocations");
+
+  lua_newtable(L);
+  lua_pushnumber(L, stats.arenaUsed);
+  lua_setfield(L, -2, "used");
+  lua_pushnumber(L, stats.arenaPeak);
+  lua_setfield(L, -2, "peak");
+  lua_pushnumber(L, stats.arenaSize);
+  lua_setfield(L, -2, "size");
+  lua_setfield(L, 1, "arena");
+
+  int poolCount;
+  Pool** pools = lovrMemoryGetPools(&poolCount);
+  lua_newtable(L);
+  for (int i = 0; i < poolCount; i++) {
+    Pool* pool = pools[i];
+    lua_newtable(L);
+    lua_pushinteger(L, pool->count);
+    lua_setfield(L, -2, "count");
+    lua_pushinteger(L, pool->peak);
+    lua_setfield(L, -2, "peak");
+    lua_pushnumber(L, (double) pool->count * pool->size);
+    lua_setfield(L, -2, "bytes");
+    lua_pushnumber(L, (double) pool->chunks.length * POOL_CHUNK_COUNT * pool->size);
+    lua_setfield(L, -2, "capacity");
+    lua_pushnumber(L, pool->allocations);
+    lua_setfield(L, -2, "allocations");
+    lua_setfield(L, -2, pool->name);
+  }
+  lua_setfield(L, 1, "pools");
+
+  return 1;
+}
+
 int l_lovrGetOS(lua_State* L) {
   const char* os = lovrGetOS();
   if (os) {
@@ -36,6 +87,16 @@ int l_lovrGetOS(lua_State* L) {
   return 1;
 }
 
+int l_lovrIsMemoryTracking(lua_State* L) {
+  lua_pushboolean(L, lovrMemoryIsTracking());
+  return 1;
+}
+
+int l_lovrSetMemoryTracking(lua_State* L) {
+  lovrMemorySetTracking(lua_toboolean(L, 1));
+  return 0;
+}
+
 int l_lovrGetVersion(lua_State* L) {
   int major, minor, patch;
   lovrGetVersion(&major, &minor, &patch);
@@ -47,7 +108,10 @@ int l_lovrGetVersion(lua_State* L) {
 
 const luaL_Reg lovr[] = {
   { "_setConf", luax_setconf },
+  { "getMemoryStats", l_lovrGetMemoryStats },
   { "getOS", l_lovrGetOS },
   { "getVersion", l_lovrGetVersion },
+  { "isMemoryTracking", l_lovrIsMemoryTracking },
+  { "setMemoryTracking", l_lovrSetMemoryTracking },
   { NULL, NULL }
 };
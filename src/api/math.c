@@ -7,14 +7,24 @@
 
 extern int l_lovrRandomGeneratorRandom(lua_State* L);
 extern int l_lovrRandomGeneratorRandomNormal(lua_State* L);
+extern int l_lovrRandomGeneratorFill(lua_State* L);
 extern int l_lovrRandomGeneratorGetSeed(lua_State* L);
 extern int l_lovrRandomGeneratorSetSeed(lua_State* L);
 
+map_int_t RandomDistributions;
+
 int l_lovrMathInit(lua_State* L) {
   lua_newtable(L);
   luaL_register(L, NULL, lovrMath);
   luax_registertype(L, "RandomGenerator", lovrRandomGenerator);
   luax_registertype(L, "Transform", lovrTransform);
+
+  map_init(&RandomDistributions);
+  map_set(&RandomDistributions, "uniform", DISTRIBUTION_UNIFORM);
+  map_set(&RandomDistributions, "normal", DISTRIBUTION_NORMAL);
+  map_set(&RandomDistributions, "sphere", DISTRIBUTION_SPHERE);
+  map_set(&RandomDistributions, "box", DISTRIBUTION_BOX);
+
   lovrMathInit();
   return 1;
 }
@@ -79,6 +89,12 @@ int l_lovrMathRandomNormal(lua_State* L) {
   return l_lovrRandomGeneratorRandomNormal(L);
 }
 
+int l_lovrMathFill(lua_State* L) {
+  luax_pushtype(L, RandomGenerator, lovrMathGetRandomGenerator());
+  lua_insert(L, 1);
+  return l_lovrRandomGeneratorFill(L);
+}
+
 int l_lovrMathGetRandomSeed(lua_State* L) {
   luax_pushtype(L, RandomGenerator, lovrMathGetRandomGenerator());
   lua_insert(L, 1);
@@ -132,6 +148,7 @@ const luaL_Reg lovrMath[] = {
   { "lookAt", l_lovrMathLookAt },
   { "random", l_lovrMathRandom },
   { "randomNormal", l_lovrMathRandomNormal },
+  { "fill", l_lovrMathFill },
   { "getRandomSeed", l_lovrMathGetRandomSeed },
   { "setRandomSeed", l_lovrMathSetRandomSeed },
   { "gammaToLinear", l_lovrMathGammaToLinear },
@@ -1,8 +1,10 @@
 #include "api.h"
 #include "physics/physics.h"
+#include "data/textureData.h"
 
 map_int_t ShapeTypes;
 map_int_t JointTypes;
+map_int_t TransformFormats;
 
 int l_lovrPhysicsInit(lua_State* L) {
   lua_newtable(L);
@@ -17,6 +19,8 @@ int l_lovrPhysicsInit(lua_State* L) {
   luax_extendtype(L, "Shape", "BoxShape", lovrShape, lovrBoxShape);
   luax_extendtype(L, "Shape", "CapsuleShape", lovrShape, lovrCapsuleShape);
   luax_extendtype(L, "Shape", "CylinderShape", lovrShape, lovrCylinderShape);
+  luax_extendtype(L, "Shape", "MeshShape", lovrShape, lovrMeshShape);
+  luax_extendtype(L, "Shape", "HeightfieldShape", lovrShape, lovrHeightfieldShape);
 
   map_init(&JointTypes);
   map_set(&JointTypes, "ball", JOINT_BALL);
@@ -29,6 +33,12 @@ int l_lovrPhysicsInit(lua_State* L) {
   map_set(&ShapeTypes, "box", SHAPE_BOX);
   map_set(&ShapeTypes, "capsule", SHAPE_CAPSULE);
   map_set(&ShapeTypes, "cylinder", SHAPE_CYLINDER);
+  map_set(&ShapeTypes, "mesh", SHAPE_MESH);
+  map_set(&ShapeTypes, "heightfield", SHAPE_HEIGHTFIELD);
+
+  map_init(&TransformFormats);
+  map_set(&TransformFormats, "pose", TRANSFORM_POSE);
+  map_set(&TransformFormats, "matrix", TRANSFORM_MATRIX);
 
   lovrPhysicsInit();
   return 1;
@@ -110,6 +120,56 @@ int l_lovrPhysicsNewDistanceJoint(lua_State* L) {
   return 1;
 }
 
+// The heights live in a userdata so any argument error can throw without leaking them.  ODE copies
+// them when the shape is created, so Lua is free to collect the buffer afterwards.
+int l_lovrPhysicsNewHeightfieldShape(lua_State* L) {
+  int samplesX, samplesZ, index;
+  float* heights;
+  void** type;
+  if ((type = luax_totype(L, 1, TextureData)) != NULL) {
+    TextureData* textureData = *type;
+    samplesX = textureData->width;
+    samplesZ = textureData->height;
+    index = 2;
+  } else {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    samplesX = luaL_checkinteger(L, 2);
+    samplesZ = luaL_checkinteger(L, 3);
+    int count = lua_objlen(L, 1);
+    if (count != samplesX * samplesZ) {
+      return luaL_error(L, "Expected %d heights, got %d", samplesX * samplesZ, count);
+    }
+    index = 4;
+  }
+
+  float width = luaL_optnumber(L, index++, 1.f);
+  float depth = luaL_optnumber(L, index++, width);
+  float scale = luaL_optnumber(L, index++, 1.f);
+
+  if (type) {
+    TextureData* textureData = *type;
+    heights = lua_newuserdata(L, samplesX * samplesZ * sizeof(float));
+    for (int z = 0; z < samplesZ; z++) {
+      for (int x = 0; x < samplesX; x++) {
+        heights[z * samplesX + x] = lovrTextureDataGetPixel(textureData, x, z).r;
+      }
+    }
+  } else {
+    heights = lua_newuserdata(L, samplesX * samplesZ * sizeof(float));
+    for (int i = 0; i < samplesX * samplesZ; i++) {
+      lua_rawgeti(L, 1, i + 1);
+      heights[i] = luaL_checknumber(L, -1);
+      lua_pop(L, 1);
+    }
+  }
+
+  HeightfieldShape* heightfield = lovrHeightfieldShapeCreate(heights, samplesX, samplesZ, width, depth, scale);
+  lua_pop(L, 1);
+  luax_pushtype(L, HeightfieldShape, heightfield);
+  lovrRelease(heightfield);
+  return 1;
+}
+
 int l_lovrPhysicsNewHingeJoint(lua_State* L) {
   Collider* a = luax_checktype(L, 1, Collider);
   Collider* b = luax_checktype(L, 2, Collider);
@@ -124,6 +184,38 @@ int l_lovrPhysicsNewHingeJoint(lua_State* L) {
   return 1;
 }
 
+int l_lovrPhysicsNewMeshShape(lua_State* L) {
+  TriMesh* mesh;
+  void** type;
+  if ((type = luax_totype(L, 1, MeshShape)) != NULL) {
+    mesh = lovrMeshShapeGetTriMesh(*type);
+    lovrRetain(mesh);
+  } else if ((type = luax_totype(L, 1, ModelData)) != NULL) {
+    mesh = lovrTriMeshCreateFromModelData(*type);
+  } else {
+    VertexData* vertexData = luax_checktype(L, 1, VertexData);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    int count = lua_objlen(L, 2);
+    uint32_t* indices = lua_newuserdata(L, count * sizeof(uint32_t));
+    for (int i = 0; i < count; i++) {
+      lua_rawgeti(L, 2, i + 1);
+      if (!lua_isnumber(L, -1)) {
+        return luaL_error(L, "Mesh shape index #%d must be numeric", i + 1);
+      }
+      indices[i] = lua_tointeger(L, -1) - 1;
+      lua_pop(L, 1);
+    }
+    mesh = lovrTriMeshCreateFromVertexData(vertexData, indices, count);
+    lua_pop(L, 1);
+  }
+
+  MeshShape* shape = lovrMeshShapeCreate(mesh);
+  luax_pushtype(L, MeshShape, shape);
+  lovrRelease(mesh);
+  lovrRelease(shape);
+  return 1;
+}
+
 int l_lovrPhysicsNewSliderJoint(lua_State* L) {
   Collider* a = luax_checktype(L, 1, Collider);
   Collider* b = luax_checktype(L, 2, Collider);
@@ -149,7 +241,9 @@ const luaL_Reg lovrPhysics[] = {
   { "newCapsuleShape", l_lovrPhysicsNewCapsuleShape },
   { "newCylinderShape", l_lovrPhysicsNewCylinderShape },
   { "newDistanceJoint", l_lovrPhysicsNewDistanceJoint },
+  { "newHeightfieldShape", l_lovrPhysicsNewHeightfieldShape },
   { "newHingeJoint", l_lovrPhysicsNewHingeJoint },
+  { "newMeshShape", l_lovrPhysicsNewMeshShape },
   { "newSliderJoint", l_lovrPhysicsNewSliderJoint },
   { "newSphereShape", l_lovrPhysicsNewSphereShape },
   { NULL, NULL }
@@ -8,6 +8,7 @@ static int threadRunner(void* data) {
   lovrRetain(thread);
   mtx_lock(&thread->lock);
   thread->running = true;
+  free(thread->error);
   thread->error = NULL;
   mtx_unlock(&thread->lock);
 
@@ -18,25 +19,27 @@ static int threadRunner(void* data) {
   lua_setglobal(L, "lovr");
 
   if (luaL_loadbuffer(L, thread->body, strlen(thread->body), "thread") || lua_pcall(L, 0, 0, 0)) {
-    thread->error = lua_tostring(L, -1);
+    const char* error = lua_tostring(L, -1);
+    thread->error = strdup(error ? error : "Unknown error");
   }
 
   mtx_lock(&thread->lock);
   thread->running = false;
   mtx_unlock(&thread->lock);
-  lovrRelease(thread);
+  lua_close(L);
 
+  // The event takes over the reference held by the thread, releasing it when it's delivered.  It
+  // gets its own copy of the error, since restarting the thread frees the thread's copy.
   if (thread->error) {
     Event event;
     event.type = EVENT_THREAD_ERROR;
     event.data.threaderror.thread = thread;
-    event.data.threaderror.error = thread->error;
+    event.data.threaderror.error = strdup(thread->error);
     lovrEventPush(event);
-    lua_close(L);
     return 1;
   }
 
-  lua_close(L);
+  lovrRelease(thread);
   return 0;
 }
 
@@ -1,10 +1,45 @@
 #include "api.h"
 #include "timer/timer.h"
+#include "timer/profiler.h"
+#include "filesystem/filesystem.h"
+#include <stdlib.h>
+
+map_int_t ProfileTracks;
+map_int_t SmoothingModes;
 
 int l_lovrTimerInit(lua_State* L) {
   lua_newtable(L);
   luaL_register(L, NULL, lovrTimer);
+
+  map_init(&ProfileTracks);
+  map_set(&ProfileTracks, "cpu", PROFILE_CPU);
+  map_set(&ProfileTracks, "gpu", PROFILE_GPU);
+
+  map_init(&SmoothingModes);
+  map_set(&SmoothingModes, "none", SMOOTH_NONE);
+  map_set(&SmoothingModes, "average", SMOOTH_AVERAGE);
+  map_set(&SmoothingModes, "exponential", SMOOTH_EXPONENTIAL);
+
   lovrTimerInit();
+
+  luax_pushconf(L);
+  if (lua_istable(L, -1)) {
+    lua_getfield(L, -1, "timer");
+    if (lua_istable(L, -1)) {
+      lua_getfield(L, -1, "framerate");
+      double framerate = luaL_optnumber(L, -1, 0);
+      lovrTimerSetTargetDelta(framerate > 0 ? 1 / framerate : 0);
+      lua_pop(L, 1);
+
+      lua_getfield(L, -1, "smoothing");
+      TimerSmoothing smoothing = *(TimerSmoothing*) luax_optenum(L, -1, "none", &SmoothingModes, "smoothing mode");
+      lovrTimerSetSmoothing(smoothing, smoothing == SMOOTH_AVERAGE ? 10 : .1);
+      lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+  }
+  lua_pop(L, 1);
+
   return 1;
 }
 
@@ -23,6 +58,82 @@ int l_lovrTimerGetFPS(lua_State* L) {
   return 1;
 }
 
+int l_lovrTimerGetFixedDelta(lua_State* L) {
+  double delta = lovrTimerGetFixedDelta();
+  if (delta > 0) {
+    lua_pushnumber(L, delta);
+  } else {
+    lua_pushnil(L);
+  }
+  return 1;
+}
+
+int l_lovrTimerSetFixedDelta(lua_State* L) {
+  lovrTimerSetFixedDelta(luaL_optnumber(L, 1, 0));
+  return 0;
+}
+
+int l_lovrTimerGetTargetDelta(lua_State* L) {
+  double delta = lovrTimerGetTargetDelta();
+  if (delta > 0) {
+    lua_pushnumber(L, delta);
+  } else {
+    lua_pushnil(L);
+  }
+  return 1;
+}
+
+int l_lovrTimerSetTargetDelta(lua_State* L) {
+  lovrTimerSetTargetDelta(luaL_optnumber(L, 1, 0));
+  return 0;
+}
+
+int l_lovrTimerGetSmoothing(lua_State* L) {
+  TimerSmoothing smoothing;
+  double amount;
+  lovrTimerGetSmoothing(&smoothing, &amount);
+  luax_pushenum(L, &SmoothingModes, smoothing);
+  lua_pushnumber(L, amount);
+  return 2;
+}
+
+int l_lovrTimerSetSmoothing(lua_State* L) {
+  TimerSmoothing smoothing = *(TimerSmoothing*) luax_checkenum(L, 1, &SmoothingModes, "smoothing mode");
+  double amount = luaL_optnumber(L, 2, smoothing == SMOOTH_AVERAGE ? 10 : .1);
+  lovrTimerSetSmoothing(smoothing, amount);
+  return 0;
+}
+
+int l_lovrTimerGetPacingStats(lua_State* L) {
+  PacingStats* stats = lovrTimerGetPacingStats();
+
+  if (lua_istable(L, 1)) {
+    lua_settop(L, 1);
+  } else {
+    lua_settop(L, 0);
+    lua_newtable(L);
+  }
+
+  lua_pushnumber(L, stats->frames);
+  lua_setfield(L, 1, "frames");
+  lua_pushnumber(L, stats->lateFrames);
+  lua_setfield(L, 1, "lateFrames");
+  lua_pushnumber(L, stats->lastLateness);
+  lua_setfield(L, 1, "lateness");
+  lua_pushnumber(L, stats->maxLateness);
+  lua_setfield(L, 1, "maxLateness");
+  lua_pushnumber(L, stats->workTime);
+  lua_setfield(L, 1, "work");
+  lua_pushnumber(L, stats->waitTime);
+  lua_setfield(L, 1, "wait");
+  return 1;
+}
+
+int l_lovrTimerResetPacingStats(lua_State* L) {
+  lovrTimerResetPacingStats();
+  return 0;
+}
+
 int l_lovrTimerGetTime(lua_State* L) {
   lua_pushnumber(L, lovrTimerGetTime());
   return 1;
@@ -33,6 +144,73 @@ int l_lovrTimerStep(lua_State* L) {
   return 1;
 }
 
+int l_lovrTimerIsProfilerEnabled(lua_State* L) {
+  lua_pushboolean(L, lovrProfilerIsEnabled());
+  return 1;
+}
+
+int l_lovrTimerSetProfilerEnabled(lua_State* L) {
+  lovrProfilerSetEnabled(lua_toboolean(L, 1));
+  return 0;
+}
+
+int l_lovrTimerPush(lua_State* L) {
+  const char* name = luaL_checkstring(L, 1);
+  lovrProfilerPush(name);
+  return 0;
+}
+
+int l_lovrTimerPop(lua_State* L) {
+  lovrProfilerPop();
+  return 0;
+}
+
+// Returns the scopes recorded during the previous frame, with times relative to when profiling started
+int l_lovrTimerGetProfile(lua_State* L) {
+  vec_profileevent_t* events = lovrProfilerGetFrame();
+  double epoch = lovrProfilerGetEpoch();
+  lua_createtable(L, events->length, 0);
+
+  for (int i = 0; i < events->length; i++) {
+    ProfileEvent* event = &events->data[i];
+    lua_createtable(L, 0, 5);
+    lua_pushstring(L, event->name);
+    lua_setfield(L, -2, "name");
+    luax_pushenum(L, &ProfileTracks, event->track);
+    lua_setfield(L, -2, "track");
+    lua_pushinteger(L, event->depth);
+    lua_setfield(L, -2, "depth");
+    lua_pushnumber(L, event->start - epoch);
+    lua_setfield(L, -2, "start");
+    lua_pushnumber(L, event->duration);
+    lua_setfield(L, -2, "duration");
+    lua_rawseti(L, -2, i + 1);
+  }
+
+  return 1;
+}
+
+int l_lovrTimerStartTrace(lua_State* L) {
+  lovrProfilerStartTrace();
+  return 0;
+}
+
+int l_lovrTimerStopTrace(lua_State* L) {
+  const char* filename = luaL_optstring(L, 1, "trace.json");
+  size_t size;
+  char* trace = lovrProfilerStopTrace(&size);
+  if (!trace) {
+    lua_pushinteger(L, 0);
+    return 1;
+  }
+
+  size_t bytesWritten = lovrFilesystemWrite(filename, trace, size, false);
+  free(trace);
+  lovrAssert(bytesWritten == size, "Could not write trace to '%s'", filename);
+  lua_pushinteger(L, bytesWritten);
+  return 1;
+}
+
 int l_lovrTimerSleep(lua_State* L) {
   double duration = luaL_checknumber(L, 1);
   lovrTimerSleep(duration);
@@ -43,8 +221,23 @@ const luaL_Reg lovrTimer[] = {
   { "getDelta", l_lovrTimerGetDelta },
   { "getAverageDelta", l_lovrTimerGetAverageDelta },
   { "getFPS", l_lovrTimerGetFPS },
+  { "getFixedDelta", l_lovrTimerGetFixedDelta },
+  { "setFixedDelta", l_lovrTimerSetFixedDelta },
+  { "getTargetDelta", l_lovrTimerGetTargetDelta },
+  { "setTargetDelta", l_lovrTimerSetTargetDelta },
+  { "getSmoothing", l_lovrTimerGetSmoothing },
+  { "setSmoothing", l_lovrTimerSetSmoothing },
+  { "getPacingStats", l_lovrTimerGetPacingStats },
+  { "resetPacingStats", l_lovrTimerResetPacingStats },
   { "getTime", l_lovrTimerGetTime },
   { "step", l_lovrTimerStep },
   { "sleep", l_lovrTimerSleep },
+  { "isProfilerEnabled", l_lovrTimerIsProfilerEnabled },
+  { "setProfilerEnabled", l_lovrTimerSetProfilerEnabled },
+  { "push", l_lovrTimerPush },
+  { "pop", l_lovrTimerPop },
+  { "getProfile", l_lovrTimerGetProfile },
+  { "startTrace", l_lovrTimerStartTrace },
+  { "stopTrace", l_lovrTimerStopTrace },
   { NULL, NULL }
 };
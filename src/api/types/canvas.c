@@ -1,6 +1,7 @@
 #include "api.h"
 #include "graphics/graphics.h"
 #include "graphics/canvas.h"
+#include "timer/profiler.h"
 
 int l_lovrCanvasRenderTo(lua_State* L) {
   Canvas* canvas = luax_checktype(L, 1, Canvas);
@@ -11,7 +12,11 @@ int l_lovrCanvasRenderTo(lua_State* L) {
   int count;
   lovrGraphicsGetCanvas(old, &count);
   lovrGraphicsSetCanvas(&canvas, 1);
+  lovrProfilerPush("canvas");
+  lovrGraphicsPushTimer("canvas");
   lua_call(L, nargs, 0);
+  lovrGraphicsPopTimer();
+  lovrProfilerPop();
   lovrGraphicsSetCanvas(old, count);
   return 0;
 }
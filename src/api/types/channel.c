@@ -1,7 +1,7 @@
 #include "api.h"
 #include "thread/channel.h"
 
-static void luax_checkvariant(lua_State* L, int index, Variant* variant) {
+void luax_checkvariant(lua_State* L, int index, Variant* variant) {
   int type = lua_type(L, index);
   switch (type) {
     case LUA_TNIL:
@@ -32,7 +32,8 @@ static void luax_checkvariant(lua_State* L, int index, Variant* variant) {
       variant->meta = luaL_checkstring(L, -1);
       lua_pop(L, 2);
       variant->type = TYPE_OBJECT;
-      variant->value.ref = lua_touserdata(L, index);
+      variant->value.ref = *(Ref**) lua_touserdata(L, index);
+      lovrShare(variant->value.ref);
       lovrRetain(variant->value.ref);
       break;
 
@@ -42,7 +43,7 @@ static void luax_checkvariant(lua_State* L, int index, Variant* variant) {
   }
 }
 
-static int luax_pushvariant(lua_State* L, Variant* variant) {
+int luax_pushvariant(lua_State* L, Variant* variant) {
   switch (variant->type) {
     case TYPE_NIL: lua_pushnil(L); break;
     case TYPE_BOOLEAN: lua_pushboolean(L, variant->value.boolean); break;
@@ -55,8 +56,8 @@ static int luax_pushvariant(lua_State* L, Variant* variant) {
         luaL_getmetatable(L, variant->meta);
         lua_setmetatable(L, -2);
         *u = variant->value.ref;
-        lovrRelease(variant->value.ref);
       }
+      lovrRelease(variant->value.ref);
       break;
   }
 
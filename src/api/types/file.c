@@ -0,0 +1,130 @@
+#include "api.h"
+#include "filesystem/file.h"
+#include "data/blob.h"
+#include <stdlib.h>
+
+int l_lovrFileClose(lua_State* L) {
+  File* file = luax_checktype(L, 1, File);
+  if (file->handle) {
+    lovrFileClose(file);
+  }
+  return 0;
+}
+
+int l_lovrFileFlush(lua_State* L) {
+  File* file = luax_checktype(L, 1, File);
+  lua_pushboolean(L, !lovrFileFlush(file));
+  return 1;
+}
+
+int l_lovrFileGetMode(lua_State* L) {
+  File* file = luax_checktype(L, 1, File);
+  luax_pushenum(L, &FileModes, file->mode);
+  return 1;
+}
+
+int l_lovrFileGetPath(lua_State* L) {
+  File* file = luax_checktype(L, 1, File);
+  lua_pushstring(L, file->path);
+  return 1;
+}
+
+int l_lovrFileGetSize(lua_State* L) {
+  File* file = luax_checktype(L, 1, File);
+  lua_pushinteger(L, lovrFileGetSize(file));
+  return 1;
+}
+
+int l_lovrFileIsEOF(lua_State* L) {
+  File* file = luax_checktype(L, 1, File);
+  lua_pushboolean(L, lovrFileIsEOF(file));
+  return 1;
+}
+
+int l_lovrFileIsOpen(lua_State* L) {
+  File* file = luax_checktype(L, 1, File);
+  lua_pushboolean(L, file->handle != NULL);
+  return 1;
+}
+
+// Reading into a Blob reuses its memory, so streaming a large file doesn't create a string per chunk
+int l_lovrFileRead(lua_State* L) {
+  File* file = luax_checktype(L, 1, File);
+  Blob** userdata = luax_totype(L, 2, Blob);
+  Blob* blob = userdata ? *userdata : NULL;
+
+  if (blob) {
+    size_t count = luaL_optinteger(L, 3, blob->size);
+    lovrAssert(count <= blob->size, "Blob is too small to read %d bytes", count);
+    lua_pushinteger(L, lovrFileRead(file, blob->data, count));
+    return 1;
+  }
+
+  size_t count;
+  if (lua_isnoneornil(L, 2)) {
+    count = lovrFileGetSize(file) - lovrFileTell(file);
+  } else {
+    count = luaL_checkinteger(L, 2);
+  }
+
+  void* data = malloc(count);
+  lovrAssert(data || count == 0, "Out of memory");
+  size_t bytesRead = lovrFileRead(file, data, count);
+  lua_pushlstring(L, data, bytesRead);
+  free(data);
+  return 1;
+}
+
+int l_lovrFileSeek(lua_State* L) {
+  File* file = luax_checktype(L, 1, File);
+  size_t position = luaL_checkinteger(L, 2);
+  lua_pushboolean(L, !lovrFileSeek(file, position));
+  return 1;
+}
+
+int l_lovrFileSetBuffer(lua_State* L) {
+  File* file = luax_checktype(L, 1, File);
+  size_t size = luaL_checkinteger(L, 2);
+  lua_pushboolean(L, !lovrFileSetBuffer(file, size));
+  return 1;
+}
+
+int l_lovrFileTell(lua_State* L) {
+  File* file = luax_checktype(L, 1, File);
+  lua_pushinteger(L, lovrFileTell(file));
+  return 1;
+}
+
+int l_lovrFileWrite(lua_State* L) {
+  File* file = luax_checktype(L, 1, File);
+  Blob** userdata = luax_totype(L, 2, Blob);
+  Blob* blob = userdata ? *userdata : NULL;
+
+  if (blob) {
+    size_t count = luaL_optinteger(L, 3, blob->size);
+    lovrAssert(count <= blob->size, "Blob only contains %d bytes", blob->size);
+    lua_pushinteger(L, lovrFileWrite(file, blob->data, count));
+    return 1;
+  }
+
+  size_t size;
+  const char* data = luaL_checklstring(L, 2, &size);
+  lua_pushinteger(L, lovrFileWrite(file, (void*) data, size));
+  return 1;
+}
+
+const luaL_Reg lovrFile[] = {
+  { "close", l_lovrFileClose },
+  { "flush", l_lovrFileFlush },
+  { "getMode", l_lovrFileGetMode },
+  { "getPath", l_lovrFileGetPath },
+  { "getSize", l_lovrFileGetSize },
+  { "isEOF", l_lovrFileIsEOF },
+  { "isOpen", l_lovrFileIsOpen },
+  { "read", l_lovrFileRead },
+  { "seek", l_lovrFileSeek },
+  { "setBuffer", l_lovrFileSetBuffer },
+  { "tell", l_lovrFileTell },
+  { "write", l_lovrFileWrite },
+  { NULL, NULL }
+};
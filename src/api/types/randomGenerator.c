@@ -1,4 +1,6 @@
 #include "api.h"
+#include "data/blob.h"
+#include "data/vertexData.h"
 #include "math/randomGenerator.h"
 
 static double luax_checkrandomseedpart(lua_State* L, int index) {
@@ -84,6 +86,77 @@ int l_lovrRandomGeneratorRandomNormal(lua_State* L) {
   return 1;
 }
 
+// fill(blob, distribution, [components], [...])
+// fill(vertexData, attribute, distribution, [start], [count], [...])
+// Trailing numbers are the lower and upper bounds for uniform, sigma and mu for normal, the radius
+// for sphere and the size of each dimension for box.
+int l_lovrRandomGeneratorFill(lua_State* L) {
+  RandomGenerator* generator = luax_checktype(L, 1, RandomGenerator);
+  VertexData** userdata = luax_totype(L, 2, VertexData);
+  VertexData* vertexData = userdata ? *userdata : NULL;
+  RandomDistribution distribution;
+  float* data;
+  uint32_t count;
+  int components;
+  size_t stride;
+  int index;
+
+  if (vertexData) {
+    VertexFormat* format = &vertexData->format;
+    int attributeIndex = luaL_checkint(L, 3) - 1;
+    lovrAssert(attributeIndex >= 0 && attributeIndex < format->count, "Invalid attribute index: %d", attributeIndex + 1);
+    Attribute attribute = format->attributes[attributeIndex];
+    lovrAssert(attribute.type == ATTR_FLOAT, "Only float attributes can be filled with random numbers");
+    distribution = *(RandomDistribution*) luax_checkenum(L, 4, &RandomDistributions, "random distribution");
+    int start = luaL_optint(L, 5, 1) - 1;
+    lovrAssert(start >= 0 && (uint32_t) start < vertexData->count, "Invalid vertex index: %d", start + 1);
+    int vertexCount = luaL_optint(L, 6, vertexData->count - start);
+    lovrAssert(vertexCount >= 0, "Invalid vertex count: %d", vertexCount);
+    lovrAssert((uint32_t) vertexCount <= vertexData->count - start, "VertexData can only hold %d vertices", vertexData->count);
+    count = vertexCount;
+    data = (float*) (vertexData->data.bytes + start * format->stride + attribute.offset);
+    components = attribute.count;
+    stride = format->stride;
+    index = 7;
+  } else {
+    Blob* blob = luax_checktype(L, 2, Blob);
+    distribution = *(RandomDistribution*) luax_checkenum(L, 3, &RandomDistributions, "random distribution");
+    components = luaL_optint(L, 4, 1);
+    lovrAssert(components >= 1 && components <= 4, "Random vectors must have between 1 and 4 components");
+    stride = components * sizeof(float);
+    count = blob->size / stride;
+    data = blob->data;
+    index = 5;
+  }
+
+  float params[4];
+  switch (distribution) {
+    case DISTRIBUTION_UNIFORM:
+      params[0] = luaL_optnumber(L, index, 0.);
+      params[1] = luaL_optnumber(L, index + 1, 1.);
+      break;
+
+    case DISTRIBUTION_NORMAL:
+      params[0] = luaL_optnumber(L, index, 1.);
+      params[1] = luaL_optnumber(L, index + 1, 0.);
+      break;
+
+    case DISTRIBUTION_SPHERE:
+      params[0] = luaL_optnumber(L, index, 1.);
+      break;
+
+    case DISTRIBUTION_BOX:
+      for (int i = 0; i < 4; i++) {
+        params[i] = luaL_optnumber(L, index + i, i > 0 ? params[i - 1] : 1.);
+      }
+      break;
+  }
+
+  lovrRandomGeneratorFill(generator, distribution, params, data, count, components, stride);
+  lua_pushinteger(L, count);
+  return 1;
+}
+
 const luaL_Reg lovrRandomGenerator[] = {
   { "getSeed", l_lovrRandomGeneratorGetSeed },
   { "setSeed", l_lovrRandomGeneratorSetSeed },
@@ -91,5 +164,6 @@ const luaL_Reg lovrRandomGenerator[] = {
   { "setState", l_lovrRandomGeneratorSetState },
   { "random", l_lovrRandomGeneratorRandom },
   { "randomNormal", l_lovrRandomGeneratorRandomNormal },
+  { "fill", l_lovrRandomGeneratorFill },
   { NULL, NULL }
 };
@@ -0,0 +1,64 @@
+#include "api.h"
+#include "filesystem/reader.h"
+
+int l_lovrReadRequestCancel(lua_State* L) {
+  ReadRequest* request = luax_checktype(L, 1, ReadRequest);
+  lovrReadRequestCancel(request);
+  return 0;
+}
+
+int l_lovrReadRequestGetBlob(lua_State* L) {
+  ReadRequest* request = luax_checktype(L, 1, ReadRequest);
+  Blob* blob = lovrReadRequestGetBlob(request);
+  if (blob) {
+    luax_pushtype(L, Blob, blob);
+  } else {
+    lua_pushnil(L);
+  }
+  return 1;
+}
+
+int l_lovrReadRequestGetLatency(lua_State* L) {
+  ReadRequest* request = luax_checktype(L, 1, ReadRequest);
+  double wait, read;
+  lovrReadRequestGetLatency(request, &wait, &read);
+  lua_pushnumber(L, wait);
+  lua_pushnumber(L, read);
+  return 2;
+}
+
+int l_lovrReadRequestGetPath(lua_State* L) {
+  ReadRequest* request = luax_checktype(L, 1, ReadRequest);
+  lua_pushstring(L, request->path);
+  return 1;
+}
+
+int l_lovrReadRequestGetPriority(lua_State* L) {
+  ReadRequest* request = luax_checktype(L, 1, ReadRequest);
+  lua_pushinteger(L, request->priority);
+  return 1;
+}
+
+int l_lovrReadRequestGetStatus(lua_State* L) {
+  ReadRequest* request = luax_checktype(L, 1, ReadRequest);
+  luax_pushenum(L, &ReadStatuses, lovrReadRequestGetStatus(request));
+  return 1;
+}
+
+int l_lovrReadRequestIsComplete(lua_State* L) {
+  ReadRequest* request = luax_checktype(L, 1, ReadRequest);
+  ReadStatus status = lovrReadRequestGetStatus(request);
+  lua_pushboolean(L, status != READ_PENDING && status != READ_ACTIVE);
+  return 1;
+}
+
+const luaL_Reg lovrReadRequest[] = {
+  { "cancel", l_lovrReadRequestCancel },
+  { "getBlob", l_lovrReadRequestGetBlob },
+  { "getLatency", l_lovrReadRequestGetLatency },
+  { "getPath", l_lovrReadRequestGetPath },
+  { "getPriority", l_lovrReadRequestGetPriority },
+  { "getStatus", l_lovrReadRequestGetStatus },
+  { "isComplete", l_lovrReadRequestIsComplete },
+  { NULL, NULL }
+};
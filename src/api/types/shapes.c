@@ -7,6 +7,8 @@ int luax_pushshape(lua_State* L, Shape* shape) {
     case SHAPE_BOX: luax_pushtype(L, BoxShape, shape); return 1;
     case SHAPE_CAPSULE: luax_pushtype(L, CapsuleShape, shape); return 1;
     case SHAPE_CYLINDER: luax_pushtype(L, CylinderShape, shape); return 1;
+    case SHAPE_MESH: luax_pushtype(L, MeshShape, shape); return 1;
+    case SHAPE_HEIGHTFIELD: luax_pushtype(L, HeightfieldShape, shape); return 1;
     default: return 0;
   }
 }
@@ -262,3 +264,18 @@ const luaL_Reg lovrCylinderShape[] = {
   { "setLength", l_lovrCylinderShapeSetLength },
   { NULL, NULL }
 };
+
+int l_lovrMeshShapeGetTriangleCount(lua_State* L) {
+  MeshShape* mesh = luax_checktype(L, 1, MeshShape);
+  lua_pushinteger(L, lovrMeshShapeGetTriangleCount(mesh));
+  return 1;
+}
+
+const luaL_Reg lovrMeshShape[] = {
+  { "getTriangleCount", l_lovrMeshShapeGetTriangleCount },
+  { NULL, NULL }
+};
+
+const luaL_Reg lovrHeightfieldShape[] = {
+  { NULL, NULL }
+};
@@ -8,6 +8,12 @@ int l_lovrSourceGetBitDepth(lua_State* L) {
   return 1;
 }
 
+int l_lovrSourceGetBufferCount(lua_State* L) {
+  Source* source = luax_checktype(L, 1, Source);
+  lua_pushinteger(L, lovrSourceGetBufferCount(source));
+  return 1;
+}
+
 int l_lovrSourceGetChannelCount(lua_State* L) {
   Source* source = luax_checktype(L, 1, Source);
   lua_pushinteger(L, lovrSourceGetChannelCount(source));
@@ -63,6 +69,18 @@ int l_lovrSourceGetPitch(lua_State* L) {
   return 1;
 }
 
+int l_lovrSourceGetPriority(lua_State* L) {
+  Source* source = luax_checktype(L, 1, Source);
+  lua_pushinteger(L, lovrSourceGetPriority(source));
+  return 1;
+}
+
+int l_lovrSourceGetType(lua_State* L) {
+  Source* source = luax_checktype(L, 1, Source);
+  luax_pushenum(L, &SourceTypes, lovrSourceGetType(source));
+  return 1;
+}
+
 int l_lovrSourceGetPosition(lua_State* L) {
   float x, y, z;
   lovrSourceGetPosition(luax_checktype(L, 1, Source), &x, &y, &z);
@@ -127,6 +145,11 @@ int l_lovrSourceIsStopped(lua_State* L) {
   return 1;
 }
 
+int l_lovrSourceIsVirtual(lua_State* L) {
+  lua_pushboolean(L, lovrSourceIsVirtual(luax_checktype(L, 1, Source)));
+  return 1;
+}
+
 int l_lovrSourcePause(lua_State* L) {
   lovrSourcePause(luax_checktype(L, 1, Source));
   return 0;
@@ -201,6 +224,12 @@ int l_lovrSourceSetPitch(lua_State* L) {
   return 0;
 }
 
+int l_lovrSourceSetPriority(lua_State* L) {
+  Source* source = luax_checktype(L, 1, Source);
+  lovrSourceSetPriority(source, luaL_checkinteger(L, 2));
+  return 0;
+}
+
 int l_lovrSourceSetPosition(lua_State* L) {
   Source* source = luax_checktype(L, 1, Source);
   float x = luaL_checknumber(L, 2);
@@ -257,6 +286,7 @@ int l_lovrSourceTell(lua_State* L) {
 
 const luaL_Reg lovrSource[] = {
   { "getBitDepth", l_lovrSourceGetBitDepth },
+  { "getBufferCount", l_lovrSourceGetBufferCount },
   { "getChannelCount", l_lovrSourceGetChannelCount },
   { "getCone", l_lovrSourceGetCone },
   { "getDirection", l_lovrSourceGetDirection },
@@ -264,7 +294,9 @@ const luaL_Reg lovrSource[] = {
   { "getFalloff", l_lovrSourceGetFalloff },
   { "getPitch", l_lovrSourceGetPitch },
   { "getPosition", l_lovrSourceGetPosition },
+  { "getPriority", l_lovrSourceGetPriority },
   { "getSampleRate", l_lovrSourceGetSampleRate },
+  { "getType", l_lovrSourceGetType },
   { "getVelocity", l_lovrSourceGetVelocity },
   { "getVolume", l_lovrSourceGetVolume },
   { "getVolumeLimits", l_lovrSourceGetVolumeLimits },
@@ -273,6 +305,7 @@ const luaL_Reg lovrSource[] = {
   { "isPlaying", l_lovrSourceIsPlaying },
   { "isRelative", l_lovrSourceIsRelative },
   { "isStopped", l_lovrSourceIsStopped },
+  { "isVirtual", l_lovrSourceIsVirtual },
   { "pause", l_lovrSourcePause },
   { "play", l_lovrSourcePlay },
   { "resume", l_lovrSourceResume },
@@ -284,6 +317,7 @@ const luaL_Reg lovrSource[] = {
   { "setLooping", l_lovrSourceSetLooping },
   { "setPitch", l_lovrSourceSetPitch },
   { "setPosition", l_lovrSourceSetPosition },
+  { "setPriority", l_lovrSourceSetPriority },
   { "setRelative", l_lovrSourceSetRelative },
   { "setVelocity", l_lovrSourceSetVelocity },
   { "setVolume", l_lovrSourceSetVolume },
@@ -1,6 +1,7 @@
 #include "api.h"
 #include "math/mat4.h"
 #include "math/transform.h"
+#include "data/blob.h"
 
 int luax_readtransform(lua_State* L, int index, mat4 m, bool uniformScale) {
   if (lua_isnumber(L, index)) {
@@ -161,6 +162,30 @@ int l_lovrTransformInverseTransformPoint(lua_State* L) {
   return 3;
 }
 
+// Transforms a Blob of tightly packed xyz floats in place
+static int luax_transformpoints(lua_State* L, bool inverse) {
+  Transform* transform = luax_checktype(L, 1, Transform);
+  Blob* blob = luax_checktype(L, 2, Blob);
+  int maxCount = blob->size / (3 * sizeof(float));
+  int count = luaL_optinteger(L, 3, maxCount);
+  lovrAssert(count >= 0 && count <= maxCount, "Blob only contains %d points", maxCount);
+  if (inverse) {
+    lovrTransformInverseTransformPoints(transform, blob->data, count);
+  } else {
+    lovrTransformTransformPoints(transform, blob->data, count);
+  }
+  lua_pushvalue(L, 2);
+  return 1;
+}
+
+int l_lovrTransformTransformPoints(lua_State* L) {
+  return luax_transformpoints(L, false);
+}
+
+int l_lovrTransformInverseTransformPoints(lua_State* L) {
+  return luax_transformpoints(L, true);
+}
+
 const luaL_Reg lovrTransform[] = {
   { "getMatrix", l_lovrTransformGetMatrix },
   { "setMatrix", l_lovrTransformSetMatrix },
@@ -174,5 +199,7 @@ const luaL_Reg lovrTransform[] = {
   { "setTransformation", l_lovrTransformSetTransformation },
   { "transformPoint", l_lovrTransformTransformPoint },
   { "inverseTransformPoint", l_lovrTransformInverseTransformPoint },
+  { "transformPoints", l_lovrTransformTransformPoints },
+  { "inverseTransformPoints", l_lovrTransformInverseTransformPoints },
   { NULL, NULL }
 };
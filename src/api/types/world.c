@@ -1,6 +1,10 @@
 #include "api.h"
 #include "physics/physics.h"
+#include "data/blob.h"
+#include "data/vertexData.h"
+#include "allocator.h"
 #include <stdbool.h>
+#include <stdlib.h>
 
 static void collisionResolver(World* world, void* userdata) {
   lua_State* L = userdata;
@@ -241,6 +245,83 @@ int l_lovrWorldIsCollisionEnabledBetween(lua_State* L) {
   return 1;
 }
 
+int l_lovrWorldGetColliders(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  vec_void_t* colliders = lovrWorldGetColliders(world);
+  lua_createtable(L, colliders->length, 0);
+  for (int i = 0; i < colliders->length; i++) {
+    luax_pushtype(L, Collider, colliders->data[i]);
+    lua_rawseti(L, -2, i + 1);
+  }
+  return 1;
+}
+
+// Everything that can throw is checked before the arena mark is taken, since nothing resets the
+// arena on other threads and an error in between would leak the collider list.
+int l_lovrWorldGetColliderTransforms(lua_State* L) {
+  World* world = luax_checktype(L, 1, World);
+  TransformFormat format = *(TransformFormat*) luax_optenum(L, 4, "matrix", &TransformFormats, "transform format");
+  bool all = lua_isnoneornil(L, 3);
+  int count;
+
+  if (all) {
+    count = lovrWorldGetColliders(world)->length;
+  } else {
+    luaL_checktype(L, 3, LUA_TTABLE);
+    count = lua_objlen(L, 3);
+    for (int i = 0; i < count; i++) {
+      lua_rawgeti(L, 3, i + 1);
+      Collider* collider = luax_checktype(L, -1, Collider);
+      lua_pop(L, 1);
+      if (!collider->body || collider->world != world) {
+        return luaL_error(L, "Collider #%d does not belong to this World", i + 1);
+      }
+    }
+  }
+
+  size_t transformSize = lovrWorldGetTransformSize(format);
+  size_t size = count * transformSize;
+  void* dest;
+  void** type;
+  if (lua_isnoneornil(L, 2)) {
+    dest = malloc(size);
+    Blob* blob = lovrBlobCreate(dest, size, "World:getColliderTransforms");
+    luax_pushtype(L, Blob, blob);
+    lovrRelease(blob);
+  } else if ((type = luax_totype(L, 2, VertexData)) != NULL) {
+    VertexData* vertexData = *type;
+    VertexFormat* vertexFormat = &vertexData->format;
+    lovrAssert(vertexFormat->stride == transformSize, "VertexData stride must be %d bytes to hold transforms", (int) transformSize);
+    for (int i = 0; i < vertexFormat->count; i++) {
+      lovrAssert(vertexFormat->attributes[i].type == ATTR_FLOAT, "VertexData attributes must be floats to hold transforms");
+    }
+    lovrAssert((uint32_t) count <= vertexData->count, "VertexData is too small to hold %d transforms (%d vertices available)", count, vertexData->count);
+    dest = vertexData->data.raw;
+    lua_pushvalue(L, 2);
+  } else {
+    Blob* blob = luax_checktype(L, 2, Blob);
+    lovrAssert(size <= blob->size, "Blob is too small to hold %d transforms (%d bytes needed, %d available)", count, (int) size, (int) blob->size);
+    dest = blob->data;
+    lua_pushvalue(L, 2);
+  }
+
+  Collider** colliders = NULL;
+  ArenaMark mark = lovrArenaMark();
+  if (!all) {
+    colliders = lovrArenaAlloc(count * sizeof(Collider*));
+    for (int i = 0; i < count; i++) {
+      lua_rawgeti(L, 3, i + 1);
+      colliders[i] = *(Collider**) luax_totype(L, -1, Collider);
+      lua_pop(L, 1);
+    }
+  }
+
+  lovrWorldGetColliderTransforms(world, colliders, count, format, dest);
+  lovrArenaRestore(mark);
+  lua_pushinteger(L, count);
+  return 2;
+}
+
 const luaL_Reg lovrWorld[] = {
   { "newCollider", l_lovrWorldNewCollider },
   { "newBoxCollider", l_lovrWorldNewBoxCollider },
@@ -264,5 +345,7 @@ const luaL_Reg lovrWorld[] = {
   { "disableCollisionBetween", l_lovrWorldDisableCollisionBetween },
   { "enableCollisionBetween", l_lovrWorldEnableCollisionBetween },
   { "isCollisionEnabledBetween", l_lovrWorldIsCollisionEnabledBetween },
+  { "getColliders", l_lovrWorldGetColliders },
+  { "getColliderTransforms", l_lovrWorldGetColliderTransforms },
   { NULL, NULL }
 };
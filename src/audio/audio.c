@@ -1,15 +1,150 @@
 #include "audio/audio.h"
 #include "math/vec3.h"
 #include "math/quat.h"
+#include "timer/profiler.h"
 #include "util.h"
+#include <math.h>
 #include <stdlib.h>
 
 static AudioState state;
 
-void lovrAudioInit() {
+// Estimates how loud a Source is at the listener using OpenAL's default inverse clamped falloff
+static float lovrAudioGetAudibility(Source* source) {
+  float gain = source->volume;
+
+  if (lovrSourceGetChannelCount(source) == 1) {
+    float reference = source->falloff[0];
+    float max = source->falloff[1];
+    float rolloff = source->falloff[2];
+    float d[3];
+    vec3_init(d, source->position);
+    if (!source->isRelative) {
+      d[0] -= state.position[0];
+      d[1] -= state.position[1];
+      d[2] -= state.position[2];
+    }
+    float distance = fmaxf(reference, fminf(vec3_length(d), max));
+    gain *= reference / (reference + rolloff * (distance - reference));
+  }
+
+  return gain;
+}
+
+static bool lovrAudioOutranks(Source* a, Source* b) {
+  if (a->priority != b->priority) {
+    return a->priority > b->priority;
+  }
+
+  return lovrAudioGetAudibility(a) > lovrAudioGetAudibility(b);
+}
+
+static void lovrAudioRetire(Source* source, int index) {
+  vec_splice(&state.sources, index, 1);
+  vec_push(&state.finished, source);
+  source->isActive = false;
+  source->isRetired = true;
+}
+
+// Refills streaming buffers, advances virtual sources, and retires stopped sources.  Must be called
+// with the lock held.  Retired sources are released later on the main thread so refcounts are only
+// touched there.  Returns how long the audio thread can sleep before the shortest streaming buffer
+// that's playing runs out, so small buffers are refilled often enough and large ones don't cost
+// extra wakeups.
+static double lovrAudioRefill() {
+  double time = lovrGetTicks() / 1e9;
+  float dt = state.time > 0 ? time - state.time : 0;
+  state.time = time;
+  double interval = AUDIO_THREAD_MAX_INTERVAL;
+
+  Source* loudestVirtual = NULL;
+  Source* quietestVoice = NULL;
+
+  int i; Source* source;
+  vec_foreach_rev(&state.sources, source, i) {
+    if (!source->id) {
+      lovrSourceAdvance(source, dt);
+      if (lovrSourceIsStopped(source)) {
+        lovrAudioRetire(source, i);
+      } else if (!source->isPaused && (!loudestVirtual || lovrAudioOutranks(source, loudestVirtual))) {
+        loudestVirtual = source;
+      }
+      continue;
+    }
+
+    bool isStopped = lovrSourceIsStopped(source);
+
+    if (source->type == SOURCE_STATIC) {
+      if (isStopped) {
+        lovrSourceStop(source);
+        lovrAudioRetire(source, i);
+        continue;
+      }
+    } else {
+      ALint processed;
+      alGetSourcei(source->id, AL_BUFFERS_PROCESSED, &processed);
+
+      if (processed) {
+        ALuint buffers[MAX_SOURCE_BUFFERS];
+        alSourceUnqueueBuffers(source->id, processed, buffers);
+        lovrSourceStream(source, buffers, processed);
+        if (isStopped) {
+          alSourcePlay(source->id);
+        }
+      } else if (isStopped) {
+        lovrSourceStop(source);
+        lovrAudioRetire(source, i);
+        continue;
+      }
+
+      AudioStream* stream = source->stream;
+      int samplesPerBuffer = stream->bufferSize / stream->channelCount / sizeof(ALshort);
+      double duration = samplesPerBuffer / (double) stream->sampleRate / source->pitch;
+      interval = MIN(interval, duration / 2.);
+    }
+
+    if (!quietestVoice || lovrAudioOutranks(quietestVoice, source)) {
+      quietestVoice = source;
+    }
+  }
+
+  // Give the most important virtual source a voice, taking one away from a less important source
+  if (loudestVirtual) {
+    if (state.freeVoiceCount > 0) {
+      lovrSourceRestore(loudestVirtual, state.freeVoices[--state.freeVoiceCount]);
+    } else if (quietestVoice && lovrAudioOutranks(loudestVirtual, quietestVoice)) {
+      lovrSourceRestore(loudestVirtual, lovrSourceVirtualize(quietestVoice));
+    }
+  }
+
+  return MAX(interval, AUDIO_THREAD_MIN_INTERVAL);
+}
+
+static int lovrAudioThreadMain(void* data) {
+  for (;;) {
+    mtx_lock(&state.lock);
+
+    if (!state.isThreaded) {
+      mtx_unlock(&state.lock);
+      break;
+    }
+
+    double interval = lovrAudioRefill();
+    mtx_unlock(&state.lock);
+    lovrSleep(interval);
+  }
+
+  return 0;
+}
+
+// A NULL device name opens the default device.  If a named device isn't available (e.g. the "No Output"
+// device, which only exists in OpenAL Soft), the default device is used instead.
+void lovrAudioInit(const char* deviceName) {
   if (state.initialized) return;
 
-  ALCdevice* device = alcOpenDevice(NULL);
+  ALCdevice* device = alcOpenDevice(deviceName);
+  if (!device && deviceName) {
+    device = alcOpenDevice(NULL);
+  }
   lovrAssert(device, "Unable to open default audio device");
 
   ALCcontext* context = alcCreateContext(device, NULL);
@@ -29,48 +164,219 @@ void lovrAudioInit() {
   state.device = device;
   state.context = context;
   vec_init(&state.sources);
+  vec_init(&state.finished);
+  vec_init(&state.buffers);
+  map_init(&state.cache);
   quat_set(state.orientation, 0, 0, 0, -1);
   vec3_set(state.position, 0, 0, 0);
   vec3_set(state.velocity, 0, 0, 0);
+  mtx_init(&state.lock, mtx_plain | mtx_recursive);
+
+  // Allocate as many voices as the device will give us, up to a fixed limit
+  for (state.voiceCount = 0; state.voiceCount < MAX_VOICES; state.voiceCount++) {
+    alGenSources(1, &state.voices[state.voiceCount]);
+    if (alGetError() != AL_NO_ERROR) {
+      break;
+    }
+    state.freeVoices[state.voiceCount] = state.voices[state.voiceCount];
+  }
+  state.freeVoiceCount = state.voiceCount;
+  state.time = 0;
+
+  state.isThreaded = true;
+  if (thrd_create(&state.thread, lovrAudioThreadMain, NULL) != thrd_success) {
+    state.isThreaded = false;
+  }
   state.initialized = true;
 }
 
 void lovrAudioDestroy() {
   if (!state.initialized) return;
+
+  if (state.isThreaded) {
+    mtx_lock(&state.lock);
+    state.isThreaded = false;
+    mtx_unlock(&state.lock);
+    thrd_join(state.thread, NULL);
+  }
+
+  int i; Source* source;
+  vec_foreach(&state.finished, source, i) {
+    lovrRelease(source);
+  }
+
+  lovrAudioClearCache();
+  alDeleteSources(state.voiceCount, state.voices);
   alcMakeContextCurrent(NULL);
   alcDestroyContext(state.context);
   alcCloseDevice(state.device);
   vec_deinit(&state.sources);
+  vec_deinit(&state.finished);
+  vec_deinit(&state.buffers);
+  map_deinit(&state.cache);
+  mtx_destroy(&state.lock);
   memset(&state, 0, sizeof(AudioState));
 }
 
 void lovrAudioUpdate() {
+  lovrProfilerPush("audio");
+  mtx_lock(&state.lock);
+
+  // Without a streaming thread, fall back to refilling buffers once per frame
+  if (!state.isThreaded) {
+    lovrAudioRefill();
+  }
+
   int i; Source* source;
-  vec_foreach_rev(&state.sources, source, i) {
-    bool isStopped = lovrSourceIsStopped(source);
-    ALint processed;
-    alGetSourcei(source->id, AL_BUFFERS_PROCESSED, &processed);
+  vec_foreach(&state.finished, source, i) {
+    source->isRetired = false;
+    lovrRelease(source);
+  }
+  vec_clear(&state.finished);
 
-    if (processed) {
-      ALuint buffers[SOURCE_BUFFERS];
-      alSourceUnqueueBuffers(source->id, processed, buffers);
-      lovrSourceStream(source, buffers, processed);
-      if (isStopped) {
-        alSourcePlay(source->id);
+  mtx_unlock(&state.lock);
+  lovrProfilerPop();
+}
+
+void lovrAudioAdd(Source* source) {
+  mtx_lock(&state.lock);
+  if (!source->isActive) {
+    if (source->isRetired) {
+      vec_remove(&state.finished, source);
+      source->isRetired = false;
+    } else {
+      lovrRetain(source);
+    }
+    vec_push(&state.sources, source);
+    source->isActive = true;
+  }
+  mtx_unlock(&state.lock);
+}
+
+// Takes a free voice, or steals one from the least important source if this one outranks it
+ALuint lovrAudioAcquireVoice(Source* source) {
+  if (state.freeVoiceCount > 0) {
+    return state.freeVoices[--state.freeVoiceCount];
+  }
+
+  int i; Source* other;
+  Source* victim = NULL;
+  vec_foreach(&state.sources, other, i) {
+    if (other->id && (!victim || lovrAudioOutranks(victim, other))) {
+      victim = other;
+    }
+  }
+
+  if (victim && lovrAudioOutranks(source, victim)) {
+    return lovrSourceVirtualize(victim);
+  }
+
+  return 0;
+}
+
+void lovrAudioReleaseVoice(ALuint voice) {
+  state.freeVoices[state.freeVoiceCount++] = voice;
+}
+
+void lovrAudioGetVoiceCount(int* active, int* virtual, int* total) {
+  mtx_lock(&state.lock);
+  int i; Source* source;
+  *virtual = 0;
+  vec_foreach(&state.sources, source, i) {
+    *virtual += source->isVirtual;
+  }
+  *active = state.voiceCount - state.freeVoiceCount;
+  *total = state.voiceCount;
+  mtx_unlock(&state.lock);
+}
+
+void lovrAudioLock() {
+  mtx_lock(&state.lock);
+}
+
+void lovrAudioUnlock() {
+  mtx_unlock(&state.lock);
+}
+
+ALuint lovrAudioAcquireBuffer(SoundData* soundData) {
+  mtx_lock(&state.lock);
+  int i; SoundBuffer* buffer;
+  vec_foreach(&state.buffers, buffer, i) {
+    if (buffer->soundData == soundData) {
+      buffer->references++;
+      mtx_unlock(&state.lock);
+      return buffer->id;
+    }
+  }
+
+  buffer = malloc(sizeof(SoundBuffer));
+  buffer->soundData = soundData;
+  buffer->references = 1;
+  alGenBuffers(1, &buffer->id);
+  ALenum format = lovrAudioConvertFormat(soundData->bitDepth, soundData->channelCount);
+  alBufferData(buffer->id, format, soundData->data, soundData->size, soundData->sampleRate);
+  lovrRetain(soundData);
+  vec_push(&state.buffers, buffer);
+  mtx_unlock(&state.lock);
+  return buffer->id;
+}
+
+void lovrAudioReleaseBuffer(SoundData* soundData) {
+  mtx_lock(&state.lock);
+  int i; SoundBuffer* buffer;
+  vec_foreach(&state.buffers, buffer, i) {
+    if (buffer->soundData == soundData) {
+      if (--buffer->references == 0) {
+        alDeleteBuffers(1, &buffer->id);
+        lovrRelease(buffer->soundData);
+        vec_splice(&state.buffers, i, 1);
+        free(buffer);
       }
-    } else if (isStopped) {
-      lovrAudioStreamRewind(source->stream);
-      vec_splice(&state.sources, i, 1);
-      lovrRelease(source);
+      break;
     }
   }
+  mtx_unlock(&state.lock);
 }
 
-void lovrAudioAdd(Source* source) {
-  if (!lovrAudioHas(source)) {
-    lovrRetain(source);
-    vec_push(&state.sources, source);
+SoundData* lovrAudioGetCachedSound(const char* key) {
+  void** soundData = map_get(&state.cache, key);
+  return soundData ? *soundData : NULL;
+}
+
+void lovrAudioCacheSound(const char* key, SoundData* soundData) {
+  SoundData* existing = lovrAudioGetCachedSound(key);
+  if (existing == soundData) {
+    return;
   }
+
+  lovrRetain(soundData);
+  lovrRelease(existing);
+  map_set(&state.cache, key, soundData);
+}
+
+void lovrAudioClearCache() {
+  const char* key;
+  map_iter_t iter = map_iter(&state.cache);
+  while ((key = map_next(&state.cache, &iter)) != NULL) {
+    lovrRelease(*map_get(&state.cache, key));
+  }
+
+  map_deinit(&state.cache);
+  map_init(&state.cache);
+}
+
+ALenum lovrAudioConvertFormat(int bitDepth, int channelCount) {
+  if (bitDepth == 8 && channelCount == 1) {
+    return AL_FORMAT_MONO8;
+  } else if (bitDepth == 8 && channelCount == 2) {
+    return AL_FORMAT_STEREO8;
+  } else if (bitDepth == 16 && channelCount == 1) {
+    return AL_FORMAT_MONO16;
+  } else if (bitDepth == 16 && channelCount == 2) {
+    return AL_FORMAT_STEREO16;
+  }
+
+  return 0;
 }
 
 void lovrAudioGetDopplerEffect(float* factor, float* speedOfSound) {
@@ -101,9 +407,7 @@ float lovrAudioGetVolume() {
 }
 
 bool lovrAudioHas(Source* source) {
-  int index;
-  vec_find(&state.sources, source, index);
-  return index >= 0;
+  return source->isActive;
 }
 
 bool lovrAudioIsSpatialized() {
@@ -111,24 +415,30 @@ bool lovrAudioIsSpatialized() {
 }
 
 void lovrAudioPause() {
+  mtx_lock(&state.lock);
   int i; Source* source;
   vec_foreach(&state.sources, source, i) {
     lovrSourcePause(source);
   }
+  mtx_unlock(&state.lock);
 }
 
 void lovrAudioResume() {
+  mtx_lock(&state.lock);
   int i; Source* source;
   vec_foreach(&state.sources, source, i) {
     lovrSourceResume(source);
   }
+  mtx_unlock(&state.lock);
 }
 
 void lovrAudioRewind() {
+  mtx_lock(&state.lock);
   int i; Source* source;
   vec_foreach(&state.sources, source, i) {
     lovrSourceRewind(source);
   }
+  mtx_unlock(&state.lock);
 }
 
 void lovrAudioSetDopplerEffect(float factor, float speedOfSound) {
@@ -166,8 +476,10 @@ void lovrAudioSetVolume(float volume) {
 }
 
 void lovrAudioStop() {
+  mtx_lock(&state.lock);
   int i; Source* source;
   vec_foreach(&state.sources, source, i) {
     lovrSourceStop(source);
   }
+  mtx_unlock(&state.lock);
 }
@@ -1,5 +1,8 @@
 #include "audio/source.h"
+#include "data/soundData.h"
+#include "lib/map/map.h"
 #include "lib/vec/vec.h"
+#include "lib/tinycthread/tinycthread.h"
 #include <AL/al.h>
 #include <AL/alc.h>
 #include <AL/alext.h>
@@ -7,21 +10,53 @@
 
 #pragma once
 
+#define AUDIO_THREAD_MIN_INTERVAL .001
+#define AUDIO_THREAD_MAX_INTERVAL .02
+#define MAX_VOICES 64
+
+typedef struct {
+  SoundData* soundData;
+  ALuint id;
+  int references;
+} SoundBuffer;
+
 typedef struct {
   bool initialized;
   ALCdevice* device;
   ALCcontext* context;
   vec_void_t sources;
+  vec_void_t finished;
+  vec_void_t buffers;
+  map_void_t cache;
   bool isSpatialized;
   float orientation[4];
   float position[3];
   float velocity[4];
+  ALuint voices[MAX_VOICES];
+  ALuint freeVoices[MAX_VOICES];
+  int voiceCount;
+  int freeVoiceCount;
+  double time;
+  thrd_t thread;
+  mtx_t lock;
+  bool isThreaded;
 } AudioState;
 
-void lovrAudioInit();
+void lovrAudioInit(const char* deviceName);
 void lovrAudioDestroy();
 void lovrAudioUpdate();
 void lovrAudioAdd(Source* source);
+void lovrAudioLock();
+void lovrAudioUnlock();
+ALuint lovrAudioAcquireVoice(Source* source);
+void lovrAudioReleaseVoice(ALuint voice);
+void lovrAudioGetVoiceCount(int* active, int* virtual, int* total);
+ALuint lovrAudioAcquireBuffer(SoundData* soundData);
+void lovrAudioReleaseBuffer(SoundData* soundData);
+SoundData* lovrAudioGetCachedSound(const char* key);
+void lovrAudioCacheSound(const char* key, SoundData* soundData);
+void lovrAudioClearCache();
+ALenum lovrAudioConvertFormat(int bitDepth, int channelCount);
 void lovrAudioGetDopplerEffect(float* factor, float* speedOfSound);
 void lovrAudioGetOrientation(float* angle, float* ax, float* ay, float* az);
 void lovrAudioGetPosition(float* x, float* y, float* z);
@@ -1,122 +1,200 @@
 #include "audio/source.h"
+#include "audio/audio.h"
 #include "data/audioStream.h"
+#include "math/vec3.h"
+#include "allocator.h"
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <float.h>
 #include <stdlib.h>
 
 static ALenum lovrSourceGetFormat(Source* source) {
-  int channelCount = source->stream->channelCount;
-  int bitDepth = source->stream->bitDepth;
-
-  if (bitDepth == 8 && channelCount == 1) {
-    return AL_FORMAT_MONO8;
-  } else if (bitDepth == 8 && channelCount == 2) {
-    return AL_FORMAT_STEREO8;
-  } else if (bitDepth == 16 && channelCount == 1) {
-    return AL_FORMAT_MONO16;
-  } else if (bitDepth == 16 && channelCount == 2) {
-    return AL_FORMAT_STEREO16;
-  }
-
-  return 0;
+  return lovrAudioConvertFormat(lovrSourceGetBitDepth(source), lovrSourceGetChannelCount(source));
 }
 
+// Sources without a voice report the state they would have if they were audible.  The audio thread
+// can steal a voice at any time, so the id is only read with the lock held.
 static ALenum lovrSourceGetState(Source* source) {
   ALenum state;
-  alGetSourcei(source->id, AL_SOURCE_STATE, &state);
+  lovrAudioLock();
+  if (!source->id) {
+    state = source->isVirtual ? (source->isPaused ? AL_PAUSED : AL_PLAYING) : AL_STOPPED;
+  } else {
+    alGetSourcei(source->id, AL_SOURCE_STATE, &state);
+  }
+  lovrAudioUnlock();
   return state;
 }
 
-Source* lovrSourceCreate(AudioStream* stream) {
-  Source* source = lovrAlloc(sizeof(Source), lovrSourceDestroy);
+// Voices are shared between Sources, so all parameters are cached and reapplied on acquisition
+static void lovrSourceApply(Source* source) {
+  ALuint id = source->id;
+  alSourcefv(id, AL_POSITION, source->position);
+  alSourcefv(id, AL_VELOCITY, source->velocity);
+  alSourcefv(id, AL_DIRECTION, source->direction);
+  alSourcef(id, AL_CONE_INNER_ANGLE, source->cone[0] * 180.f / M_PI);
+  alSourcef(id, AL_CONE_OUTER_ANGLE, source->cone[1] * 180.f / M_PI);
+  alSourcef(id, AL_CONE_OUTER_GAIN, source->cone[2]);
+  alSourcef(id, AL_REFERENCE_DISTANCE, source->falloff[0]);
+  alSourcef(id, AL_MAX_DISTANCE, source->falloff[1]);
+  alSourcef(id, AL_ROLLOFF_FACTOR, source->falloff[2]);
+  alSourcef(id, AL_MIN_GAIN, source->volumeLimits[0]);
+  alSourcef(id, AL_MAX_GAIN, source->volumeLimits[1]);
+  alSourcef(id, AL_PITCH, source->pitch);
+  alSourcef(id, AL_GAIN, source->volume);
+  alSourcei(id, AL_SOURCE_RELATIVE, source->isRelative ? AL_TRUE : AL_FALSE);
+
+  if (source->type == SOURCE_STATIC) {
+    alSourcei(id, AL_LOOPING, source->isLooping ? AL_TRUE : AL_FALSE);
+    alSourcei(id, AL_BUFFER, source->buffer);
+  } else {
+    alSourcei(id, AL_LOOPING, AL_FALSE);
+  }
+}
+
+static Pool sourcePool = POOL_INIT("Source", Source);
+
+static Source* lovrSourceAlloc(SourceType type) {
+  Source* source = lovrAllocPooled(&sourcePool, lovrSourceDestroy);
   if (!source) return NULL;
 
-  source->stream = stream;
+  source->type = type;
+  source->soundData = NULL;
+  source->stream = NULL;
+  source->id = 0;
+  source->buffer = 0;
+  source->bufferCount = 0;
+  source->priority = 0;
+  source->isActive = false;
+  source->isRetired = false;
+  source->isVirtual = false;
+  source->isPaused = false;
+  source->virtualOffset = 0;
   source->isLooping = false;
-  alGenSources(1, &source->id);
-  alGenBuffers(SOURCE_BUFFERS, source->buffers);
+  source->isRelative = false;
+  vec3_set(source->position, 0, 0, 0);
+  vec3_set(source->velocity, 0, 0, 0);
+  vec3_set(source->direction, 0, 0, 0);
+  vec3_set(source->cone, 2 * M_PI, 2 * M_PI, 0);
+  vec3_set(source->falloff, 1, FLT_MAX, 1);
+  source->volumeLimits[0] = 0;
+  source->volumeLimits[1] = 1;
+  source->pitch = 1;
+  source->volume = 1;
+
+  return source;
+}
+
+// More buffers make a stream more tolerant of stalls at the cost of latency and memory
+Source* lovrSourceCreate(AudioStream* stream, int bufferCount) {
+  lovrAssert(bufferCount > 0 && bufferCount <= MAX_SOURCE_BUFFERS, "Source buffer count must be between 1 and %d", MAX_SOURCE_BUFFERS);
+  Source* source = lovrSourceAlloc(SOURCE_STREAM);
+  if (!source) return NULL;
+
+  source->stream = stream;
+  source->bufferCount = bufferCount;
+  alGenBuffers(bufferCount, source->buffers);
   lovrRetain(stream);
 
   return source;
 }
 
+// Static sources share a single, fully decoded AL buffer per SoundData and never stream
+Source* lovrSourceCreateStatic(SoundData* soundData) {
+  Source* source = lovrSourceAlloc(SOURCE_STATIC);
+  if (!source) return NULL;
+
+  source->soundData = soundData;
+  source->buffer = lovrAudioAcquireBuffer(soundData);
+  lovrRetain(soundData);
+
+  return source;
+}
+
 void lovrSourceDestroy(void* ref) {
   Source* source = ref;
-  alDeleteSources(1, &source->id);
-  alDeleteBuffers(SOURCE_BUFFERS, source->buffers);
-  lovrRelease(source->stream);
-  free(source);
+  if (source->id) {
+    lovrSourceStop(source);
+  }
+  if (source->type == SOURCE_STATIC) {
+    lovrAudioReleaseBuffer(source->soundData);
+    lovrRelease(source->soundData);
+  } else {
+    alDeleteBuffers(source->bufferCount, source->buffers);
+    lovrRelease(source->stream);
+  }
+  lovrPoolFree(&sourcePool, source);
 }
 
 int lovrSourceGetBitDepth(Source* source) {
-  return source->stream->bitDepth;
+  return source->type == SOURCE_STATIC ? source->soundData->bitDepth : source->stream->bitDepth;
+}
+
+int lovrSourceGetBufferCount(Source* source) {
+  return source->bufferCount;
 }
 
 void lovrSourceGetCone(Source* source, float* innerAngle, float* outerAngle, float* outerGain) {
-  alGetSourcef(source->id, AL_CONE_INNER_ANGLE, innerAngle);
-  alGetSourcef(source->id, AL_CONE_OUTER_ANGLE, outerAngle);
-  alGetSourcef(source->id, AL_CONE_OUTER_GAIN, outerGain);
-  *innerAngle *= M_PI / 180.f;
-  *outerAngle *= M_PI / 180.f;
+  *innerAngle = source->cone[0];
+  *outerAngle = source->cone[1];
+  *outerGain = source->cone[2];
 }
 
 int lovrSourceGetChannelCount(Source* source) {
-  return source->stream->channelCount;
+  return source->type == SOURCE_STATIC ? source->soundData->channelCount : source->stream->channelCount;
 }
 
 void lovrSourceGetDirection(Source* source, float* x, float* y, float* z) {
-  float v[3];
-  alGetSourcefv(source->id, AL_DIRECTION, v);
-  *x = v[0];
-  *y = v[1];
-  *z = v[2];
+  *x = source->direction[0];
+  *y = source->direction[1];
+  *z = source->direction[2];
 }
 
 int lovrSourceGetDuration(Source* source) {
-  return source->stream->samples;
+  return source->type == SOURCE_STATIC ? source->soundData->samples : source->stream->samples;
 }
 
 void lovrSourceGetFalloff(Source* source, float* reference, float* max, float* rolloff) {
-  alGetSourcef(source->id, AL_REFERENCE_DISTANCE, reference);
-  alGetSourcef(source->id, AL_MAX_DISTANCE, max);
-  alGetSourcef(source->id, AL_ROLLOFF_FACTOR, rolloff);
+  *reference = source->falloff[0];
+  *max = source->falloff[1];
+  *rolloff = source->falloff[2];
 }
 
 float lovrSourceGetPitch(Source* source) {
-  float pitch;
-  alGetSourcef(source->id, AL_PITCH, &pitch);
-  return pitch;
+  return source->pitch;
 }
 
 void lovrSourceGetPosition(Source* source, float* x, float* y, float* z) {
-  float v[3];
-  alGetSourcefv(source->id, AL_POSITION, v);
-  *x = v[0];
-  *y = v[1];
-  *z = v[2];
+  *x = source->position[0];
+  *y = source->position[1];
+  *z = source->position[2];
+}
+
+int lovrSourceGetPriority(Source* source) {
+  return source->priority;
 }
 
 int lovrSourceGetSampleRate(Source* source) {
-  return source->stream->sampleRate;
+  return source->type == SOURCE_STATIC ? source->soundData->sampleRate : source->stream->sampleRate;
+}
+
+SourceType lovrSourceGetType(Source* source) {
+  return source->type;
 }
 
 void lovrSourceGetVelocity(Source* source, float* x, float* y, float* z) {
-  float v[3];
-  alGetSourcefv(source->id, AL_VELOCITY, v);
-  *x = v[0];
-  *y = v[1];
-  *z = v[2];
+  *x = source->velocity[0];
+  *y = source->velocity[1];
+  *z = source->velocity[2];
 }
 
 float lovrSourceGetVolume(Source* source) {
-  float volume;
-  alGetSourcef(source->id, AL_GAIN, &volume);
-  return volume;
+  return source->volume;
 }
 
 void lovrSourceGetVolumeLimits(Source* source, float* min, float* max) {
-  alGetSourcef(source->id, AL_MIN_GAIN, min);
-  alGetSourcef(source->id, AL_MAX_GAIN, max);
+  *min = source->volumeLimits[0];
+  *max = source->volumeLimits[1];
 }
 
 bool lovrSourceIsLooping(Source* source) {
@@ -132,54 +210,108 @@ bool lovrSourceIsPlaying(Source* source) {
 }
 
 bool lovrSourceIsRelative(Source* source) {
-  int isRelative;
-  alGetSourcei(source->id, AL_SOURCE_RELATIVE, &isRelative);
-  return isRelative == AL_TRUE;
+  return source->isRelative;
 }
 
 bool lovrSourceIsStopped(Source* source) {
   return lovrSourceGetState(source) == AL_STOPPED;
 }
 
+bool lovrSourceIsVirtual(Source* source) {
+  return source->isVirtual;
+}
+
 void lovrSourcePause(Source* source) {
-  alSourcePause(source->id);
+  lovrAudioLock();
+  if (source->id) {
+    alSourcePause(source->id);
+  } else if (source->isVirtual) {
+    source->isPaused = true;
+  }
+  lovrAudioUnlock();
 }
 
 void lovrSourcePlay(Source* source) {
+  lovrAudioLock();
+
   if (lovrSourceIsPlaying(source)) {
+    lovrAudioUnlock();
     return;
   } else if (lovrSourceIsPaused(source)) {
     lovrSourceResume(source);
+    lovrAudioUnlock();
     return;
   }
 
-  lovrSourceStream(source, source->buffers, SOURCE_BUFFERS);
+  // If every voice is taken by something more important, play virtually until one frees up
+  if (!source->id) {
+    source->id = lovrAudioAcquireVoice(source);
+
+    if (!source->id) {
+      source->isVirtual = true;
+      source->isPaused = false;
+      if (source->type == SOURCE_STREAM) {
+        source->virtualOffset = lovrAudioStreamTell(source->stream);
+      }
+      lovrAudioUnlock();
+      return;
+    }
+
+    lovrSourceApply(source);
+    if (source->type == SOURCE_STATIC) {
+      alSourcei(source->id, AL_SAMPLE_OFFSET, (int) source->virtualOffset);
+    }
+  }
+
+  if (source->type == SOURCE_STREAM) {
+    lovrSourceStream(source, source->buffers, source->bufferCount);
+  }
+
   alSourcePlay(source->id);
+  lovrAudioUnlock();
 }
 
 void lovrSourceResume(Source* source) {
-  if (!lovrSourceIsPaused(source)) {
-    return;
+  lovrAudioLock();
+  if (lovrSourceIsPaused(source)) {
+    if (source->id) {
+      alSourcePlay(source->id);
+    } else {
+      source->isPaused = false;
+    }
   }
-
-  alSourcePlay(source->id);
+  lovrAudioUnlock();
 }
 
 void lovrSourceRewind(Source* source) {
+  lovrAudioLock();
   if (lovrSourceIsStopped(source)) {
+    lovrAudioUnlock();
     return;
   }
 
   bool wasPaused = lovrSourceIsPaused(source);
-  alSourceRewind(source->id);
   lovrSourceStop(source);
   lovrSourcePlay(source);
   if (wasPaused) {
     lovrSourcePause(source);
   }
+  lovrAudioUnlock();
 }
 
 void lovrSourceSeek(Source* source, int sample) {
+  lovrAudioLock();
+
+  if (source->type == SOURCE_STATIC) {
+    if (source->id) {
+      alSourcei(source->id, AL_SAMPLE_OFFSET, sample);
+    } else {
+      source->virtualOffset = sample;
+    }
+    lovrAudioUnlock();
+    return;
+  }
+
   bool wasPaused = lovrSourceIsPaused(source);
   lovrSourceStop(source);
   lovrAudioStreamSeek(source->stream, sample);
@@ -187,71 +319,138 @@ void lovrSourceSeek(Source* source, int sample) {
   if (wasPaused) {
     lovrSourcePause(source);
   }
+  lovrAudioUnlock();
 }
 
 void lovrSourceSetCone(Source* source, float innerAngle, float outerAngle, float outerGain) {
-  alSourcef(source->id, AL_CONE_INNER_ANGLE, innerAngle * 180.f / M_PI);
-  alSourcef(source->id, AL_CONE_OUTER_ANGLE, outerAngle * 180.f / M_PI);
-  alSourcef(source->id, AL_CONE_OUTER_GAIN, outerGain);
+  lovrAudioLock();
+  vec3_set(source->cone, innerAngle, outerAngle, outerGain);
+  if (source->id) {
+    alSourcef(source->id, AL_CONE_INNER_ANGLE, innerAngle * 180.f / M_PI);
+    alSourcef(source->id, AL_CONE_OUTER_ANGLE, outerAngle * 180.f / M_PI);
+    alSourcef(source->id, AL_CONE_OUTER_GAIN, outerGain);
+  }
+  lovrAudioUnlock();
 }
 
 void lovrSourceSetDirection(Source* source, float x, float y, float z) {
-  alSource3f(source->id, AL_DIRECTION, x, y, z);
+  lovrAudioLock();
+  vec3_set(source->direction, x, y, z);
+  if (source->id) {
+    alSource3f(source->id, AL_DIRECTION, x, y, z);
+  }
+  lovrAudioUnlock();
 }
 
 void lovrSourceSetFalloff(Source* source, float reference, float max, float rolloff) {
   lovrAssert(lovrSourceGetChannelCount(source) == 1, "Positional audio is only supported for mono sources");
-  alSourcef(source->id, AL_REFERENCE_DISTANCE, reference);
-  alSourcef(source->id, AL_MAX_DISTANCE, max);
-  alSourcef(source->id, AL_ROLLOFF_FACTOR, rolloff);
+  lovrAudioLock();
+  vec3_set(source->falloff, reference, max, rolloff);
+  if (source->id) {
+    alSourcef(source->id, AL_REFERENCE_DISTANCE, reference);
+    alSourcef(source->id, AL_MAX_DISTANCE, max);
+    alSourcef(source->id, AL_ROLLOFF_FACTOR, rolloff);
+  }
+  lovrAudioUnlock();
 }
 
 void lovrSourceSetLooping(Source* source, bool isLooping) {
+  lovrAudioLock();
   source->isLooping = isLooping;
+  if (source->id && source->type == SOURCE_STATIC) {
+    alSourcei(source->id, AL_LOOPING, isLooping ? AL_TRUE : AL_FALSE);
+  }
+  lovrAudioUnlock();
 }
 
 void lovrSourceSetPitch(Source* source, float pitch) {
-  alSourcef(source->id, AL_PITCH, pitch);
+  lovrAudioLock();
+  source->pitch = pitch;
+  if (source->id) {
+    alSourcef(source->id, AL_PITCH, pitch);
+  }
+  lovrAudioUnlock();
+}
+
+// Higher priority Sources keep their voices, lower ones become virtual when voices run out
+void lovrSourceSetPriority(Source* source, int priority) {
+  lovrAudioLock();
+  source->priority = priority;
+  lovrAudioUnlock();
 }
 
 void lovrSourceSetPosition(Source* source, float x, float y, float z) {
   lovrAssert(lovrSourceGetChannelCount(source) == 1, "Positional audio is only supported for mono sources");
-  alSource3f(source->id, AL_POSITION, x, y, z);
+  lovrAudioLock();
+  vec3_set(source->position, x, y, z);
+  if (source->id) {
+    alSource3f(source->id, AL_POSITION, x, y, z);
+  }
+  lovrAudioUnlock();
 }
 
 void lovrSourceSetRelative(Source* source, bool isRelative) {
-  alSourcei(source->id, AL_SOURCE_RELATIVE, isRelative ? AL_TRUE : AL_FALSE);
+  lovrAudioLock();
+  source->isRelative = isRelative;
+  if (source->id) {
+    alSourcei(source->id, AL_SOURCE_RELATIVE, isRelative ? AL_TRUE : AL_FALSE);
+  }
+  lovrAudioUnlock();
 }
 
 void lovrSourceSetVelocity(Source* source, float x, float y, float z) {
-  alSource3f(source->id, AL_VELOCITY, x, y, z);
+  lovrAudioLock();
+  vec3_set(source->velocity, x, y, z);
+  if (source->id) {
+    alSource3f(source->id, AL_VELOCITY, x, y, z);
+  }
+  lovrAudioUnlock();
 }
 
 void lovrSourceSetVolume(Source* source, float volume) {
-  alSourcef(source->id, AL_GAIN, volume);
+  lovrAudioLock();
+  source->volume = volume;
+  if (source->id) {
+    alSourcef(source->id, AL_GAIN, volume);
+  }
+  lovrAudioUnlock();
 }
 
 void lovrSourceSetVolumeLimits(Source* source, float min, float max) {
-  alSourcef(source->id, AL_MIN_GAIN, min);
-  alSourcef(source->id, AL_MAX_GAIN, max);
+  lovrAudioLock();
+  source->volumeLimits[0] = min;
+  source->volumeLimits[1] = max;
+  if (source->id) {
+    alSourcef(source->id, AL_MIN_GAIN, min);
+    alSourcef(source->id, AL_MAX_GAIN, max);
+  }
+  lovrAudioUnlock();
 }
 
+// Stopping also hands the voice back to the pool, so it is safe to call on stopped Sources
 void lovrSourceStop(Source* source) {
-  if (lovrSourceIsStopped(source)) {
-    return;
-  }
+  lovrAudioLock();
+
+  if (source->id) {
 
-  // Empty the buffers
-  int count = 0;
-  alGetSourcei(source->id, AL_BUFFERS_QUEUED, &count);
-  alSourceUnqueueBuffers(source->id, count, NULL);
+    // Stop the source and empty the buffers
+    alSourceStop(source->id);
+    alSourcei(source->id, AL_BUFFER, AL_NONE);
 
-  // Stop the source
-  alSourceStop(source->id);
-  alSourcei(source->id, AL_BUFFER, AL_NONE);
+    lovrAudioReleaseVoice(source->id);
+    source->id = 0;
+  }
+
+  source->isVirtual = false;
+  source->isPaused = false;
+  source->virtualOffset = 0;
 
   // Rewind the decoder
-  lovrAudioStreamRewind(source->stream);
+  if (source->type == SOURCE_STREAM) {
+    lovrAudioStreamRewind(source->stream);
+  }
+
+  lovrAudioUnlock();
 }
 
 // Fills buffers with data and queues them, called once initially and over time to stream more data
@@ -277,17 +476,78 @@ void lovrSourceStream(Source* source, ALuint* buffers, int count) {
 }
 
 int lovrSourceTell(Source* source) {
-  int decoderOffset = lovrAudioStreamTell(source->stream);
-  int samplesPerBuffer = source->stream->bufferSize / source->stream->channelCount / sizeof(ALshort);
-  int queuedBuffers, sampleOffset;
-  alGetSourcei(source->id, AL_BUFFERS_QUEUED, &queuedBuffers);
-  alGetSourcei(source->id, AL_SAMPLE_OFFSET, &sampleOffset);
+  lovrAudioLock();
+
+  int offset;
+  if (source->isVirtual || (!source->id && source->type == SOURCE_STATIC)) {
+    offset = (int) source->virtualOffset;
+  } else if (!source->id) {
+    offset = lovrAudioStreamTell(source->stream);
+  } else if (source->type == SOURCE_STATIC) {
+    alGetSourcei(source->id, AL_SAMPLE_OFFSET, &offset);
+  } else {
+    int decoderOffset = lovrAudioStreamTell(source->stream);
+    int samplesPerBuffer = source->stream->bufferSize / source->stream->channelCount / sizeof(ALshort);
+    int queuedBuffers, sampleOffset;
+    alGetSourcei(source->id, AL_BUFFERS_QUEUED, &queuedBuffers);
+    alGetSourcei(source->id, AL_SAMPLE_OFFSET, &sampleOffset);
+
+    offset = decoderOffset - queuedBuffers * samplesPerBuffer + sampleOffset;
 
-  int offset = decoderOffset - queuedBuffers * samplesPerBuffer + sampleOffset;
+    if (offset < 0) {
+      offset += source->stream->samples;
+    }
+  }
+
+  lovrAudioUnlock();
+  return offset;
+}
+
+// Gives up the voice but remembers the playback position so the Source can resume seamlessly
+ALuint lovrSourceVirtualize(Source* source) {
+  ALuint voice = source->id;
+  source->virtualOffset = lovrSourceTell(source);
+  source->isPaused = lovrSourceIsPaused(source);
+  alSourceStop(voice);
+  alSourcei(voice, AL_BUFFER, AL_NONE);
+  source->id = 0;
+  source->isVirtual = true;
+  return voice;
+}
 
-  if (offset < 0) {
-    return offset + source->stream->samples;
+void lovrSourceRestore(Source* source, ALuint voice) {
+  source->id = voice;
+  source->isVirtual = false;
+  lovrSourceApply(source);
+
+  if (source->type == SOURCE_STATIC) {
+    alSourcei(voice, AL_SAMPLE_OFFSET, (int) source->virtualOffset);
   } else {
-    return offset;
+    lovrAudioStreamSeek(source->stream, (int) source->virtualOffset);
+    lovrSourceStream(source, source->buffers, source->bufferCount);
+  }
+
+  alSourcePlay(voice);
+  if (source->isPaused) {
+    alSourcePause(voice);
+    source->isPaused = false;
+  }
+}
+
+// Virtual Sources keep time without a voice so they are in the right place when they become audible
+void lovrSourceAdvance(Source* source, float dt) {
+  if (!source->isVirtual || source->isPaused) {
+    return;
+  }
+
+  int duration = lovrSourceGetDuration(source);
+  source->virtualOffset += dt * lovrSourceGetSampleRate(source) * source->pitch;
+
+  if (source->virtualOffset >= duration) {
+    if (source->isLooping && duration > 0) {
+      source->virtualOffset = fmodf(source->virtualOffset, duration);
+    } else {
+      lovrSourceStop(source);
+    }
   }
 }
@@ -1,4 +1,5 @@
 #include "data/audioStream.h"
+#include "data/soundData.h"
 #include "util.h"
 #include <AL/al.h>
 #include <AL/alc.h>
@@ -6,30 +7,58 @@
 
 #pragma once
 
-#define SOURCE_BUFFERS 4
+#define MAX_SOURCE_BUFFERS 16
 
 typedef enum {
   UNIT_SECONDS,
   UNIT_SAMPLES
 } TimeUnit;
 
+typedef enum {
+  SOURCE_STATIC,
+  SOURCE_STREAM
+} SourceType;
+
 typedef struct {
   Ref ref;
+  SourceType type;
+  SoundData* soundData;
   AudioStream* stream;
   ALuint id;
-  ALuint buffers[SOURCE_BUFFERS];
+  ALuint buffer;
+  ALuint buffers[MAX_SOURCE_BUFFERS];
+  int bufferCount;
+  int priority;
+  bool isActive;
+  bool isRetired;
+  bool isVirtual;
+  bool isPaused;
+  float virtualOffset;
   bool isLooping;
+  bool isRelative;
+  float position[3];
+  float velocity[3];
+  float direction[3];
+  float cone[3];
+  float falloff[3];
+  float volumeLimits[2];
+  float pitch;
+  float volume;
 } Source;
 
-Source* lovrSourceCreate(AudioStream* stream);
+Source* lovrSourceCreate(AudioStream* stream, int bufferCount);
+Source* lovrSourceCreateStatic(SoundData* soundData);
 void lovrSourceDestroy(void* ref);
 int lovrSourceGetBitDepth(Source* source);
+int lovrSourceGetBufferCount(Source* source);
 int lovrSourceGetChannelCount(Source* source);
 void lovrSourceGetCone(Source* source, float* innerAngle, float* outerAngle, float* outerGain);
 void lovrSourceGetDirection(Source* source, float* x, float* y, float* z);
 int lovrSourceGetDuration(Source* source);
 void lovrSourceGetFalloff(Source* source, float* reference, float* max, float* rolloff);
 float lovrSourceGetPitch(Source* source);
+int lovrSourceGetPriority(Source* source);
+SourceType lovrSourceGetType(Source* source);
 void lovrSourceGetPosition(Source* source, float* x, float* y, float* z);
 void lovrSourceGetVelocity(Source* source, float* x, float* y, float* z);
 int lovrSourceGetSampleRate(Source* source);
@@ -40,6 +69,7 @@ bool lovrSourceIsPaused(Source* source);
 bool lovrSourceIsPlaying(Source* source);
 bool lovrSourceIsRelative(Source* source);
 bool lovrSourceIsStopped(Source* source);
+bool lovrSourceIsVirtual(Source* source);
 void lovrSourcePause(Source* source);
 void lovrSourcePlay(Source* source);
 void lovrSourceResume(Source* source);
@@ -50,6 +80,7 @@ void lovrSourceSetDirection(Source* source, float x, float y, float z);
 void lovrSourceSetFalloff(Source* source, float reference, float max, float rolloff);
 void lovrSourceSetLooping(Source* source, bool isLooping);
 void lovrSourceSetPitch(Source* source, float pitch);
+void lovrSourceSetPriority(Source* source, int priority);
 void lovrSourceSetPosition(Source* source, float x, float y, float z);
 void lovrSourceSetRelative(Source* source, bool isRelative);
 void lovrSourceSetVelocity(Source* source, float x, float y, float z);
@@ -58,3 +89,6 @@ void lovrSourceSetVolumeLimits(Source* source, float min, float max);
 void lovrSourceStop(Source* source);
 void lovrSourceStream(Source* source, ALuint* buffers, int count);
 int lovrSourceTell(Source* source);
+ALuint lovrSourceVirtualize(Source* source);
+void lovrSourceRestore(Source* source, ALuint voice);
+void lovrSourceAdvance(Source* source, float dt);
@@ -1,19 +1,47 @@
 #include "data/blob.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#elif !defined(EMSCRIPTEN)
+#include <sys/mman.h>
+#endif
 
+// The name is copied, since blobs often outlive the path or string they were created from
 Blob* lovrBlobCreate(void* data, size_t size, const char* name) {
   Blob* blob = lovrAlloc(sizeof(Blob), lovrBlobDestroy);
   if (!blob) return NULL;
 
   blob->data = data;
   blob->size = size;
-  blob->name = name;
+  blob->name = strdup(name);
   blob->seek = 0;
+  blob->isMapped = false;
+
+  return blob;
+}
+
+// Takes ownership of a memory mapped view of a file, which is unmapped instead of freed
+Blob* lovrBlobCreateMapped(void* data, size_t size, const char* name) {
+  Blob* blob = lovrBlobCreate(data, size, name);
+  if (!blob) return NULL;
+
+  blob->isMapped = true;
 
   return blob;
 }
 
 void lovrBlobDestroy(void* ref) {
   Blob* blob = ref;
-  free(blob->data);
+  if (blob->isMapped) {
+#ifdef _WIN32
+    UnmapViewOfFile(blob->data);
+#elif !defined(EMSCRIPTEN)
+    munmap(blob->data, blob->size);
+#endif
+  } else {
+    free(blob->data);
+  }
+  free(blob->name);
   free(blob);
 }
@@ -1,4 +1,5 @@
 #include "util.h"
+#include <stdbool.h>
 
 #pragma once
 
@@ -6,9 +7,11 @@ typedef struct {
   Ref ref;
   void* data;
   size_t size;
-  const char* name;
+  char* name;
   size_t seek;
+  bool isMapped;
 } Blob;
 
 Blob* lovrBlobCreate(void* data, size_t size, const char* name);
+Blob* lovrBlobCreateMapped(void* data, size_t size, const char* name);
 void lovrBlobDestroy(void* ref);
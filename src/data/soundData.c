@@ -0,0 +1,40 @@
+#include "data/soundData.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Decodes an entire AudioStream up front, leaving the stream rewound
+SoundData* lovrSoundDataCreate(AudioStream* stream) {
+  SoundData* soundData = lovrAlloc(sizeof(SoundData), lovrSoundDataDestroy);
+  if (!soundData) return NULL;
+
+  soundData->bitDepth = stream->bitDepth;
+  soundData->channelCount = stream->channelCount;
+  soundData->sampleRate = stream->sampleRate;
+  soundData->samples = stream->samples;
+  soundData->size = stream->samples * stream->channelCount * sizeof(short);
+  soundData->data = malloc(soundData->size);
+
+  size_t offset = 0;
+  int samples;
+  lovrAudioStreamRewind(stream);
+  while (offset < soundData->size && (samples = lovrAudioStreamDecode(stream)) != 0) {
+    size_t bytes = samples * sizeof(short);
+    if (offset + bytes > soundData->size) {
+      bytes = soundData->size - offset;
+    }
+
+    memcpy((char*) soundData->data + offset, stream->buffer, bytes);
+    offset += bytes;
+  }
+
+  soundData->size = offset;
+  lovrAudioStreamRewind(stream);
+
+  return soundData;
+}
+
+void lovrSoundDataDestroy(void* ref) {
+  SoundData* soundData = ref;
+  free(soundData->data);
+  free(soundData);
+}
@@ -0,0 +1,17 @@
+#include "data/audioStream.h"
+#include "util.h"
+
+#pragma once
+
+typedef struct {
+  Ref ref;
+  int bitDepth;
+  int channelCount;
+  int sampleRate;
+  int samples;
+  void* data;
+  size_t size;
+} SoundData;
+
+SoundData* lovrSoundDataCreate(AudioStream* stream);
+void lovrSoundDataDestroy(void* ref);
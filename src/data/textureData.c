@@ -224,6 +224,7 @@ bool lovrTextureDataEncode(TextureData* textureData, const char* filename) {
   size_t stride = -textureData->width * components;
   bool success = stbi_write_png_to_func(writeCallback, file, width, height, components, data, stride);
   lovrFileClose(file);
+  lovrRelease(file);
   return success;
 }
 
@@ -1,27 +1,45 @@
 #include "event/event.h"
-#include "lib/glfw.h"
+#include "math/math.h"
+#include "timer/profiler.h"
 #include <stdlib.h>
+#include <string.h>
 
 static EventState state;
 
 void lovrEventInit() {
   if (state.initialized) return;
   vec_init(&state.pumps);
-  vec_init(&state.events);
-  lovrEventAddPump(glfwPollEvents);
+  state.thread = thrd_current();
+  mtx_init(&state.lock, mtx_plain);
+  cnd_init(&state.cond);
+  state.capacity = EVENT_QUEUE_SIZE;
+  state.events = malloc(state.capacity * sizeof(Event));
+  lovrAssert(state.events, "Out of memory");
+  state.head = 0;
+  state.count = 0;
+  state.overflow = OVERFLOW_GROW;
+  state.dropped = 0;
   atexit(lovrEventDestroy);
   state.initialized = true;
 }
 
 void lovrEventDestroy() {
   if (!state.initialized) return;
+  lovrEventClear();
   vec_deinit(&state.pumps);
-  vec_deinit(&state.events);
+  mtx_destroy(&state.lock);
+  cnd_destroy(&state.cond);
+  free(state.events);
   memset(&state, 0, sizeof(EventState));
 }
 
+// Pumps are registered by whatever produces the events, adding one that's already there does nothing
 void lovrEventAddPump(EventPump pump) {
-  vec_push(&state.pumps, pump);
+  int index;
+  vec_find(&state.pumps, pump, index);
+  if (index == -1) {
+    vec_push(&state.pumps, pump);
+  }
 }
 
 void lovrEventRemovePump(EventPump pump) {
@@ -29,25 +47,162 @@ void lovrEventRemovePump(EventPump pump) {
 }
 
 void lovrEventPump() {
+  lovrProfilerPush("event");
   int i; EventPump pump;
   vec_foreach(&state.pumps, pump, i) {
     pump();
   }
+  lovrProfilerPop();
+}
+
+// Doubles the capacity of the queue, unwrapping the events so they start at the beginning
+static void lovrEventGrow() {
+  int capacity = state.capacity * 2;
+  Event* events = malloc(capacity * sizeof(Event));
+  lovrAssert(events, "Out of memory");
+  int tail = MIN(state.count, state.capacity - state.head);
+  memcpy(events, state.events + state.head, tail * sizeof(Event));
+  memcpy(events + tail, state.events, (state.count - tail) * sizeof(Event));
+  free(state.events);
+  state.events = events;
+  state.capacity = capacity;
+  state.head = 0;
 }
 
 void lovrEventPush(Event event) {
-  vec_insert(&state.events, 0, event);
+  if (!state.initialized) {
+    lovrEventDestroyData(&event);
+    return;
+  }
+
+  mtx_lock(&state.lock);
+
+  if (state.count == state.capacity) {
+    bool mainThread = thrd_equal(thrd_current(), state.thread);
+    switch (state.overflow) {
+      case OVERFLOW_BLOCK:
+        if (!mainThread) {
+          while (state.count == state.capacity && state.overflow == OVERFLOW_BLOCK) {
+            cnd_wait(&state.cond, &state.lock);
+          }
+        }
+        break;
+
+      case OVERFLOW_DROP:
+        lovrEventDestroyData(&state.events[state.head]);
+        state.head = (state.head + 1) % state.capacity;
+        state.count--;
+        state.dropped++;
+        break;
+
+      default:
+        break;
+    }
+
+    // Still full, either because the overflow mode is grow or because blocking isn't possible
+    if (state.count == state.capacity) {
+      lovrEventGrow();
+    }
+  }
+
+  state.events[(state.head + state.count) % state.capacity] = event;
+  state.count++;
+  mtx_unlock(&state.lock);
 }
 
 bool lovrEventPoll(Event* event) {
-  if (state.events.length == 0) {
-    return false;
+  return lovrEventPollBatch(event, 1) == 1;
+}
+
+// Removes up to count events from the queue with a single lock, returning the number removed
+int lovrEventPollBatch(Event* events, int count) {
+  if (!state.initialized) return 0;
+  mtx_lock(&state.lock);
+  int n = MIN(count, state.count);
+
+  for (int i = 0; i < n; i++) {
+    events[i] = state.events[state.head];
+    state.head = (state.head + 1) % state.capacity;
+  }
+
+  state.count -= n;
+  if (n > 0) {
+    cnd_broadcast(&state.cond);
   }
 
-  *event = vec_pop(&state.events);
-  return true;
+  mtx_unlock(&state.lock);
+  return n;
 }
 
 void lovrEventClear() {
-  vec_clear(&state.events);
+  if (!state.initialized) return;
+  mtx_lock(&state.lock);
+  for (int i = 0; i < state.count; i++) {
+    lovrEventDestroyData(&state.events[(state.head + i) % state.capacity]);
+  }
+  state.head = 0;
+  state.count = 0;
+  cnd_broadcast(&state.cond);
+  mtx_unlock(&state.lock);
+}
+
+// Releases anything owned by an event that will never be delivered
+void lovrEventDestroyData(Event* event) {
+  switch (event->type) {
+    case EVENT_THREAD_ERROR:
+      lovrRelease(event->data.threaderror.thread);
+      free(event->data.threaderror.error);
+      break;
+
+    case EVENT_FILE_READ:
+      lovrRelease(event->data.fileread.request);
+      break;
+
+    case EVENT_CONTROLLER_ADDED:
+      lovrRelease(event->data.controlleradded.controller);
+      break;
+
+    case EVENT_CONTROLLER_REMOVED:
+      lovrRelease(event->data.controllerremoved.controller);
+      break;
+
+    case EVENT_CUSTOM:
+      for (int i = 0; i < event->data.custom.count; i++) {
+        Variant* variant = &event->data.custom.data[i];
+        if (variant->type == TYPE_STRING) {
+          free(variant->value.string);
+        } else if (variant->type == TYPE_OBJECT) {
+          lovrRelease(variant->value.ref);
+        }
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+EventOverflow lovrEventGetOverflow() {
+  return state.overflow;
+}
+
+void lovrEventSetOverflow(EventOverflow overflow) {
+  mtx_lock(&state.lock);
+  state.overflow = overflow;
+  cnd_broadcast(&state.cond);
+  mtx_unlock(&state.lock);
+}
+
+int lovrEventGetCount() {
+  mtx_lock(&state.lock);
+  int count = state.count;
+  mtx_unlock(&state.lock);
+  return count;
+}
+
+uint64_t lovrEventGetDropped() {
+  mtx_lock(&state.lock);
+  uint64_t dropped = state.dropped;
+  mtx_unlock(&state.lock);
+  return dropped;
 }
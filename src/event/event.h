@@ -1,21 +1,35 @@
+#include "filesystem/reader.h"
 #include "headset/headset.h"
 #include "thread/thread.h"
+#include "lib/tinycthread/tinycthread.h"
 #include "lib/vec/vec.h"
 #include <stdbool.h>
 
 #pragma once
 
+#define EVENT_QUEUE_SIZE 256
+#define MAX_EVENT_NAME_LENGTH 32
+#define MAX_EVENT_ARGUMENTS 4
+
 typedef enum {
   EVENT_QUIT,
   EVENT_FOCUS,
   EVENT_MOUNT,
   EVENT_THREAD_ERROR,
+  EVENT_FILE_READ,
   EVENT_CONTROLLER_ADDED,
   EVENT_CONTROLLER_REMOVED,
   EVENT_CONTROLLER_PRESSED,
-  EVENT_CONTROLLER_RELEASED
+  EVENT_CONTROLLER_RELEASED,
+  EVENT_CUSTOM
 } EventType;
 
+typedef enum {
+  OVERFLOW_GROW,
+  OVERFLOW_DROP,
+  OVERFLOW_BLOCK
+} EventOverflow;
+
 typedef struct {
   bool restart;
   int exitCode;
@@ -31,9 +45,13 @@ typedef struct {
 
 typedef struct {
   Thread* thread;
-  const char* error;
+  char* error;
 } ThreadErrorEvent;
 
+typedef struct {
+  ReadRequest* request;
+} FileReadEvent;
+
 typedef struct {
   Controller* controller;
 } ControllerAddedEvent;
@@ -52,15 +70,23 @@ typedef struct {
   ControllerButton button;
 } ControllerReleasedEvent;
 
+typedef struct {
+  char name[MAX_EVENT_NAME_LENGTH];
+  Variant data[MAX_EVENT_ARGUMENTS];
+  int count;
+} CustomEvent;
+
 typedef union {
   QuitEvent quit;
   FocusEvent focus;
   MountEvent mount;
   ThreadErrorEvent threaderror;
+  FileReadEvent fileread;
   ControllerAddedEvent controlleradded;
   ControllerRemovedEvent controllerremoved;
   ControllerPressedEvent controllerpressed;
   ControllerReleasedEvent controllerreleased;
+  CustomEvent custom;
 } EventData;
 
 typedef struct {
@@ -71,12 +97,22 @@ typedef struct {
 typedef void (*EventPump)(void);
 
 typedef vec_t(EventPump) vec_pump_t;
-typedef vec_t(Event) vec_event_t;
 
+// The queue is a ring buffer that any thread can push to, while only the main thread polls it.
+// What happens when it fills up is controlled by the overflow mode.  Blocking only applies to
+// other threads, pushes from the main thread grow the queue instead since nothing would drain it.
 typedef struct {
   bool initialized;
   vec_pump_t pumps;
-  vec_event_t events;
+  thrd_t thread;
+  mtx_t lock;
+  cnd_t cond;
+  Event* events;
+  int capacity;
+  int head;
+  int count;
+  EventOverflow overflow;
+  uint64_t dropped;
 } EventState;
 
 void lovrEventInit();
@@ -86,4 +122,10 @@ void lovrEventRemovePump(EventPump pump);
 void lovrEventPump();
 void lovrEventPush(Event event);
 bool lovrEventPoll(Event* event);
+int lovrEventPollBatch(Event* events, int count);
 void lovrEventClear();
+void lovrEventDestroyData(Event* event);
+EventOverflow lovrEventGetOverflow();
+void lovrEventSetOverflow(EventOverflow overflow);
+int lovrEventGetCount();
+uint64_t lovrEventGetDropped();
@@ -1,11 +1,14 @@
 #include "filesystem/file.h"
+#include "filesystem/filesystem.h"
 #include <physfs.h>
+#include <stdlib.h>
+#include <string.h>
 
 File* lovrFileCreate(const char* path) {
   File* file = lovrAlloc(sizeof(File), lovrFileDestroy);
   if (!file) return NULL;
 
-  file->path = path;
+  file->path = strdup(path);
   file->handle = NULL;
 
   return file;
@@ -14,8 +17,9 @@ File* lovrFileCreate(const char* path) {
 void lovrFileDestroy(void* ref) {
   File* file = ref;
   if (file->handle) {
-    PHYSFS_close(file->handle);
+    lovrFileClose(file);
   }
+  free(file->path);
   free(file);
 }
 
@@ -36,6 +40,10 @@ void lovrFileClose(File* file) {
   lovrAssert(file->handle, "File must be open to close it");
   PHYSFS_close(file->handle);
   file->handle = NULL;
+
+  if (file->mode != OPEN_READ) {
+    lovrFilesystemUpdateIndex(file->path);
+  }
 }
 
 size_t lovrFileRead(File* file, void* data, size_t bytes) {
@@ -44,7 +52,7 @@ size_t lovrFileRead(File* file, void* data, size_t bytes) {
 }
 
 size_t lovrFileWrite(File* file, void* data, size_t bytes) {
-  lovrAssert(file->handle && (file->mode == OPEN_READ || file->mode == OPEN_WRITE), "File must be open for writing");
+  lovrAssert(file->handle && (file->mode == OPEN_WRITE || file->mode == OPEN_APPEND), "File must be open for writing");
   return PHYSFS_writeBytes(file->handle, data, bytes);
 }
 
@@ -62,3 +70,24 @@ size_t lovrFileTell(File* file) {
   lovrAssert(file->handle, "File must be open to tell");
   return PHYSFS_tell(file->handle);
 }
+
+int lovrFileFlush(File* file) {
+  lovrAssert(file->handle && file->mode != OPEN_READ, "File must be open for writing to flush it");
+  if (!PHYSFS_flush(file->handle)) {
+    return 1;
+  }
+
+  lovrFilesystemUpdateIndex(file->path);
+  return 0;
+}
+
+// PhysFS buffers reads and writes internally, which turns many small writes into few large ones
+int lovrFileSetBuffer(File* file, size_t size) {
+  lovrAssert(file->handle, "File must be open to set its buffer size");
+  return !PHYSFS_setBuffer(file->handle, size);
+}
+
+bool lovrFileIsEOF(File* file) {
+  lovrAssert(file->handle, "File must be open to check for end of file");
+  return PHYSFS_eof(file->handle);
+}
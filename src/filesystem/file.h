@@ -1,4 +1,5 @@
 #include "util.h"
+#include <stdbool.h>
 
 #pragma once
 
@@ -10,7 +11,7 @@ typedef enum {
 
 typedef struct {
   Ref ref;
-  const char* path;
+  char* path;
   void* handle;
   FileMode mode;
 } File;
@@ -24,3 +25,6 @@ size_t lovrFileWrite(File* file, void* data, size_t bytes);
 size_t lovrFileGetSize(File* file);
 int lovrFileSeek(File* file, size_t position);
 size_t lovrFileTell(File* file);
+int lovrFileFlush(File* file);
+int lovrFileSetBuffer(File* file, size_t size);
+bool lovrFileIsEOF(File* file);
@@ -1,5 +1,6 @@
 #include "filesystem/filesystem.h"
 #include "filesystem/file.h"
+#include "filesystem/reader.h"
 #include "util.h"
 #include <physfs.h>
 #include <stdio.h>
@@ -16,10 +17,159 @@
 #else
 #include <unistd.h>
 #include <pwd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifndef EMSCRIPTEN
+#include <sys/mman.h>
+#endif
 #endif
 
 static FilesystemState state;
 
+// Metadata index
+
+static const char* lovrFilesystemNormalizePath(const char* path, char* dest) {
+  while (*path == '/') path++;
+  strncpy(dest, path, LOVR_PATH_MAX - 1);
+  dest[LOVR_PATH_MAX - 1] = '\0';
+  size_t length = strlen(dest);
+  while (length > 0 && dest[length - 1] == '/') {
+    dest[--length] = '\0';
+  }
+  return dest;
+}
+
+static void lovrFilesystemIndexClear() {
+  const char* key;
+  map_iter_t iter = map_iter(&state.index);
+  while ((key = map_next(&state.index, &iter)) != NULL) {
+    FileInfo* info = map_get(&state.index, key);
+    int i; char* child;
+    vec_foreach(&info->children, child, i) {
+      free(child);
+    }
+    vec_deinit(&info->children);
+  }
+
+  map_deinit(&state.index);
+  map_init(&state.index);
+}
+
+static FileInfo* lovrFilesystemIndexAdd(const char* path, PHYSFS_Stat* stat) {
+  FileInfo info = {
+    .isFile = stat->filetype == PHYSFS_FILETYPE_REGULAR,
+    .isDirectory = stat->filetype == PHYSFS_FILETYPE_DIRECTORY,
+    .size = stat->filesize,
+    .modtime = stat->modtime
+  };
+
+  FileInfo* existing = map_get(&state.index, path);
+  if (existing) {
+    info.children = existing->children;
+    *existing = info;
+    return existing;
+  }
+
+  vec_init(&info.children);
+  map_set(&state.index, path, info);
+
+  // Link the entry into its parent directory
+  if (*path) {
+    char parent[LOVR_PATH_MAX];
+    strncpy(parent, path, LOVR_PATH_MAX);
+    char* slash = strrchr(parent, '/');
+    const char* name = slash ? slash + 1 : path;
+    if (slash) *slash = '\0'; else parent[0] = '\0';
+    FileInfo* parentInfo = map_get(&state.index, parent);
+    if (parentInfo) {
+      vec_push(&parentInfo->children, strdup(name));
+    }
+  }
+
+  return map_get(&state.index, path);
+}
+
+static void lovrFilesystemIndexRemove(const char* path) {
+  FileInfo* info = map_get(&state.index, path);
+  if (!info) return;
+
+  int i; char* child;
+  vec_foreach(&info->children, child, i) {
+    free(child);
+  }
+  vec_deinit(&info->children);
+  map_remove(&state.index, path);
+
+  char parent[LOVR_PATH_MAX];
+  strncpy(parent, path, LOVR_PATH_MAX);
+  char* slash = strrchr(parent, '/');
+  const char* name = slash ? path + (slash - parent) + 1 : path;
+  if (slash) *slash = '\0'; else parent[0] = '\0';
+  FileInfo* parentInfo = map_get(&state.index, parent);
+  if (parentInfo) {
+    vec_foreach(&parentInfo->children, child, i) {
+      if (!strcmp(child, name)) {
+        free(child);
+        vec_splice(&parentInfo->children, i, 1);
+        break;
+      }
+    }
+  }
+}
+
+static int lovrFilesystemIndexDirectory(void* userdata, const char* dir, const char* file) {
+  char path[LOVR_PATH_MAX];
+  snprintf(path, LOVR_PATH_MAX, *dir ? "%s/%s" : "%s%s", dir, file);
+
+  PHYSFS_Stat stat;
+  if (PHYSFS_stat(path, &stat)) {
+    FileInfo* info = lovrFilesystemIndexAdd(path, &stat);
+    if (info->isDirectory) {
+      PHYSFS_enumerate(path, lovrFilesystemIndexDirectory, NULL);
+    }
+  }
+
+  return 1;
+}
+
+// The index is rebuilt lazily after the search path changes, so mounting several archives in a row
+// only walks them once
+static FileInfo* lovrFilesystemGetInfo(const char* path) {
+  if (state.indexDirty) {
+    lovrFilesystemIndexClear();
+    PHYSFS_Stat stat;
+    if (PHYSFS_stat("", &stat)) {
+      lovrFilesystemIndexAdd("", &stat);
+      PHYSFS_enumerate("", lovrFilesystemIndexDirectory, NULL);
+    }
+    state.indexDirty = false;
+  }
+
+  char normalized[LOVR_PATH_MAX];
+  return map_get(&state.index, lovrFilesystemNormalizePath(path, normalized));
+}
+
+// Writes and deletes only touch a single path, so they patch the index instead of invalidating it
+void lovrFilesystemUpdateIndex(const char* path) {
+  if (!state.indexEnabled || state.indexDirty) {
+    return;
+  }
+
+  char normalized[LOVR_PATH_MAX];
+  lovrFilesystemNormalizePath(path, normalized);
+
+  mtx_lock(&state.indexLock);
+  PHYSFS_Stat stat;
+  if (PHYSFS_stat(normalized, &stat)) {
+    lovrFilesystemIndexAdd(normalized, &stat);
+  } else {
+    lovrFilesystemIndexRemove(normalized);
+  }
+  mtx_unlock(&state.indexLock);
+}
+
+//
+
 void lovrFilesystemInit(const char* arg0, const char* arg1) {
   if (state.initialized) return;
   state.initialized = true;
@@ -31,6 +181,11 @@ void lovrFilesystemInit(const char* arg0, const char* arg1) {
   state.source = malloc(LOVR_PATH_MAX * sizeof(char));
   state.identity = NULL;
   state.isFused = true;
+  state.indexEnabled = true;
+  state.indexDirty = true;
+  map_init(&state.index);
+  mtx_init(&state.indexLock, mtx_plain | mtx_recursive);
+  mtx_init(&state.mountLock, mtx_plain);
 
   // Try to mount either an archive fused to the executable or an archive from the command line
   lovrFilesystemGetExecutablePath(state.source, LOVR_PATH_MAX);
@@ -51,6 +206,11 @@ void lovrFilesystemInit(const char* arg0, const char* arg1) {
 
 void lovrFilesystemDestroy() {
   if (!state.initialized) return;
+  lovrReaderDestroy();
+  lovrFilesystemIndexClear();
+  map_deinit(&state.index);
+  mtx_destroy(&state.indexLock);
+  mtx_destroy(&state.mountLock);
   free(state.source);
   free(state.savePathFull);
   free(state.savePathRelative);
@@ -59,7 +219,23 @@ void lovrFilesystemDestroy() {
 }
 
 int lovrFilesystemCreateDirectory(const char* path) {
-  return !PHYSFS_mkdir(path);
+  if (!PHYSFS_mkdir(path)) {
+    return 1;
+  }
+
+  // PHYSFS_mkdir creates intermediate directories too
+  char partial[LOVR_PATH_MAX];
+  lovrFilesystemNormalizePath(path, partial);
+  for (char* c = partial; *c; c++) {
+    if (*c == '/') {
+      *c = '\0';
+      lovrFilesystemUpdateIndex(partial);
+      *c = '/';
+    }
+  }
+  lovrFilesystemUpdateIndex(partial);
+
+  return 0;
 }
 
 int lovrFilesystemGetAppdataDirectory(char* dest, unsigned int size) {
@@ -95,6 +271,21 @@ int lovrFilesystemGetAppdataDirectory(char* dest, unsigned int size) {
 }
 
 void lovrFilesystemGetDirectoryItems(const char* path, getDirectoryItemsCallback callback, void* userdata) {
+  if (state.indexEnabled) {
+    mtx_lock(&state.indexLock);
+    FileInfo* info = lovrFilesystemGetInfo(path);
+    if (info && info->isDirectory) {
+      int i; char* child;
+      vec_foreach(&info->children, child, i) {
+        if (!callback(userdata, path, child)) {
+          break;
+        }
+      }
+    }
+    mtx_unlock(&state.indexLock);
+    return;
+  }
+
   PHYSFS_enumerate(path, callback, userdata);
 }
 
@@ -124,6 +315,14 @@ const char* lovrFilesystemGetIdentity() {
 }
 
 long lovrFilesystemGetLastModified(const char* path) {
+  if (state.indexEnabled) {
+    mtx_lock(&state.indexLock);
+    FileInfo* info = lovrFilesystemGetInfo(path);
+    long modtime = info ? info->modtime : -1;
+    mtx_unlock(&state.indexLock);
+    return modtime;
+  }
+
   PHYSFS_Stat stat;
   return PHYSFS_stat(path, &stat) ? stat.modtime : -1;
 }
@@ -137,6 +336,14 @@ const char* lovrFilesystemGetSaveDirectory() {
 }
 
 size_t lovrFilesystemGetSize(const char* path) {
+  if (state.indexEnabled) {
+    mtx_lock(&state.indexLock);
+    FileInfo* info = lovrFilesystemGetInfo(path);
+    size_t size = info ? info->size : (size_t) -1;
+    mtx_unlock(&state.indexLock);
+    return size;
+  }
+
   PHYSFS_Stat stat;
   return PHYSFS_stat(path, &stat) ? stat.filesize : -1;
 }
@@ -162,11 +369,27 @@ const char* lovrFilesystemGetUserDirectory() {
 }
 
 bool lovrFilesystemIsDirectory(const char* path) {
+  if (state.indexEnabled) {
+    mtx_lock(&state.indexLock);
+    FileInfo* info = lovrFilesystemGetInfo(path);
+    bool isDirectory = info && info->isDirectory;
+    mtx_unlock(&state.indexLock);
+    return isDirectory;
+  }
+
   PHYSFS_Stat stat;
   return PHYSFS_stat(path, &stat) ? stat.filetype == PHYSFS_FILETYPE_DIRECTORY : false;
 }
 
 bool lovrFilesystemIsFile(const char* path) {
+  if (state.indexEnabled) {
+    mtx_lock(&state.indexLock);
+    FileInfo* info = lovrFilesystemGetInfo(path);
+    bool isFile = info && info->isFile;
+    mtx_unlock(&state.indexLock);
+    return isFile;
+  }
+
   PHYSFS_Stat stat;
   return PHYSFS_stat(path, &stat) ? stat.filetype == PHYSFS_FILETYPE_REGULAR : false;
 }
@@ -175,8 +398,129 @@ bool lovrFilesystemIsFused() {
   return state.isFused;
 }
 
+bool lovrFilesystemIsIndexEnabled() {
+  return state.indexEnabled;
+}
+
+// Files in native directories are mapped instead of copied, so large assets are paged in lazily
+Blob* lovrFilesystemLoadBlob(const char* path) {
+  size_t size;
+  void* data;
+
+  if ((data = lovrFilesystemMap(path, &size)) != NULL) {
+    return lovrBlobCreateMapped(data, size, path);
+  } else if ((data = lovrFilesystemRead(path, &size)) != NULL) {
+    return lovrBlobCreate(data, size, path);
+  }
+
+  return NULL;
+}
+
+// Maps a file in a native directory mount directly into memory, so it's paged in lazily and shared
+// with other processes.  Returns NULL for files inside archives or when mapping fails, in which case
+// the caller should fall back to lovrFilesystemRead.  The view is copy-on-write.
+void* lovrFilesystemMap(const char* path, size_t* size) {
+#ifdef EMSCRIPTEN
+  return NULL;
+#else
+  // Reader threads call this too, so the strings PhysFS owns are copied before another thread can
+  // mount or unmount something and free them
+  char realDir[LOVR_PATH_MAX];
+  char mountpoint[LOVR_PATH_MAX];
+  mtx_lock(&state.mountLock);
+  const char* dir = PHYSFS_getRealDir(path);
+  const char* writeDir = PHYSFS_getWriteDir();
+
+  // Files in the save directory can be truncated by lovr.filesystem.write while mapped, which would
+  // crash on access, so they are always read instead
+  if (!dir || (writeDir && !strcmp(dir, writeDir))) {
+    mtx_unlock(&state.mountLock);
+    return NULL;
+  }
+
+  const char* point = PHYSFS_getMountPoint(dir);
+  strncpy(realDir, dir, LOVR_PATH_MAX - 1);
+  strncpy(mountpoint, point ? point : "", LOVR_PATH_MAX - 1);
+  realDir[LOVR_PATH_MAX - 1] = mountpoint[LOVR_PATH_MAX - 1] = '\0';
+  mtx_unlock(&state.mountLock);
+
+  // Strip the mountpoint to get the path relative to the mounted directory
+  const char* prefix = mountpoint;
+  while (*path == '/') path++;
+  while (*prefix == '/') prefix++;
+  size_t mountLength = strlen(prefix);
+  if (mountLength > 0 && !strncmp(path, prefix, mountLength)) {
+    path += mountLength;
+  }
+
+  char fullPath[LOVR_PATH_MAX];
+  snprintf(fullPath, LOVR_PATH_MAX, "%s/%s", realDir, path);
+
+#ifdef _WIN32
+  DWORD attributes = GetFileAttributesA(realDir);
+  if (attributes == INVALID_FILE_ATTRIBUTES || !(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+    return NULL;
+  }
+
+  HANDLE file = CreateFileA(fullPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return NULL;
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+    CloseHandle(file);
+    return NULL;
+  }
+
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+  CloseHandle(file);
+  if (!mapping) {
+    return NULL;
+  }
+
+  void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+  CloseHandle(mapping);
+  if (!data) {
+    return NULL;
+  }
+
+  *size = (size_t) fileSize.QuadPart;
+  return data;
+#else
+  struct stat info;
+  if (stat(realDir, &info) || !S_ISDIR(info.st_mode)) {
+    return NULL;
+  }
+
+  int fd = open(fullPath, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  if (fstat(fd, &info) || !S_ISREG(info.st_mode) || info.st_size == 0) {
+    close(fd);
+    return NULL;
+  }
+
+  void* data = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return NULL;
+  }
+
+  *size = info.st_size;
+  return data;
+#endif
+#endif
+}
+
 int lovrFilesystemMount(const char* path, const char* mountpoint, bool append) {
-  return !PHYSFS_mount(path, mountpoint, append);
+  mtx_lock(&state.mountLock);
+  state.indexDirty = true;
+  int result = !PHYSFS_mount(path, mountpoint, append);
+  mtx_unlock(&state.mountLock);
+  return result;
 }
 
 void* lovrFilesystemRead(const char* path, size_t* bytesRead) {
@@ -189,24 +533,27 @@ void* lovrFilesystemRead(const char* path, size_t* bytesRead) {
 
   // Open it
   if (lovrFileOpen(file, OPEN_READ)) {
+    lovrRelease(file);
     return NULL;
   }
 
   // Get file size
   size_t size = lovrFileGetSize(file);
   if (size == (unsigned int) -1) {
+    lovrRelease(file);
     return NULL;
   }
 
   // Allocate buffer
   void* data = malloc(size);
   if (!data) {
+    lovrRelease(file);
     return NULL;
   }
 
   // Perform read
   *bytesRead = lovrFileRead(file, data, size);
-  lovrFileClose(file);
+  lovrRelease(file);
 
   // Make sure we got everything
   if (*bytesRead != (size_t) size) {
@@ -218,7 +565,20 @@ void* lovrFilesystemRead(const char* path, size_t* bytesRead) {
 }
 
 int lovrFilesystemRemove(const char* path) {
-  return !PHYSFS_delete(path);
+  if (!PHYSFS_delete(path)) {
+    return 1;
+  }
+
+  lovrFilesystemUpdateIndex(path);
+  return 0;
+}
+
+// The old write directory string is freed when it changes, so this takes the same lock as mounting
+static int lovrFilesystemSetWriteDirectory(const char* path) {
+  mtx_lock(&state.mountLock);
+  int result = PHYSFS_setWriteDir(path);
+  mtx_unlock(&state.mountLock);
+  return result;
 }
 
 int lovrFilesystemSetIdentity(const char* identity) {
@@ -226,7 +586,7 @@ int lovrFilesystemSetIdentity(const char* identity) {
 
   // Unmount old write directory
   if (state.savePathFull && state.savePathRelative) {
-    PHYSFS_unmount(state.savePathRelative);
+    lovrFilesystemUnmount(state.savePathRelative);
   } else {
     state.savePathRelative = malloc(LOVR_PATH_MAX);
     state.savePathFull = malloc(LOVR_PATH_MAX);
@@ -236,7 +596,7 @@ int lovrFilesystemSetIdentity(const char* identity) {
   }
 
   lovrFilesystemGetAppdataDirectory(state.savePathFull, LOVR_PATH_MAX);
-  if (!PHYSFS_setWriteDir(state.savePathFull)) {
+  if (!lovrFilesystemSetWriteDirectory(state.savePathFull)) {
     const char* error = PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode());
     lovrThrow("Could not set write directory: %s (%s)", error, state.savePathFull);
   }
@@ -246,18 +606,33 @@ int lovrFilesystemSetIdentity(const char* identity) {
   snprintf(fullPathBuffer, LOVR_PATH_MAX, "%s/%s", state.savePathFull, state.savePathRelative);
   strncpy(state.savePathFull, fullPathBuffer, LOVR_PATH_MAX);
   PHYSFS_mkdir(state.savePathRelative);
-  if (!PHYSFS_setWriteDir(state.savePathFull)) {
+  if (!lovrFilesystemSetWriteDirectory(state.savePathFull)) {
     const char* error = PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode());
     lovrThrow("Could not set write directory: %s (%s)", error, state.savePathRelative);
   }
 
-  PHYSFS_mount(state.savePathFull, NULL, 0);
-
+  lovrFilesystemMount(state.savePathFull, NULL, 0);
   return 0;
 }
 
+// Disabling the index makes every query go straight to PhysFS, which is useful for debugging or when
+// files are modified outside of LÖVR.  Enabling it again rebuilds it.
+void lovrFilesystemSetIndexEnabled(bool enabled) {
+  mtx_lock(&state.indexLock);
+  state.indexEnabled = enabled;
+  state.indexDirty = true;
+  if (!enabled) {
+    lovrFilesystemIndexClear();
+  }
+  mtx_unlock(&state.indexLock);
+}
+
 int lovrFilesystemUnmount(const char* path) {
-  return !PHYSFS_unmount(path);
+  mtx_lock(&state.mountLock);
+  state.indexDirty = true;
+  int result = !PHYSFS_unmount(path);
+  mtx_unlock(&state.mountLock);
+  return result;
 }
 
 size_t lovrFilesystemWrite(const char* path, const char* content, size_t size, bool append) {
@@ -1,3 +1,7 @@
+#include "data/blob.h"
+#include "lib/map/map.h"
+#include "lib/vec/vec.h"
+#include "lib/tinycthread/tinycthread.h"
 #include <stdio.h>
 #include <stdbool.h>
 
@@ -7,6 +11,16 @@
 
 typedef int getDirectoryItemsCallback(void* userdata, const char* dir, const char* file);
 
+typedef struct {
+  bool isFile;
+  bool isDirectory;
+  size_t size;
+  long modtime;
+  vec_str_t children;
+} FileInfo;
+
+typedef map_t(FileInfo) map_fileinfo_t;
+
 typedef struct {
   bool initialized;
   char* source;
@@ -14,6 +28,11 @@ typedef struct {
   char* savePathRelative;
   char* savePathFull;
   bool isFused;
+  bool indexEnabled;
+  bool indexDirty;
+  map_fileinfo_t index;
+  mtx_t indexLock;
+  mtx_t mountLock;
 } FilesystemState;
 
 void lovrFilesystemInit(const char* arg0, const char* arg1);
@@ -32,10 +51,15 @@ const char* lovrFilesystemGetUserDirectory();
 bool lovrFilesystemIsDirectory(const char* path);
 bool lovrFilesystemIsFile(const char* path);
 bool lovrFilesystemIsFused();
+bool lovrFilesystemIsIndexEnabled();
+Blob* lovrFilesystemLoadBlob(const char* path);
+void* lovrFilesystemMap(const char* path, size_t* size);
 int lovrFilesystemMount(const char* path, const char* mountpoint, bool append);
 void* lovrFilesystemRead(const char* path, size_t* bytesRead);
 int lovrFilesystemRemove(const char* path);
 int lovrFilesystemSetIdentity(const char* identity);
+void lovrFilesystemSetIndexEnabled(bool enabled);
 int lovrFilesystemSetSource(const char* source);
 int lovrFilesystemUnmount(const char* path);
+void lovrFilesystemUpdateIndex(const char* path);
 size_t lovrFilesystemWrite(const char* path, const char* content, size_t size, bool append);
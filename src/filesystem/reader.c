@@ -0,0 +1,271 @@
+#include "filesystem/reader.h"
+#include "filesystem/filesystem.h"
+#include <stdlib.h>
+#include <string.h>
+
+static ReaderState state;
+
+// Higher priorities go first, requests with the same priority are served in order
+static bool lovrReaderBefore(ReadRequest* a, ReadRequest* b) {
+  if (a->priority != b->priority) {
+    return a->priority > b->priority;
+  }
+
+  return a->sequence < b->sequence;
+}
+
+// The queue is a binary heap stored in a vec
+static void lovrReaderPush(ReadRequest* request) {
+  vec_push(&state.queue, request);
+  int i = state.queue.length - 1;
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+    if (!lovrReaderBefore(state.queue.data[i], state.queue.data[parent])) {
+      break;
+    }
+    vec_swap(&state.queue, i, parent);
+    i = parent;
+  }
+}
+
+static ReadRequest* lovrReaderPop() {
+  ReadRequest* top = state.queue.data[0];
+  state.queue.data[0] = vec_last(&state.queue);
+  vec_pop(&state.queue);
+
+  int i = 0;
+  int n = state.queue.length;
+  for (;;) {
+    int left = 2 * i + 1;
+    int right = left + 1;
+    int best = i;
+    if (left < n && lovrReaderBefore(state.queue.data[left], state.queue.data[best])) best = left;
+    if (right < n && lovrReaderBefore(state.queue.data[right], state.queue.data[best])) best = right;
+    if (best == i) break;
+    vec_swap(&state.queue, i, best);
+    i = best;
+  }
+
+  return top;
+}
+
+// Workers never touch refcounts of requests; finished requests are handed back to the main thread
+// through the completed list, which owns the reference the queue held.
+static int lovrReaderThreadMain(void* data) {
+  mtx_lock(&state.lock);
+
+  for (;;) {
+    while (state.running && state.queue.length == 0) {
+      cnd_wait(&state.cond, &state.lock);
+    }
+
+    if (!state.running) {
+      break;
+    }
+
+    ReadRequest* request = lovrReaderPop();
+
+    if (request->status == READ_CANCELED) {
+      vec_push(&state.completed, request);
+      continue;
+    }
+
+    request->status = READ_ACTIVE;
+    request->startTime = lovrGetTicks() / 1e9;
+    mtx_unlock(&state.lock);
+
+    Blob* blob = lovrFilesystemLoadBlob(request->path);
+
+    mtx_lock(&state.lock);
+    request->finishTime = lovrGetTicks() / 1e9;
+    state.stats.waitTime += request->startTime - request->queueTime;
+    state.stats.readTime += request->finishTime - request->startTime;
+
+    if (request->status == READ_CANCELED) {
+      lovrRelease(blob);
+    } else if (blob) {
+      request->status = READ_COMPLETE;
+      request->blob = blob;
+      state.stats.completed++;
+      state.stats.bytes += blob->size;
+    } else {
+      request->status = READ_FAILED;
+      state.stats.failed++;
+    }
+
+    vec_push(&state.completed, request);
+  }
+
+  mtx_unlock(&state.lock);
+  return 0;
+}
+
+void lovrReaderInit() {
+  if (state.initialized) return;
+  mtx_init(&state.lock, mtx_plain);
+  cnd_init(&state.cond);
+  vec_init(&state.queue);
+  vec_init(&state.completed);
+  state.running = true;
+  for (int i = 0; i < READER_THREADS; i++) {
+    lovrAssert(thrd_create(&state.threads[i], lovrReaderThreadMain, NULL) == thrd_success, "Could not create file reader thread");
+  }
+  state.initialized = true;
+}
+
+void lovrReaderDestroy() {
+  if (!state.initialized) return;
+
+  mtx_lock(&state.lock);
+  state.running = false;
+  cnd_broadcast(&state.cond);
+  mtx_unlock(&state.lock);
+
+  for (int i = 0; i < READER_THREADS; i++) {
+    thrd_join(state.threads[i], NULL);
+  }
+
+  // Requests Lua still holds will never be read now, so they report that they were canceled
+  int i; ReadRequest* request;
+  vec_foreach(&state.queue, request, i) {
+    request->status = READ_CANCELED;
+    lovrRelease(request);
+  }
+  vec_foreach(&state.completed, request, i) {
+    lovrRelease(request);
+  }
+
+  vec_deinit(&state.queue);
+  vec_deinit(&state.completed);
+  cnd_destroy(&state.cond);
+  mtx_destroy(&state.lock);
+  memset(&state, 0, sizeof(ReaderState));
+}
+
+// The returned request holds one reference for the caller and one for the queue
+ReadRequest* lovrReaderQueue(const char* path, int priority) {
+  lovrReaderInit();
+
+  ReadRequest* request = lovrAlloc(sizeof(ReadRequest), lovrReadRequestDestroy);
+  if (!request) return NULL;
+
+  request->path = strdup(path);
+  request->priority = priority;
+  request->status = READ_PENDING;
+  request->blob = NULL;
+  request->queueTime = lovrGetTicks() / 1e9;
+  request->startTime = 0;
+  request->finishTime = 0;
+  lovrRetain(request);
+
+  mtx_lock(&state.lock);
+  request->sequence = state.sequence++;
+  state.stats.requests++;
+  lovrReaderPush(request);
+  cnd_signal(&state.cond);
+  mtx_unlock(&state.lock);
+
+  return request;
+}
+
+// Returns the next finished request along with the queue's reference to it, which must be released
+bool lovrReaderPoll(ReadRequest** request) {
+  if (!state.initialized) {
+    return false;
+  }
+
+  mtx_lock(&state.lock);
+  bool found = state.completed.length > 0;
+  if (found) {
+    *request = state.completed.data[0];
+    vec_splice(&state.completed, 0, 1);
+  }
+  mtx_unlock(&state.lock);
+  return found;
+}
+
+int lovrReaderGetPendingCount() {
+  if (!state.initialized) {
+    return 0;
+  }
+
+  mtx_lock(&state.lock);
+  int count = state.queue.length;
+  mtx_unlock(&state.lock);
+  return count;
+}
+
+// When something (the event module) is consuming finished requests, the API leaves them alone
+bool lovrReaderIsNotifying() {
+  return state.notify;
+}
+
+void lovrReaderSetNotify(bool notify) {
+  state.notify = notify;
+}
+
+ReaderStats lovrReaderGetStats() {
+  if (!state.initialized) {
+    return state.stats;
+  }
+
+  mtx_lock(&state.lock);
+  ReaderStats stats = state.stats;
+  mtx_unlock(&state.lock);
+  return stats;
+}
+
+// Requests can outlive the reader (Lua may collect them after a restart), and once it's destroyed
+// there are no workers left to race with, so the accessors only lock while it's running
+static void lovrReaderLock() {
+  if (state.initialized) {
+    mtx_lock(&state.lock);
+  }
+}
+
+static void lovrReaderUnlock() {
+  if (state.initialized) {
+    mtx_unlock(&state.lock);
+  }
+}
+
+void lovrReadRequestDestroy(void* ref) {
+  ReadRequest* request = ref;
+  lovrRelease(request->blob);
+  free(request->path);
+  free(request);
+}
+
+Blob* lovrReadRequestGetBlob(ReadRequest* request) {
+  lovrReaderLock();
+  Blob* blob = request->status == READ_COMPLETE ? request->blob : NULL;
+  lovrReaderUnlock();
+  return blob;
+}
+
+void lovrReadRequestGetLatency(ReadRequest* request, double* wait, double* read) {
+  lovrReaderLock();
+  double now = lovrGetTicks() / 1e9;
+  double start = request->startTime > 0 ? request->startTime : now;
+  double finish = request->finishTime > 0 ? request->finishTime : now;
+  *wait = start - request->queueTime;
+  *read = request->startTime > 0 ? finish - start : 0;
+  lovrReaderUnlock();
+}
+
+ReadStatus lovrReadRequestGetStatus(ReadRequest* request) {
+  lovrReaderLock();
+  ReadStatus status = request->status;
+  lovrReaderUnlock();
+  return status;
+}
+
+// Pending requests are skipped by the workers, active ones finish but their result is dropped
+void lovrReadRequestCancel(ReadRequest* request) {
+  lovrReaderLock();
+  if (request->status == READ_PENDING || request->status == READ_ACTIVE) {
+    request->status = READ_CANCELED;
+    state.stats.canceled++;
+  }
+  lovrReaderUnlock();
+}
@@ -0,0 +1,66 @@
+#include "data/blob.h"
+#include "lib/vec/vec.h"
+#include "util.h"
+#include <stdbool.h>
+
+#pragma once
+
+#define READER_THREADS 2
+
+typedef enum {
+  READ_PENDING,
+  READ_ACTIVE,
+  READ_COMPLETE,
+  READ_FAILED,
+  READ_CANCELED
+} ReadStatus;
+
+typedef struct {
+  Ref ref;
+  char* path;
+  int priority;
+  unsigned int sequence;
+  ReadStatus status;
+  Blob* blob;
+  double queueTime;
+  double startTime;
+  double finishTime;
+} ReadRequest;
+
+typedef struct {
+  int requests;
+  int completed;
+  int failed;
+  int canceled;
+  size_t bytes;
+  double waitTime;
+  double readTime;
+} ReaderStats;
+
+typedef struct {
+  bool initialized;
+  bool running;
+  thrd_t threads[READER_THREADS];
+  mtx_t lock;
+  cnd_t cond;
+  vec_void_t queue;
+  vec_void_t completed;
+  unsigned int sequence;
+  bool notify;
+  ReaderStats stats;
+} ReaderState;
+
+void lovrReaderInit();
+void lovrReaderDestroy();
+ReadRequest* lovrReaderQueue(const char* path, int priority);
+bool lovrReaderPoll(ReadRequest** request);
+int lovrReaderGetPendingCount();
+bool lovrReaderIsNotifying();
+void lovrReaderSetNotify(bool notify);
+ReaderStats lovrReaderGetStats();
+
+void lovrReadRequestDestroy(void* ref);
+Blob* lovrReadRequestGetBlob(ReadRequest* request);
+void lovrReadRequestGetLatency(ReadRequest* request, double* wait, double* read);
+ReadStatus lovrReadRequestGetStatus(ReadRequest* request);
+void lovrReadRequestCancel(ReadRequest* request);
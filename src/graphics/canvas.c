@@ -78,7 +78,9 @@ Canvas* lovrCanvasCreate(int width, int height, TextureFormat format, int msaa,
 
   lovrAssert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Error creating Canvas");
   lovrGraphicsClear(true, true, true, (Color) { 0, 0, 0, 0 }, 1., 0);
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  // Put back the framebuffer graphics thinks is bound, so it doesn't skip the next real switch
+  glBindFramebuffer(GL_FRAMEBUFFER, lovrGraphicsGetFramebuffer());
 
   return canvas;
 }
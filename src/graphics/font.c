@@ -276,6 +276,7 @@ void lovrFontAddGlyph(Font* font, Glyph* glyph) {
   // Paste glyph into texture
   lovrGraphicsBindTexture(font->texture, TEXTURE_2D, 0);
   glTexSubImage2D(GL_TEXTURE_2D, 0, atlas->x, atlas->y, glyph->tw, glyph->th, GL_RGB, GL_UNSIGNED_BYTE, glyph->data);
+  lovrGraphicsCount(STAT_TEXTURE_BYTES, glyph->tw * glyph->th * 3);
 
   // Advance atlas cursor
   atlas->x += glyph->tw + atlas->padding;
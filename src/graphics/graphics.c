@@ -12,6 +12,7 @@
 #define _USE_MATH_DEFINES
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 
 static GraphicsState state;
@@ -35,11 +36,18 @@ static void gammaCorrectColor(Color* color) {
 
 // Base
 
+// The transform stack doesn't need a GL context, so it's usable before (or without) a window
 void lovrGraphicsInit() {
-  //
+  state.transform = 0;
+  state.transformCapacity = INITIAL_TRANSFORMS;
+  state.transforms = malloc(state.transformCapacity * sizeof(TransformLevel));
+  lovrAssert(state.transforms, "Out of memory");
+  lovrGraphicsOrigin();
 }
 
 void lovrGraphicsDestroy() {
+  free(state.transforms);
+  state.transforms = NULL;
   if (!state.initialized) return;
   lovrGraphicsSetShader(NULL);
   lovrGraphicsSetFont(NULL);
@@ -54,6 +62,13 @@ void lovrGraphicsDestroy() {
   glDeleteBuffers(1, &state.streamIBO);
   vec_deinit(&state.streamData);
   vec_deinit(&state.streamIndices);
+#ifndef EMSCRIPTEN
+  for (int i = 0; i < MAX_GPU_TIMERS; i++) {
+    if (state.timers[i].queries[0]) {
+      glDeleteQueries(2, state.timers[i].queries);
+    }
+  }
+#endif
   memset(&state, 0, sizeof(GraphicsState));
 }
 
@@ -68,6 +83,7 @@ void lovrGraphicsReset() {
   state.displays[state.display].viewport[1] = 0;
   state.displays[state.display].viewport[2] = w;
   state.displays[state.display].viewport[3] = h;
+  state.displays[state.display].stereo = false;
   lovrGraphicsSetBackgroundColor((Color) { 0, 0, 0, 1. });
   lovrGraphicsSetBlendMode(BLEND_ALPHA, BLEND_ALPHA_MULTIPLY);
   lovrGraphicsSetColor((Color) { 1., 1., 1., 1. });
@@ -103,10 +119,49 @@ void lovrGraphicsClear(bool clearColor, bool clearDepth, bool clearStencil, Colo
   }
 }
 
+// Timer queries finish a frame or two after they are issued, so results are collected when they are
+// available and reported to the profiler on the CPU clock.
+static void lovrGraphicsResolveTimers() {
+#ifndef EMSCRIPTEN
+  GLint64 gpuTime;
+  glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+  double offset = lovrGetTicks() / 1e9 - gpuTime / 1e9;
+
+  for (int i = 0; i < MAX_GPU_TIMERS; i++) {
+    GpuTimer* timer = &state.timers[i];
+    if (!timer->pending) {
+      continue;
+    }
+
+    GLint available;
+    glGetQueryObjectiv(timer->queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+      continue;
+    }
+
+    GLuint64 start, end;
+    glGetQueryObjectui64v(timer->queries[0], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(timer->queries[1], GL_QUERY_RESULT, &end);
+    lovrProfilerAddEvent(timer->name, PROFILE_GPU, timer->depth, start / 1e9 + offset, (end - start) / 1e9);
+    timer->pending = false;
+  }
+#endif
+}
+
 void lovrGraphicsPresent() {
+  lovrProfilerPush("present");
   glfwSwapBuffers(state.window);
-  state.stats.drawCalls = 0;
-  state.stats.shaderSwitches = 0;
+  lovrProfilerPop();
+
+  if (lovrProfilerIsEnabled()) {
+    lovrGraphicsResolveTimers();
+  }
+
+  state.history[state.historyIndex] = state.stats;
+  state.historyIndex = (state.historyIndex + 1) % GRAPHICS_STATS_HISTORY;
+  state.historyCount = MIN(state.historyCount + 1, GRAPHICS_STATS_HISTORY);
+  memset(&state.stats, 0, sizeof(GraphicsStats));
+  state.passCount = 0;
 }
 
 void lovrGraphicsPrepare(Material* material, float* pose) {
@@ -116,31 +171,64 @@ void lovrGraphicsPrepare(Material* material, float* pose) {
     shader = state.defaultShaders[state.defaultShader] = lovrShaderCreateDefault(state.defaultShader);
   }
 
-  mat4 model = state.transforms[state.transform][MATRIX_MODEL];
-  mat4 view = state.transforms[state.transform][MATRIX_VIEW];
-  mat4 projection = state.displays[state.display].projection;
+  Display* display = &state.displays[state.display];
+  TransformLevel* level = &state.transforms[state.transform];
+  mat4 model = level->matrices[MATRIX_MODEL];
+  mat4 view = level->matrices[MATRIX_VIEW];
+  mat4 projection = display->projection;
   lovrShaderSetMatrix(shader, "lovrModel", model, 16);
   lovrShaderSetMatrix(shader, "lovrView", view, 16);
   lovrShaderSetMatrix(shader, "lovrProjection", projection, 16);
 
-  float transform[16];
-  mat4_multiply(mat4_set(transform, view), model);
-  lovrShaderSetMatrix(shader, "lovrTransform", transform, 16);
+  if (level->dirty) {
+    mat4_multiply(mat4_set(level->transform, view), model);
+    level->dirty = false;
+    level->normalDirty = true;
+  }
+
+  lovrShaderSetMatrix(shader, "lovrTransform", level->transform, 16);
 
-  if (lovrShaderGetUniform(shader, "lovrNormalMatrix")) {
-    if (mat4_invert(transform)) {
-      mat4_transpose(transform);
+  // Stereo
+  int stereo = lovrGraphicsIsStereo();
+  lovrShaderSetInt(shader, "lovrStereo", &stereo, 1);
+  if (stereo) {
+    float transforms[32];
+    for (int eye = 0; eye < 2; eye++) {
+      mat4 eyeTransform = transforms + 16 * eye;
+      mat4_multiply(mat4_multiply(mat4_set(eyeTransform, display->eyeOffsets + 16 * eye), view), model);
+    }
+    lovrShaderSetMatrix(shader, "lovrStereoTransforms", transforms, 32);
+    lovrShaderSetMatrix(shader, "lovrStereoProjections", display->eyeProjections, 32);
+  }
+
+#ifndef EMSCRIPTEN
+  if (state.clipDistance != (bool) stereo) {
+    state.clipDistance = stereo;
+    if (stereo) {
+      glEnable(GL_CLIP_DISTANCE0);
     } else {
-      mat4_identity(transform);
+      glDisable(GL_CLIP_DISTANCE0);
     }
+  }
+#endif
 
-    float normalMatrix[9] = {
-      transform[0], transform[1], transform[2],
-      transform[4], transform[5], transform[6],
-      transform[8], transform[9], transform[10]
-    };
+  if (lovrShaderGetUniform(shader, "lovrNormalMatrix")) {
+    if (level->normalDirty) {
+      float transform[16];
+      if (mat4_invert(mat4_set(transform, level->transform))) {
+        mat4_transpose(transform);
+      } else {
+        mat4_identity(transform);
+      }
+
+      float* normalMatrix = level->normalMatrix;
+      normalMatrix[0] = transform[0]; normalMatrix[1] = transform[1]; normalMatrix[2] = transform[2];
+      normalMatrix[3] = transform[4]; normalMatrix[4] = transform[5]; normalMatrix[5] = transform[6];
+      normalMatrix[6] = transform[8]; normalMatrix[7] = transform[9]; normalMatrix[8] = transform[10];
+      level->normalDirty = false;
+    }
 
-    lovrShaderSetMatrix(shader, "lovrNormalMatrix", normalMatrix, 9);
+    lovrShaderSetMatrix(shader, "lovrNormalMatrix", level->normalMatrix, 9);
   }
 
   // Color
@@ -187,7 +275,7 @@ void lovrGraphicsPrepare(Material* material, float* pose) {
   lovrShaderBind(shader);
 }
 
-void lovrGraphicsCreateWindow(int w, int h, bool fullscreen, int msaa, const char* title, const char* icon) {
+void lovrGraphicsCreateWindow(int w, int h, bool fullscreen, int msaa, const char* title, const char* icon, bool visible) {
   lovrAssert(!state.window, "Window is already created");
 
   if ((state.window = glfwGetCurrentContext()) == NULL) {
@@ -205,6 +293,7 @@ void lovrGraphicsCreateWindow(int w, int h, bool fullscreen, int msaa, const cha
     glfwWindowHint(GLFW_SAMPLES, msaa);
     glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
     glfwWindowHint(GLFW_SRGB_CAPABLE, state.gammaCorrect);
+    glfwWindowHint(GLFW_VISIBLE, visible);
 #endif
 
     GLFWmonitor* monitor = glfwGetPrimaryMonitor();
@@ -272,6 +361,59 @@ GraphicsStats lovrGraphicsGetStats() {
   return state.stats;
 }
 
+GraphicsPass* lovrGraphicsGetPasses(int* count) {
+  *count = state.passCount;
+  return state.passes;
+}
+
+// Copies the totals of up to count previous frames, oldest first, returning how many were copied
+int lovrGraphicsGetStatsHistory(GraphicsStats* history, int count) {
+  count = MIN(count, state.historyCount);
+  int start = state.historyIndex - count + GRAPHICS_STATS_HISTORY;
+  for (int i = 0; i < count; i++) {
+    history[i] = state.history[(start + i) % GRAPHICS_STATS_HISTORY];
+  }
+  return count;
+}
+
+// GPU timers use timestamp queries instead of GL_TIME_ELAPSED, since elapsed time queries can't nest
+void lovrGraphicsPushTimer(const char* name) {
+#ifndef EMSCRIPTEN
+  if (!lovrProfilerIsEnabled() || !state.window || state.timerDepth >= MAX_PROFILER_DEPTH) return;
+
+  // If the next timer is still waiting on the GPU, this scope is dropped instead of stalling
+  GpuTimer* timer = &state.timers[state.timerIndex];
+  if (timer->pending) {
+    state.timerStack[state.timerDepth++] = -1;
+    return;
+  }
+
+  if (!timer->queries[0]) {
+    glGenQueries(2, timer->queries);
+  }
+
+  strncpy(timer->name, name, MAX_PROFILER_NAME - 1);
+  timer->name[MAX_PROFILER_NAME - 1] = '\0';
+  timer->depth = state.timerDepth;
+  glQueryCounter(timer->queries[0], GL_TIMESTAMP);
+  state.timerStack[state.timerDepth++] = state.timerIndex;
+  state.timerIndex = (state.timerIndex + 1) % MAX_GPU_TIMERS;
+#endif
+}
+
+void lovrGraphicsPopTimer() {
+#ifndef EMSCRIPTEN
+  if (state.timerDepth == 0) return;
+
+  int index = state.timerStack[--state.timerDepth];
+  if (index >= 0) {
+    GpuTimer* timer = &state.timers[index];
+    glQueryCounter(timer->queries[1], GL_TIMESTAMP);
+    timer->pending = true;
+  }
+#endif
+}
+
 // State
 
 Color lovrGraphicsGetBackgroundColor() {
@@ -357,6 +499,8 @@ void lovrGraphicsSetCanvas(Canvas** canvas, int count) {
     glBindFramebuffer(GL_READ_FRAMEBUFFER, state.canvas[0]->framebuffer);
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, state.canvas[0]->resolveFramebuffer);
     glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    // The blit bound the read and draw framebuffers separately, so put back the tracked one
+    glBindFramebuffer(GL_FRAMEBUFFER, state.framebuffer);
   }
 
   for (int i = 0; i < count; i++) {
@@ -578,12 +722,19 @@ void lovrGraphicsSetWireframe(bool wireframe) {
 
 // Transforms
 
+// Pushed levels start out as a copy of their parent, including any matrices it has already derived
 void lovrGraphicsPush() {
   if (++state.transform >= MAX_TRANSFORMS) {
     lovrThrow("Unbalanced matrix stack (more pushes than pops?)");
   }
 
-  memcpy(state.transforms[state.transform], state.transforms[state.transform - 1], 2 * 16 * sizeof(float));
+  if (state.transform >= state.transformCapacity) {
+    state.transformCapacity *= 2;
+    state.transforms = realloc(state.transforms, state.transformCapacity * sizeof(TransformLevel));
+    lovrAssert(state.transforms, "Out of memory");
+  }
+
+  memcpy(&state.transforms[state.transform], &state.transforms[state.transform - 1], sizeof(TransformLevel));
 }
 
 void lovrGraphicsPop() {
@@ -593,24 +744,34 @@ void lovrGraphicsPop() {
 }
 
 void lovrGraphicsOrigin() {
-  mat4_identity(state.transforms[state.transform][MATRIX_MODEL]);
-  mat4_identity(state.transforms[state.transform][MATRIX_VIEW]);
+  TransformLevel* level = &state.transforms[state.transform];
+  mat4_identity(level->matrices[MATRIX_MODEL]);
+  mat4_identity(level->matrices[MATRIX_VIEW]);
+  level->dirty = true;
 }
 
 void lovrGraphicsTranslate(MatrixType type, float x, float y, float z) {
-  mat4_translate(state.transforms[state.transform][type], x, y, z);
+  TransformLevel* level = &state.transforms[state.transform];
+  mat4_translate(level->matrices[type], x, y, z);
+  level->dirty = true;
 }
 
 void lovrGraphicsRotate(MatrixType type, float angle, float ax, float ay, float az) {
-  mat4_rotate(state.transforms[state.transform][type], angle, ax, ay, az);
+  TransformLevel* level = &state.transforms[state.transform];
+  mat4_rotate(level->matrices[type], angle, ax, ay, az);
+  level->dirty = true;
 }
 
 void lovrGraphicsScale(MatrixType type, float x, float y, float z) {
-  mat4_scale(state.transforms[state.transform][type], x, y, z);
+  TransformLevel* level = &state.transforms[state.transform];
+  mat4_scale(level->matrices[type], x, y, z);
+  level->dirty = true;
 }
 
 void lovrGraphicsMatrixTransform(MatrixType type, mat4 transform) {
-  mat4_multiply(state.transforms[state.transform][type], transform);
+  TransformLevel* level = &state.transforms[state.transform];
+  mat4_multiply(level->matrices[type], transform);
+  level->dirty = true;
 }
 
 // Primitives
@@ -635,6 +796,7 @@ static void lovrGraphicsDrawPrimitive(Material* material, GLenum mode, bool hasN
   lovrGraphicsBindVertexArray(state.streamVAO);
   lovrGraphicsBindVertexBuffer(state.streamVBO);
   glBufferData(GL_ARRAY_BUFFER, state.streamData.length * sizeof(float), data, GL_STREAM_DRAW);
+  lovrGraphicsCount(STAT_BUFFER_BYTES, state.streamData.length * sizeof(float));
   glEnableVertexAttribArray(LOVR_SHADER_POSITION);
   glVertexAttribPointer(LOVR_SHADER_POSITION, 3, GL_FLOAT, GL_FALSE, strideBytes, (void*) 0);
 
@@ -659,6 +821,7 @@ static void lovrGraphicsDrawPrimitive(Material* material, GLenum mode, bool hasN
   if (useIndices) {
     lovrGraphicsBindIndexBuffer(state.streamIBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, state.streamIndices.length * sizeof(unsigned int), indices, GL_STREAM_DRAW);
+    lovrGraphicsCount(STAT_BUFFER_BYTES, state.streamIndices.length * sizeof(unsigned int));
     lovrGraphicsDrawElements(mode, state.streamIndices.length, sizeof(uint32_t), 0, 1);
   } else {
     lovrGraphicsDrawArrays(mode, 0, state.streamData.length / stride, 1);
@@ -729,12 +892,13 @@ void lovrGraphicsPlane(DrawMode mode, Material* material, mat4 transform) {
   lovrGraphicsPop();
 }
 
-void lovrGraphicsPlaneFullscreen(Texture* texture) {
+// u is the horizontal extent of the texture to draw, a stereo canvas mirrors its left half with .5
+void lovrGraphicsPlaneFullscreen(Texture* texture, float u) {
   float data[] = {
     -1, 1, 0,  0, 1,
     -1, -1, 0, 0, 0,
-    1, 1, 0,   1, 1,
-    1, -1, 0,  1, 0
+    1, 1, 0,   u, 1,
+    1, -1, 0,  u, 0
   };
 
   lovrGraphicsSetDefaultShader(SHADER_FULLSCREEN);
@@ -1185,6 +1349,7 @@ void lovrGraphicsPushDisplay(int framebuffer, mat4 projection, int* viewport) {
   state.displays[state.display].framebuffer = framebuffer;
   memcpy(state.displays[state.display].projection, projection, 16 * sizeof(float));
   memcpy(state.displays[state.display].viewport, viewport, 4 * sizeof(int));
+  state.displays[state.display].stereo = false;
 
   if (state.canvasCount == 0) {
     lovrGraphicsBindFramebuffer(framebuffer);
@@ -1192,6 +1357,17 @@ void lovrGraphicsPushDisplay(int framebuffer, mat4 projection, int* viewport) {
   }
 }
 
+// The viewport covers both eyes, the left eye renders to the left half and the right eye to the
+// right half.  The mono projection is the left eye's, for anything that doesn't know about stereo.
+void lovrGraphicsPushStereoDisplay(int framebuffer, float* projections, float* offsets, int* viewport) {
+  lovrAssert(lovrGraphicsIsStereoSupported(), "Single pass stereo is not supported on this system");
+  lovrGraphicsPushDisplay(framebuffer, projections, viewport);
+  Display* display = &state.displays[state.display];
+  display->stereo = true;
+  memcpy(display->eyeProjections, projections, 32 * sizeof(float));
+  memcpy(display->eyeOffsets, offsets, 32 * sizeof(float));
+}
+
 void lovrGraphicsPopDisplay() {
   if (--state.display < 0) {
     lovrThrow("Display underflow");
@@ -1204,12 +1380,52 @@ void lovrGraphicsPopDisplay() {
   }
 }
 
+// Drawing to a Canvas set with lovrGraphicsSetCanvas ignores the display, so it's always mono
+bool lovrGraphicsIsStereo() {
+  return state.displays[state.display].stereo && state.canvasCount == 0;
+}
+
+// Stereo relies on gl_ClipDistance to keep each eye in its half, which WebGL doesn't have
+bool lovrGraphicsIsStereoSupported() {
+#ifdef EMSCRIPTEN
+  return false;
+#else
+  return true;
+#endif
+}
+
 void lovrGraphicsSetViewport(int x, int y, int w, int h) {
   glViewport(x, y, w, h);
 }
 
+int lovrGraphicsGetFramebuffer() {
+  return state.framebuffer;
+}
+
 void lovrGraphicsBindFramebuffer(int framebuffer) {
-  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  if (state.framebuffer != framebuffer) {
+    state.framebuffer = framebuffer;
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    lovrGraphicsCount(STAT_FRAMEBUFFER_SWITCHES, 1);
+  }
+
+  // Rebinding the framebuffer of the current pass continues it, otherwise a new pass starts
+  GraphicsPass* pass = state.passCount > 0 ? &state.passes[state.passCount - 1] : NULL;
+  if ((!pass || pass->framebuffer != framebuffer) && state.passCount < MAX_GRAPHICS_PASSES) {
+    pass = &state.passes[state.passCount++];
+    memset(pass, 0, sizeof(GraphicsPass));
+    pass->framebuffer = framebuffer;
+    pass->type = framebuffer == state.displays[state.display].framebuffer ? PASS_DISPLAY : PASS_CANVAS;
+  }
+}
+
+// Stats are added to the frame totals and to the current pass (anything before the first framebuffer
+// switch of the frame only counts towards the totals)
+void lovrGraphicsCount(GraphicsStat stat, uint64_t amount) {
+  state.stats.values[stat] += amount;
+  if (state.passCount > 0) {
+    state.passes[state.passCount - 1].stats.values[stat] += amount;
+  }
 }
 
 Texture* lovrGraphicsGetTexture(int slot) {
@@ -1232,6 +1448,7 @@ void lovrGraphicsBindTexture(Texture* texture, TextureType type, int slot) {
     state.textures[slot] = texture;
     glActiveTexture(GL_TEXTURE0 + slot);
     glBindTexture(type, texture->id);
+    lovrGraphicsCount(STAT_TEXTURE_BINDS, 1);
   }
 }
 
@@ -1255,7 +1472,7 @@ void lovrGraphicsUseProgram(uint32_t program) {
   if (state.program != program) {
     state.program = program;
     glUseProgram(program);
-    state.stats.shaderSwitches++;
+    lovrGraphicsCount(STAT_SHADER_SWITCHES, 1);
   }
 }
 
@@ -1263,6 +1480,7 @@ void lovrGraphicsBindVertexArray(uint32_t vertexArray) {
   if (state.vertexArray != vertexArray) {
     state.vertexArray = vertexArray;
     glBindVertexArray(vertexArray);
+    lovrGraphicsCount(STAT_VERTEX_ARRAY_BINDS, 1);
   }
 }
 
@@ -1270,6 +1488,7 @@ void lovrGraphicsBindVertexBuffer(uint32_t vertexBuffer) {
   if (state.vertexBuffer != vertexBuffer) {
     state.vertexBuffer = vertexBuffer;
     glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    lovrGraphicsCount(STAT_BUFFER_BINDS, 1);
   }
 }
 
@@ -1277,21 +1496,38 @@ void lovrGraphicsBindIndexBuffer(uint32_t indexBuffer) {
   if (state.indexBuffer != indexBuffer) {
     state.indexBuffer = indexBuffer;
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    lovrGraphicsCount(STAT_BUFFER_BINDS, 1);
   }
 }
 
+static void lovrGraphicsCountDraw(GLenum mode, size_t count, int instances) {
+  size_t triangles = 0;
+  switch (mode) {
+    case GL_TRIANGLES: triangles = count / 3; break;
+    case GL_TRIANGLE_STRIP:
+    case GL_TRIANGLE_FAN: triangles = count > 2 ? count - 2 : 0; break;
+    default: break;
+  }
+
+  lovrGraphicsCount(STAT_DRAW_CALLS, 1);
+  lovrGraphicsCount(STAT_VERTICES, count * instances);
+  lovrGraphicsCount(STAT_TRIANGLES, triangles * instances);
+}
+
 void lovrGraphicsDrawArrays(GLenum mode, size_t start, size_t count, int instances) {
+  instances = MAX(instances, 1) * (lovrGraphicsIsStereo() ? 2 : 1);
   if (instances > 1) {
     glDrawArraysInstanced(mode, start, count, instances);
   } else {
     glDrawArrays(mode, start, count);
   }
 
-  state.stats.drawCalls++;
+  lovrGraphicsCountDraw(mode, count, instances);
 }
 
 void lovrGraphicsDrawElements(GLenum mode, size_t count, size_t indexSize, size_t offset, int instances) {
   GLenum indexType = indexSize == sizeof(uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+  instances = MAX(instances, 1) * (lovrGraphicsIsStereo() ? 2 : 1);
 
   if (instances > 1) {
     glDrawElementsInstanced(mode, count, indexType, (GLvoid*) offset, instances);
@@ -1299,5 +1535,5 @@ void lovrGraphicsDrawElements(GLenum mode, size_t count, size_t indexSize, size_
     glDrawElements(mode, count, indexType, (GLvoid*) offset);
   }
 
-  state.stats.drawCalls++;
+  lovrGraphicsCountDraw(mode, count, instances);
 }
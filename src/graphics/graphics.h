@@ -5,6 +5,7 @@
 #include "graphics/shader.h"
 #include "graphics/texture.h"
 #include "math/math.h"
+#include "timer/profiler.h"
 #include "lib/glfw.h"
 #include <stdbool.h>
 
@@ -12,10 +13,13 @@
 
 #define MAX_CANVASES 4
 #define MAX_DISPLAYS 4
-#define MAX_TRANSFORMS 60
-#define INTERNAL_TRANSFORMS 4
+#define MAX_TRANSFORMS 1024
+#define INITIAL_TRANSFORMS 64
 #define DEFAULT_SHADER_COUNT 4
 #define MAX_TEXTURES 16
+#define MAX_GPU_TIMERS 64
+#define MAX_GRAPHICS_PASSES 32
+#define GRAPHICS_STATS_HISTORY 120
 
 typedef void (*StencilCallback)(void* userdata);
 
@@ -75,10 +79,16 @@ typedef enum {
   MATRIX_VIEW
 } MatrixType;
 
+// Stereo displays render both eyes in a single pass, side by side.  Each draw is instanced twice
+// and the default vertex shader uses the instance to pick the eye's matrices and half of the
+// viewport.  The eye offsets are applied on top of the view matrix.
 typedef struct {
   int framebuffer;
   float projection[16];
   int viewport[4];
+  bool stereo;
+  float eyeProjections[32];
+  float eyeOffsets[32];
 } Display;
 
 typedef struct {
@@ -89,11 +99,54 @@ typedef struct {
   float textureAnisotropy;
 } GraphicsLimits;
 
+typedef enum {
+  STAT_DRAW_CALLS,
+  STAT_SHADER_SWITCHES,
+  STAT_TEXTURE_BINDS,
+  STAT_VERTEX_ARRAY_BINDS,
+  STAT_BUFFER_BINDS,
+  STAT_FRAMEBUFFER_SWITCHES,
+  STAT_UNIFORM_UPLOADS,
+  STAT_BUFFER_BYTES,
+  STAT_TEXTURE_BYTES,
+  STAT_VERTICES,
+  STAT_TRIANGLES,
+  MAX_GRAPHICS_STATS
+} GraphicsStat;
+
 typedef struct {
-  int drawCalls;
-  int shaderSwitches;
+  uint64_t values[MAX_GRAPHICS_STATS];
 } GraphicsStats;
 
+typedef enum {
+  PASS_DISPLAY,
+  PASS_CANVAS
+} GraphicsPassType;
+
+// A pass is everything drawn between two framebuffer switches
+typedef struct {
+  GraphicsPassType type;
+  int framebuffer;
+  GraphicsStats stats;
+} GraphicsPass;
+
+typedef struct {
+  char name[MAX_PROFILER_NAME];
+  uint32_t queries[2];
+  int depth;
+  bool pending;
+} GpuTimer;
+
+// A level of the transform stack.  The combined and normal matrices are derived from the model and
+// view matrices and are only recomputed after one of them changes.
+typedef struct {
+  float matrices[2][16];
+  float transform[16];
+  float normalMatrix[9];
+  bool dirty;
+  bool normalDirty;
+} TransformLevel;
+
 typedef struct {
   bool initialized;
   GLFWwindow* window;
@@ -102,7 +155,8 @@ typedef struct {
   Material* defaultMaterial;
   Font* defaultFont;
   Texture* defaultTexture;
-  float transforms[MAX_TRANSFORMS + INTERNAL_TRANSFORMS][2][16];
+  TransformLevel* transforms;
+  int transformCapacity;
   int transform;
   Color backgroundColor;
   BlendMode blendMode;
@@ -131,14 +185,25 @@ typedef struct {
   vec_uint_t streamIndices;
   Display displays[MAX_DISPLAYS];
   int display;
+  bool clipDistance;
   Texture* textures[MAX_TEXTURES];
   bool stencilEnabled;
   bool stencilWriting;
+  int framebuffer;
   uint32_t program;
   uint32_t vertexArray;
   uint32_t vertexBuffer;
   uint32_t indexBuffer;
   GraphicsStats stats;
+  GraphicsPass passes[MAX_GRAPHICS_PASSES];
+  int passCount;
+  GraphicsStats history[GRAPHICS_STATS_HISTORY];
+  int historyIndex;
+  int historyCount;
+  GpuTimer timers[MAX_GPU_TIMERS];
+  int timerIndex;
+  int timerStack[MAX_PROFILER_DEPTH];
+  int timerDepth;
 } GraphicsState;
 
 // Base
@@ -148,10 +213,14 @@ void lovrGraphicsReset();
 void lovrGraphicsClear(bool clearColor, bool clearDepth, bool clearStencil, Color color, float depth, int stencil);
 void lovrGraphicsPresent();
 void lovrGraphicsPrepare(Material* material, float* pose);
-void lovrGraphicsCreateWindow(int w, int h, bool fullscreen, int msaa, const char* title, const char* icon);
+void lovrGraphicsCreateWindow(int w, int h, bool fullscreen, int msaa, const char* title, const char* icon, bool visible);
 int lovrGraphicsGetWidth();
 int lovrGraphicsGetHeight();
 GraphicsStats lovrGraphicsGetStats();
+GraphicsPass* lovrGraphicsGetPasses(int* count);
+int lovrGraphicsGetStatsHistory(GraphicsStats* history, int count);
+void lovrGraphicsPushTimer(const char* name);
+void lovrGraphicsPopTimer();
 
 // State
 Color lovrGraphicsGetBackgroundColor();
@@ -200,7 +269,7 @@ void lovrGraphicsPoints(float* points, int count);
 void lovrGraphicsLine(float* points, int count);
 void lovrGraphicsTriangle(DrawMode mode, Material* material, float* points);
 void lovrGraphicsPlane(DrawMode mode, Material* material, mat4 transform);
-void lovrGraphicsPlaneFullscreen(Texture* texture);
+void lovrGraphicsPlaneFullscreen(Texture* texture, float u);
 void lovrGraphicsBox(DrawMode mode, Material* material, mat4 transform);
 void lovrGraphicsArc(DrawMode mode, ArcMode, Material* material, mat4 transform, float theta1, float theta2, int segments);
 void lovrGraphicsCircle(DrawMode mode, Material* material, mat4 transform, int segments);
@@ -212,9 +281,14 @@ void lovrGraphicsStencil(StencilAction action, int replaceValue, StencilCallback
 
 // Internal State
 void lovrGraphicsPushDisplay(int framebuffer, mat4 projection, int* viewport);
+void lovrGraphicsPushStereoDisplay(int framebuffer, float* projections, float* offsets, int* viewport);
 void lovrGraphicsPopDisplay();
+bool lovrGraphicsIsStereo();
+bool lovrGraphicsIsStereoSupported();
 void lovrGraphicsSetViewport(int x, int y, int w, int h);
+int lovrGraphicsGetFramebuffer();
 void lovrGraphicsBindFramebuffer(int framebuffer);
+void lovrGraphicsCount(GraphicsStat stat, uint64_t amount);
 Texture* lovrGraphicsGetTexture(int slot);
 void lovrGraphicsBindTexture(Texture* texture, TextureType type, int slot);
 Material* lovrGraphicsGetDefaultMaterial();
@@ -160,6 +160,7 @@ void lovrMeshSetVertexMap(Mesh* mesh, void* data, size_t count) {
   lovrGraphicsBindVertexArray(mesh->vao);
   lovrGraphicsBindIndexBuffer(mesh->ibo);
   glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh->indexCount * mesh->indexSize, mesh->indices.raw, GL_STATIC_DRAW);
+  lovrGraphicsCount(STAT_BUFFER_BYTES, mesh->indexCount * mesh->indexSize);
 }
 
 bool lovrMeshIsAttributeEnabled(Mesh* mesh, const char* name) {
@@ -247,6 +248,7 @@ VertexPointer lovrMeshMap(Mesh* mesh, int start, size_t count, bool read, bool w
   access |= (write && start == 0 && count == mesh->vertexData->count) ? GL_MAP_INVALIDATE_BUFFER_BIT : 0;
   lovrGraphicsBindVertexBuffer(mesh->vbo);
   mesh->vertexData->data.raw = glMapBufferRange(GL_ARRAY_BUFFER, start * stride, count * stride, access);
+  lovrGraphicsCount(STAT_BUFFER_BYTES, write ? count * stride : 0);
   return mesh->vertexData->data;
 #endif
 }
@@ -264,6 +266,7 @@ void lovrMeshUnmap(Mesh* mesh) {
   size_t start = mesh->mapStart * stride;
   size_t count = mesh->mapCount * stride;
   glBufferSubData(GL_ARRAY_BUFFER, start, count, mesh->vertexData->data.bytes + start);
+  lovrGraphicsCount(STAT_BUFFER_BYTES, count);
 #else
   glUnmapBuffer(GL_ARRAY_BUFFER);
 #endif
@@ -279,6 +279,10 @@ void lovrShaderBind(Shader* shader) {
     int count = uniform->count;
     void* data = uniform->value.data;
 
+    if (uniform->type != UNIFORM_SAMPLER) {
+      lovrGraphicsCount(STAT_UNIFORM_UPLOADS, 1);
+    }
+
     switch (uniform->type) {
       case UNIFORM_FLOAT:
         switch (uniform->components) {
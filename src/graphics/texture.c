@@ -149,10 +149,12 @@ void lovrTextureReplacePixels(Texture* texture, TextureData* textureData, int sl
         case TEXTURE_2D:
         case TEXTURE_CUBE:
           glCompressedTexImage2D(binding, i, glInternalFormat, m.width, m.height, 0, m.size, m.data);
+          lovrGraphicsCount(STAT_TEXTURE_BYTES, m.size);
           break;
         case TEXTURE_ARRAY:
         case TEXTURE_VOLUME:
           glCompressedTexSubImage3D(binding, i, 0, 0, slice, m.width, m.height, 1, glInternalFormat, m.size, m.data);
+          lovrGraphicsCount(STAT_TEXTURE_BYTES, m.size);
           break;
       }
     }
@@ -168,6 +170,9 @@ void lovrTextureReplacePixels(Texture* texture, TextureData* textureData, int sl
         break;
     }
 
+    int components = textureData->format == FORMAT_RGB ? 3 : 4;
+    lovrGraphicsCount(STAT_TEXTURE_BYTES, textureData->width * textureData->height * components);
+
     if (texture->mipmaps) {
       glGenerateMipmap(texture->type);
     }
@@ -11,6 +11,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Eye separation used when rendering in stereo, in meters
+#define FAKE_IPD .064f
+
 typedef struct {
   bool initialized;
   HeadsetType type;
@@ -30,6 +33,7 @@ typedef struct {
   float orientation[4];
   float projection[16];
   float transform[16];
+  uint64_t poseTime;
 
   GLFWwindow* hookedWindow;
 
@@ -309,12 +313,30 @@ static ModelData* fakeControllerNewModelData(Controller* controller) {
   return NULL;
 }
 
+// Builds the head transform from the position and the mouselook angles, which is when the pose is
+// sampled
+static void fakeSamplePose() {
+  mat4_identity(state.transform);
+  mat4_translate(state.transform, state.pos[0], state.pos[1], state.pos[2]);
+  mat4_rotate(state.transform, state.yaw, 0,1,0);
+  mat4_rotate(state.transform, state.pitch, 1,0,0);
+  state.poseTime = lovrGetTicks();
+}
+
 static void fakeRenderTo(headsetRenderCallback callback, void* userdata) {
   GLFWwindow* window = glfwGetCurrentContext();
   if (!window) {
     return;
   }
 
+  // Sample again right before the view matrix is built, picking up mouse movement since update
+  if (state.mouselook) {
+    double x, y;
+    glfwGetCursorPos(window, &x, &y);
+    cursor_position_callback(window, x, y);
+  }
+  fakeSamplePose();
+
   int w, h;
   glfwGetFramebufferSize(window, &w, &h);
   mat4_perspective(state.projection, state.clipNear, state.clipFar, 67 * M_PI / 180.0, (float) w / h);
@@ -324,6 +346,25 @@ static void fakeRenderTo(headsetRenderCallback callback, void* userdata) {
   mat4_invert(transform);
 
   int viewport[4] = { 0, 0, w, h };
+
+  // Single pass stereo renders both eyes side by side in the window
+  if (lovrHeadsetGetStereoMode() == STEREO_SINGLEPASS) {
+    float projections[32], offsets[32];
+    for (int eye = 0; eye < 2; eye++) {
+      mat4_perspective(projections + 16 * eye, state.clipNear, state.clipFar, 67 * M_PI / 180.0, (float) w / 2 / h);
+      mat4_translate(mat4_identity(offsets + 16 * eye), eye == EYE_LEFT ? FAKE_IPD / 2 : -FAKE_IPD / 2, 0, 0);
+    }
+
+    lovrGraphicsPushStereoDisplay(0, projections, offsets, viewport);
+    lovrGraphicsPush();
+    lovrGraphicsMatrixTransform(MATRIX_VIEW, transform);
+    lovrGraphicsClear(true, true, true, lovrGraphicsGetBackgroundColor(), 1., 0);
+    callback(EYE_BOTH, userdata);
+    lovrGraphicsPop();
+    lovrGraphicsPopDisplay();
+    return;
+  }
+
   lovrGraphicsPushDisplay(0, state.projection, viewport);
   lovrGraphicsPush();
   lovrGraphicsMatrixTransform(MATRIX_VIEW, transform);
@@ -365,11 +406,11 @@ static void fakeUpdate(float dt) {
   mat4_transformDirection(state.transform, v);
   vec3_add(state.pos, v);
 
-  // update transform
-  mat4_identity(state.transform);
-  mat4_translate(state.transform, state.pos[0], state.pos[1], state.pos[2]);
-  mat4_rotate(state.transform, state.yaw, 0,1,0);
-  mat4_rotate(state.transform, state.pitch, 1,0,0);
+  fakeSamplePose();
+}
+
+static uint64_t fakeGetPoseTime() {
+  return state.poseTime;
 }
 
 HeadsetInterface lovrHeadsetFakeDriver = {
@@ -388,6 +429,7 @@ HeadsetInterface lovrHeadsetFakeDriver = {
   fakeGetBoundsDepth,
   fakeGetPose,
   fakeGetEyePose,
+  NULL,
   fakeGetVelocity,
   fakeGetAngularVelocity,
   fakeGetControllers,
@@ -400,5 +442,6 @@ HeadsetInterface lovrHeadsetFakeDriver = {
   fakeControllerVibrate,
   fakeControllerNewModelData,
   fakeRenderTo,
+  fakeGetPoseTime,
   fakeUpdate
 };
@@ -1,8 +1,17 @@
 #include "headset/headset.h"
+#include "headset/recording.h"
 #include "event/event.h"
+#include "graphics/graphics.h"
+#include "math/mat4.h"
+#include "math/quat.h"
+#include "math/vec3.h"
+#include "timer/profiler.h"
+#include <string.h>
 
 static HeadsetInterface* headset = NULL;
 static bool initialized = false;
+static StereoMode stereoMode = STEREO_MULTIPASS;
+static PoseStats poseStats;
 
 void lovrHeadsetInit(HeadsetDriver* drivers, int count) {
   if (initialized) return;
@@ -14,6 +23,7 @@ void lovrHeadsetInit(HeadsetDriver* drivers, int count) {
 
     switch (drivers[i]) {
       case DRIVER_FAKE: interface = &lovrHeadsetFakeDriver; break;
+      case DRIVER_REPLAY: interface = &lovrHeadsetReplayDriver; break;
 #ifndef EMSCRIPTEN
       case DRIVER_OPENVR: interface = &lovrHeadsetOpenVRDriver; break;
 #else
@@ -32,6 +42,7 @@ void lovrHeadsetInit(HeadsetDriver* drivers, int count) {
 void lovrHeadsetDestroy() {
   if (!initialized) return;
   initialized = false;
+  lovrHeadsetStopRecording();
 
   if (headset) {
     headset->destroy();
@@ -59,6 +70,16 @@ bool lovrHeadsetIsMounted() {
   return headset ? headset->isMounted() : false;
 }
 
+// In single pass mode, drivers call the render callback once with EYE_BOTH and a stereo display
+// instead of once per eye.  Drivers that can't do it keep rendering one eye at a time.
+StereoMode lovrHeadsetGetStereoMode() {
+  return stereoMode;
+}
+
+void lovrHeadsetSetStereoMode(StereoMode mode) {
+  stereoMode = lovrGraphicsIsStereoSupported() ? mode : STEREO_MULTIPASS;
+}
+
 bool lovrHeadsetIsMirrored() {
   return headset ? headset->isMirrored() : false;
 }
@@ -118,6 +139,68 @@ void lovrHeadsetGetEyePose(HeadsetEye eye, float* x, float* y, float* z, float*
   headset->getEyePose(eye, x, y, z, angle, ax, ay, az);
 }
 
+// Moves a pose forward in time using the velocity of the headset, for drivers without prediction
+static void lovrHeadsetExtrapolatePose(float time, float* x, float* y, float* z, float* angle, float* ax, float* ay, float* az) {
+  float velocity[3], angularVelocity[3];
+  headset->getVelocity(&velocity[0], &velocity[1], &velocity[2]);
+  headset->getAngularVelocity(&angularVelocity[0], &angularVelocity[1], &angularVelocity[2]);
+
+  *x += velocity[0] * time;
+  *y += velocity[1] * time;
+  *z += velocity[2] * time;
+
+  float speed = vec3_length(angularVelocity);
+  if (speed > 0.f) {
+    float axis[3] = { *ax, *ay, *az };
+    float rotation[4], delta[4];
+    quat_fromAngleAxis(rotation, *angle, axis);
+    quat_fromAngleAxis(delta, speed * time, angularVelocity);
+    quat_normalize(quat_multiply(delta, rotation));
+    quat_getAngleAxis(delta, angle, ax, ay, az);
+  }
+}
+
+void lovrHeadsetGetPredictedPose(float time, float* x, float* y, float* z, float* angle, float* ax, float* ay, float* az) {
+  if (!headset) {
+    *x = *y = *z = *angle = *ax = *ay = *az = 0.f;
+    return;
+  }
+
+  if (headset->getPredictedPose) {
+    headset->getPredictedPose(time, x, y, z, angle, ax, ay, az);
+  } else {
+    headset->getPose(x, y, z, angle, ax, ay, az);
+    lovrHeadsetExtrapolatePose(time, x, y, z, angle, ax, ay, az);
+  }
+}
+
+// The eye's offset from the head is taken from the current poses and applied to the predicted head
+void lovrHeadsetGetPredictedEyePose(HeadsetEye eye, float time, float* x, float* y, float* z, float* angle, float* ax, float* ay, float* az) {
+  if (!headset) {
+    *x = *y = *z = *angle = *ax = *ay = *az = 0.f;
+    return;
+  }
+
+  float head[16], eyeTransform[16], predicted[16];
+  headset->getPose(x, y, z, angle, ax, ay, az);
+  mat4_setTransform(head, *x, *y, *z, 1.f, 1.f, 1.f, *angle, *ax, *ay, *az);
+  headset->getEyePose(eye, x, y, z, angle, ax, ay, az);
+  mat4_setTransform(eyeTransform, *x, *y, *z, 1.f, 1.f, 1.f, *angle, *ax, *ay, *az);
+  float* offset = mat4_multiply(mat4_invert(head), eyeTransform);
+
+  lovrHeadsetGetPredictedPose(time, x, y, z, angle, ax, ay, az);
+  mat4_setTransform(predicted, *x, *y, *z, 1.f, 1.f, 1.f, *angle, *ax, *ay, *az);
+  mat4_multiply(predicted, offset);
+
+  *x = predicted[12];
+  *y = predicted[13];
+  *z = predicted[14];
+
+  float rotation[4];
+  quat_fromMat4(rotation, predicted);
+  quat_getAngleAxis(rotation, angle, ax, ay, az);
+}
+
 void lovrHeadsetGetVelocity(float* x, float* y, float* z) {
   if (!headset) {
     *x = *y = *z = 0.f;
@@ -201,14 +284,66 @@ ModelData* lovrHeadsetControllerNewModelData(Controller* controller) {
   }
 }
 
+typedef struct {
+  headsetRenderCallback callback;
+  void* userdata;
+  bool profile;
+  uint64_t poseTime;
+} HeadsetRender;
+
+// For drivers that don't report when their render pose was sampled, the first callback is the
+// closest thing, since drivers sample right before pushing the display and calling back
+static void lovrHeadsetRenderEye(HeadsetEye eye, void* userdata) {
+  HeadsetRender* render = userdata;
+
+  if (!render->poseTime) {
+    render->poseTime = lovrGetTicks();
+  }
+
+  if (render->profile) {
+    const char* name = eye == EYE_LEFT ? "left eye" : (eye == EYE_RIGHT ? "right eye" : "both eyes");
+    lovrProfilerPush(name);
+    lovrGraphicsPushTimer(name);
+    render->callback(eye, render->userdata);
+    lovrGraphicsPopTimer();
+    lovrProfilerPop();
+  } else {
+    render->callback(eye, render->userdata);
+  }
+}
+
 void lovrHeadsetRenderTo(headsetRenderCallback callback, void* userdata) {
-  if (headset) {
-    headset->renderTo(callback, userdata);
+  if (!headset) {
+    return;
   }
+
+  HeadsetRender render = { callback, userdata, lovrProfilerIsEnabled(), 0 };
+  headset->renderTo(lovrHeadsetRenderEye, &render);
+
+  // Drivers submit before returning, so this is how old the pose was when the frame was submitted
+  uint64_t poseTime = headset->getPoseTime ? headset->getPoseTime() : render.poseTime;
+  if (poseTime) {
+    double age = (lovrGetTicks() - poseTime) / 1e9;
+    poseStats.frames++;
+    poseStats.age = age;
+    poseStats.averageAge += (age - poseStats.averageAge) / poseStats.frames;
+    poseStats.maxAge = MAX(poseStats.maxAge, age);
+  }
+}
+
+PoseStats* lovrHeadsetGetPoseStats() {
+  return &poseStats;
+}
+
+void lovrHeadsetResetPoseStats() {
+  memset(&poseStats, 0, sizeof(PoseStats));
 }
 
 void lovrHeadsetUpdate(float dt) {
   if (headset && headset->update) {
+    lovrProfilerPush("headset");
     headset->update(dt);
+    lovrHeadsetRecordFrame(dt);
+    lovrProfilerPop();
   }
 }
@@ -7,9 +7,15 @@
 
 typedef enum {
   EYE_LEFT,
-  EYE_RIGHT
+  EYE_RIGHT,
+  EYE_BOTH
 } HeadsetEye;
 
+typedef enum {
+  STEREO_MULTIPASS,
+  STEREO_SINGLEPASS
+} StereoMode;
+
 typedef enum {
   ORIGIN_HEAD,
   ORIGIN_FLOOR
@@ -18,6 +24,7 @@ typedef enum {
 typedef enum {
   DRIVER_FAKE,
   DRIVER_OPENVR,
+  DRIVER_REPLAY,
   DRIVER_WEBVR
 } HeadsetDriver;
 
@@ -61,6 +68,14 @@ typedef struct {
   unsigned int id;
 } Controller;
 
+// Age of the pose used for rendering when the frame was submitted, in seconds
+typedef struct {
+  double age;
+  double averageAge;
+  double maxAge;
+  uint64_t frames;
+} PoseStats;
+
 typedef vec_t(Controller*) vec_controller_t;
 typedef void (*headsetRenderCallback)(HeadsetEye eye, void* userdata);
 
@@ -80,6 +95,7 @@ typedef struct {
   float (*getBoundsDepth)();
   void (*getPose)(float* x, float* y, float* z, float* angle, float* ax, float* ay, float* az);
   void (*getEyePose)(HeadsetEye eye, float* x, float* y, float* z, float* angle, float* ax, float* ay, float* az);
+  void (*getPredictedPose)(float time, float* x, float* y, float* z, float* angle, float* ax, float* ay, float* az);
   void (*getVelocity)(float* x, float* y, float* z);
   void (*getAngularVelocity)(float* x, float* y, float* z);
   vec_controller_t* (*getControllers)();
@@ -92,6 +108,7 @@ typedef struct {
   void (*controllerVibrate)(Controller* controller, float duration, float power);
   ModelData* (*controllerNewModelData)(Controller* controller);
   void (*renderTo)(headsetRenderCallback callback, void* userdata);
+  uint64_t (*getPoseTime)();
   void (*update)(float dt);
 } HeadsetInterface;
 
@@ -99,6 +116,7 @@ typedef struct {
 extern HeadsetInterface lovrHeadsetOpenVRDriver;
 extern HeadsetInterface lovrHeadsetWebVRDriver;
 extern HeadsetInterface lovrHeadsetFakeDriver;
+extern HeadsetInterface lovrHeadsetReplayDriver;
 
 void lovrHeadsetInit(HeadsetDriver* drivers, int count);
 void lovrHeadsetDestroy();
@@ -108,6 +126,8 @@ HeadsetOrigin lovrHeadsetGetOriginType();
 bool lovrHeadsetIsMounted();
 bool lovrHeadsetIsMirrored();
 void lovrHeadsetSetMirrored(bool mirror);
+StereoMode lovrHeadsetGetStereoMode();
+void lovrHeadsetSetStereoMode(StereoMode mode);
 void lovrHeadsetGetDisplayDimensions(int* width, int* height);
 void lovrHeadsetGetClipDistance(float* clipNear, float* clipFar);
 void lovrHeadsetSetClipDistance(float clipNear, float clipFar);
@@ -115,6 +135,8 @@ float lovrHeadsetGetBoundsWidth();
 float lovrHeadsetGetBoundsDepth();
 void lovrHeadsetGetPose(float* x, float* y, float* z, float* angle, float* ax, float* ay, float* az);
 void lovrHeadsetGetEyePose(HeadsetEye eye, float* x, float* y, float* z, float* angle, float* ax, float* ay, float* az);
+void lovrHeadsetGetPredictedPose(float time, float* x, float* y, float* z, float* angle, float* ax, float* ay, float* az);
+void lovrHeadsetGetPredictedEyePose(HeadsetEye eye, float time, float* x, float* y, float* z, float* angle, float* ax, float* ay, float* az);
 void lovrHeadsetGetVelocity(float* x, float* y, float* z);
 void lovrHeadsetGetAngularVelocity(float* x, float* y, float* z);
 vec_controller_t* lovrHeadsetGetControllers();
@@ -127,4 +149,6 @@ bool lovrHeadsetControllerIsTouched(Controller* controller, ControllerButton but
 void lovrHeadsetControllerVibrate(Controller* controller, float duration, float power);
 ModelData* lovrHeadsetControllerNewModelData(Controller* controller);
 void lovrHeadsetRenderTo(headsetRenderCallback callback, void* userdata);
+PoseStats* lovrHeadsetGetPoseStats();
+void lovrHeadsetResetPoseStats();
 void lovrHeadsetUpdate(float dt);
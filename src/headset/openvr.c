@@ -34,6 +34,7 @@ typedef struct {
   HeadsetType type;
 
   TrackedDevicePose_t renderPoses[16];
+  uint64_t renderPoseTime;
   RenderModel_t* deviceModels[16];
   RenderModel_TextureMap_t* deviceTextures[16];
 
@@ -48,6 +49,7 @@ typedef struct {
   float vsyncToPhotons;
 
   Canvas* canvas;
+  bool canvasStereo;
 } HeadsetState;
 
 static HeadsetState state;
@@ -222,8 +224,9 @@ static void openvrPoll() {
   }
 }
 
-static TrackedDevicePose_t getPose(unsigned int deviceIndex) {
-  if (state.isRendering) {
+// Poses are predicted to when the next frame reaches the display, plus an optional offset
+static TrackedDevicePose_t getPredictedPose(unsigned int deviceIndex, float offset) {
+  if (state.isRendering && offset == 0.f) {
     return state.renderPoses[deviceIndex];
   }
 
@@ -231,22 +234,33 @@ static TrackedDevicePose_t getPose(unsigned int deviceIndex) {
   float timeSinceVsync;
   state.system->GetTimeSinceLastVsync(&timeSinceVsync, NULL);
   float frameDuration = 1.f / state.refreshRate;
-  float secondsInFuture = frameDuration - timeSinceVsync + state.vsyncToPhotons;
+  float secondsInFuture = frameDuration - timeSinceVsync + state.vsyncToPhotons + offset;
   TrackedDevicePose_t poses[16];
   state.system->GetDeviceToAbsoluteTrackingPose(origin, secondsInFuture, poses, 16);
   return poses[deviceIndex];
 }
 
-static void ensureCanvas() {
-  if (state.canvas) {
+static TrackedDevicePose_t getPose(unsigned int deviceIndex) {
+  return getPredictedPose(deviceIndex, 0.f);
+}
+
+// In single pass stereo the canvas is twice as wide and holds both eyes side by side
+static void ensureCanvas(bool stereo) {
+  if (state.canvas && state.canvasStereo == stereo) {
     return;
   }
 
+  if (state.canvas) {
+    lovrRelease(&state.canvas->texture);
+  }
+
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
   int msaa = 0;
   glGetIntegerv(GL_SAMPLES, &msaa);
   state.system->GetRecommendedRenderTargetSize(&state.renderWidth, &state.renderHeight);
-  state.canvas = lovrCanvasCreate(state.renderWidth, state.renderHeight, FORMAT_RGB, msaa, true, true);
+  int width = stereo ? 2 * state.renderWidth : state.renderWidth;
+  state.canvas = lovrCanvasCreate(width, state.renderHeight, FORMAT_RGB, msaa, true, true);
+  state.canvasStereo = stereo;
 }
 
 static bool openvrInit() {
@@ -448,6 +462,26 @@ static void openvrGetEyePose(HeadsetEye eye, float* x, float* y, float* z, float
   quat_getAngleAxis(rotation, angle, ax, ay, az);
 }
 
+static void openvrGetPredictedPose(float time, float* x, float* y, float* z, float* angle, float* ax, float* ay, float* az) {
+  TrackedDevicePose_t pose = getPredictedPose(state.headsetIndex, time);
+
+  if (!pose.bPoseIsValid || !pose.bDeviceIsConnected) {
+    *x = *y = *z = *angle = *ax = *ay = *az = 0.f;
+    return;
+  }
+
+  float transform[16];
+  mat4_fromMat44(transform, pose.mDeviceToAbsoluteTracking.m);
+
+  *x = transform[12];
+  *y = transform[13];
+  *z = transform[14];
+
+  float rotation[4];
+  quat_fromMat4(rotation, transform);
+  quat_getAngleAxis(rotation, angle, ax, ay, az);
+}
+
 static void openvrGetVelocity(float* x, float* y, float* z) {
   TrackedDevicePose_t pose = getPose(state.headsetIndex);
 
@@ -668,55 +702,73 @@ static ModelData* openvrControllerNewModelData(Controller* controller) {
   return modelData;
 }
 
+static void openvrSubmit(EVREye vrEye, VRTextureBounds_t* bounds) {
+
+  // OpenVR changes the OpenGL texture binding, so we reset it after submitting
+  glActiveTexture(GL_TEXTURE0);
+  Texture* oldTexture = lovrGraphicsGetTexture(0);
+
+  uintptr_t texture = (uintptr_t) state.canvas->texture.id;
+  ETextureType textureType = ETextureType_TextureType_OpenGL;
+  EColorSpace colorSpace = lovrGraphicsIsGammaCorrect() ? EColorSpace_ColorSpace_Linear : EColorSpace_ColorSpace_Gamma;
+  Texture_t eyeTexture = { (void*) texture, textureType, colorSpace };
+  EVRSubmitFlags flags = EVRSubmitFlags_Submit_Default;
+  state.compositor->Submit(vrEye, &eyeTexture, bounds, flags);
+
+  glBindTexture(GL_TEXTURE_2D, oldTexture->id);
+}
+
 static void openvrRenderTo(headsetRenderCallback callback, void* userdata) {
-  ensureCanvas();
+  bool singlePass = lovrHeadsetGetStereoMode() == STEREO_SINGLEPASS;
+  ensureCanvas(singlePass);
 
-  float head[16], transform[16], projection[16];
+  float head[16], transform[16], offsets[32], projections[32];
   float (*matrix)[4];
 
   state.isRendering = true;
   state.compositor->WaitGetPoses(state.renderPoses, 16, NULL, 0);
+  state.renderPoseTime = lovrGetTicks();
 
   // Head transform
   matrix = state.renderPoses[state.headsetIndex].mDeviceToAbsoluteTracking.m;
   mat4_invert(mat4_fromMat34(head, matrix));
 
+  // Eye transforms and projections
   for (HeadsetEye eye = EYE_LEFT; eye <= EYE_RIGHT; eye++) {
-
-    // Eye transform
     EVREye vrEye = (eye == EYE_LEFT) ? EVREye_Eye_Left : EVREye_Eye_Right;
     matrix = state.system->GetEyeToHeadTransform(vrEye).m;
-    mat4_invert(mat4_fromMat34(transform, matrix));
-    mat4_multiply(transform, head);
-
-    // Projection
+    mat4_invert(mat4_fromMat34(offsets + 16 * eye, matrix));
     matrix = state.system->GetProjectionMatrix(vrEye, state.clipNear, state.clipFar).m;
-    mat4_fromMat44(projection, matrix);
+    mat4_fromMat44(projections + 16 * eye, matrix);
+  }
 
-    // Render
-    int viewport[4] = { 0, 0, state.canvas->texture.width, state.canvas->texture.height };
-    lovrGraphicsPushDisplay(state.canvas->framebuffer, projection, viewport);
+  int viewport[4] = { 0, 0, state.canvas->texture.width, state.canvas->texture.height };
+
+  if (singlePass) {
+    lovrGraphicsPushStereoDisplay(state.canvas->framebuffer, projections, offsets, viewport);
     lovrGraphicsPush();
-    lovrGraphicsMatrixTransform(MATRIX_VIEW, transform);
+    lovrGraphicsMatrixTransform(MATRIX_VIEW, head);
     lovrGraphicsClear(true, true, false, lovrGraphicsGetBackgroundColor(), 1., 0);
-    callback(eye, userdata);
+    callback(EYE_BOTH, userdata);
     lovrGraphicsPop();
     lovrGraphicsPopDisplay();
 
-    // OpenVR changes the OpenGL texture binding, so we reset it after rendering
-    glActiveTexture(GL_TEXTURE0);
-    Texture* oldTexture = lovrGraphicsGetTexture(0);
-
-    // Submit
-    uintptr_t texture = (uintptr_t) state.canvas->texture.id;
-    ETextureType textureType = ETextureType_TextureType_OpenGL;
-    EColorSpace colorSpace = lovrGraphicsIsGammaCorrect() ? EColorSpace_ColorSpace_Linear : EColorSpace_ColorSpace_Gamma;
-    Texture_t eyeTexture = { (void*) texture, textureType, colorSpace };
-    EVRSubmitFlags flags = EVRSubmitFlags_Submit_Default;
-    state.compositor->Submit(vrEye, &eyeTexture, NULL, flags);
-
-    // Reset to the correct texture
-    glBindTexture(GL_TEXTURE_2D, oldTexture->id);
+    VRTextureBounds_t left = { 0.f, 0.f, .5f, 1.f };
+    VRTextureBounds_t right = { .5f, 0.f, 1.f, 1.f };
+    openvrSubmit(EVREye_Eye_Left, &left);
+    openvrSubmit(EVREye_Eye_Right, &right);
+  } else {
+    for (HeadsetEye eye = EYE_LEFT; eye <= EYE_RIGHT; eye++) {
+      mat4_multiply(mat4_set(transform, offsets + 16 * eye), head);
+      lovrGraphicsPushDisplay(state.canvas->framebuffer, projections + 16 * eye, viewport);
+      lovrGraphicsPush();
+      lovrGraphicsMatrixTransform(MATRIX_VIEW, transform);
+      lovrGraphicsClear(true, true, false, lovrGraphicsGetBackgroundColor(), 1., 0);
+      callback(eye, userdata);
+      lovrGraphicsPop();
+      lovrGraphicsPopDisplay();
+      openvrSubmit(eye == EYE_LEFT ? EVREye_Eye_Left : EVREye_Eye_Right, NULL);
+    }
   }
 
   state.isRendering = false;
@@ -727,13 +779,17 @@ static void openvrRenderTo(headsetRenderCallback callback, void* userdata) {
     Shader* lastShader = lovrGraphicsGetShader();
     lovrRetain(lastShader);
     lovrGraphicsSetShader(NULL);
-    lovrGraphicsPlaneFullscreen(&state.canvas->texture);
+    lovrGraphicsPlaneFullscreen(&state.canvas->texture, state.canvasStereo ? .5f : 1.f);
     lovrGraphicsSetShader(lastShader);
     lovrRelease(lastShader);
     lovrGraphicsSetColor(oldColor);
   }
 }
 
+static uint64_t openvrGetPoseTime() {
+  return state.renderPoseTime;
+}
+
 HeadsetInterface lovrHeadsetOpenVRDriver = {
   DRIVER_OPENVR,
   openvrInit,
@@ -750,6 +806,7 @@ HeadsetInterface lovrHeadsetOpenVRDriver = {
   openvrGetBoundsDepth,
   openvrGetPose,
   openvrGetEyePose,
+  openvrGetPredictedPose,
   openvrGetVelocity,
   openvrGetAngularVelocity,
   openvrGetControllers,
@@ -762,5 +819,6 @@ HeadsetInterface lovrHeadsetOpenVRDriver = {
   openvrControllerVibrate,
   openvrControllerNewModelData,
   openvrRenderTo,
+  openvrGetPoseTime,
   NULL
 };
@@ -0,0 +1,108 @@
+#include "headset/recording.h"
+#include "filesystem/filesystem.h"
+#include "math/math.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  bool active;
+  char* path;
+  char* data;
+  size_t size;
+  size_t capacity;
+} RecordingState;
+
+static RecordingState state;
+
+static void lovrHeadsetRecordingAppend(const void* data, size_t size) {
+  if (state.size + size > state.capacity) {
+    state.capacity = MAX(2 * state.capacity, state.size + size);
+    state.data = realloc(state.data, state.capacity);
+    lovrAssert(state.data, "Out of memory");
+  }
+
+  memcpy(state.data + state.size, data, size);
+  state.size += size;
+}
+
+static void lovrHeadsetRecordingFlush(bool append) {
+  size_t bytesWritten = lovrFilesystemWrite(state.path, state.data, state.size, append);
+  lovrAssert(bytesWritten == state.size, "Could not write headset recording '%s'", state.path);
+  state.size = 0;
+}
+
+void lovrHeadsetStartRecording(const char* path) {
+  lovrAssert(!state.active, "The headset is already being recorded");
+
+  RecordingHeader header = {
+    .magic = RECORDING_MAGIC,
+    .version = RECORDING_VERSION,
+    .type = lovrHeadsetGetType(),
+    .origin = lovrHeadsetGetOriginType(),
+    .boundsWidth = lovrHeadsetGetBoundsWidth(),
+    .boundsDepth = lovrHeadsetGetBoundsDepth()
+  };
+
+  state.path = strdup(path);
+  state.size = 0;
+  lovrHeadsetRecordingAppend(&header, sizeof(RecordingHeader));
+  lovrHeadsetRecordingFlush(false);
+  state.active = true;
+}
+
+void lovrHeadsetStopRecording() {
+  if (!state.active) return;
+  lovrHeadsetRecordingFlush(true);
+  free(state.path);
+  free(state.data);
+  memset(&state, 0, sizeof(RecordingState));
+}
+
+bool lovrHeadsetIsRecording() {
+  return state.active;
+}
+
+// Frames are buffered and written in chunks so recording doesn't touch the disk every frame
+void lovrHeadsetRecordFrame(float dt) {
+  if (!state.active) return;
+
+  RecordedFrame frame;
+  float* p = frame.pose;
+  frame.dt = dt;
+  lovrHeadsetGetPose(&p[0], &p[1], &p[2], &p[3], &p[4], &p[5], &p[6]);
+  lovrHeadsetGetVelocity(&frame.velocity[0], &frame.velocity[1], &frame.velocity[2]);
+  lovrHeadsetGetAngularVelocity(&frame.angularVelocity[0], &frame.angularVelocity[1], &frame.angularVelocity[2]);
+
+  vec_controller_t* controllers = lovrHeadsetGetControllers();
+  frame.controllerCount = controllers ? MIN(controllers->length, MAX_RECORDED_CONTROLLERS) : 0;
+  lovrHeadsetRecordingAppend(&frame, sizeof(RecordedFrame));
+
+  for (uint32_t i = 0; i < frame.controllerCount; i++) {
+    Controller* controller = controllers->data[i];
+    RecordedController recorded;
+    memset(&recorded, 0, sizeof(RecordedController));
+    p = recorded.pose;
+    recorded.hand = lovrHeadsetControllerGetHand(controller);
+    lovrHeadsetControllerGetPose(controller, &p[0], &p[1], &p[2], &p[3], &p[4], &p[5], &p[6]);
+
+    for (ControllerAxis axis = CONTROLLER_AXIS_TRIGGER; axis <= CONTROLLER_AXIS_TOUCHPAD_Y; axis++) {
+      recorded.axes[axis] = lovrHeadsetControllerGetAxis(controller, axis);
+    }
+
+    for (ControllerButton button = CONTROLLER_BUTTON_SYSTEM; button <= CONTROLLER_BUTTON_Y; button++) {
+      if (lovrHeadsetControllerIsDown(controller, button)) {
+        recorded.buttons |= 1u << button;
+      }
+
+      if (lovrHeadsetControllerIsTouched(controller, button)) {
+        recorded.touches |= 1u << button;
+      }
+    }
+
+    lovrHeadsetRecordingAppend(&recorded, sizeof(RecordedController));
+  }
+
+  if (state.size >= RECORDING_FLUSH_SIZE) {
+    lovrHeadsetRecordingFlush(true);
+  }
+}
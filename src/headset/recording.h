@@ -0,0 +1,43 @@
+#include "headset/headset.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#pragma once
+
+#define RECORDING_MAGIC 0x5052564c
+#define RECORDING_VERSION 1
+#define RECORDING_FLUSH_SIZE 65536
+#define MAX_RECORDED_CONTROLLERS 4
+
+// A recording is a header followed by one frame per headset update, where each frame is followed
+// by its controllers.  Every field is 4 bytes wide so the structs can be read in place.
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t type;
+  uint32_t origin;
+  float boundsWidth;
+  float boundsDepth;
+} RecordingHeader;
+
+typedef struct {
+  float dt;
+  float pose[7];
+  float velocity[3];
+  float angularVelocity[3];
+  uint32_t controllerCount;
+} RecordedFrame;
+
+typedef struct {
+  uint32_t hand;
+  uint32_t buttons;
+  uint32_t touches;
+  float pose[7];
+  float axes[4];
+} RecordedController;
+
+void lovrHeadsetStartRecording(const char* path);
+void lovrHeadsetStopRecording();
+bool lovrHeadsetIsRecording();
+void lovrHeadsetRecordFrame(float dt);
+void lovrHeadsetSetReplayPath(const char* path);
@@ -0,0 +1,382 @@
+#include "headset/headset.h"
+#include "headset/recording.h"
+#include "event/event.h"
+#include "filesystem/filesystem.h"
+#include "graphics/graphics.h"
+#include "math/mat4.h"
+#include "math/math.h"
+#include "timer/timer.h"
+#include "util.h"
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Eye separation used when rendering in stereo, in meters
+#define REPLAY_IPD .064f
+
+typedef vec_t(RecordedFrame*) vec_frame_t;
+
+typedef struct {
+  bool initialized;
+  char* data;
+  RecordingHeader* header;
+  vec_frame_t frames;
+  int frame;
+  vec_controller_t controllers;
+  float clipNear;
+  float clipFar;
+  double fixedDelta;
+  uint64_t poseTime;
+} ReplayState;
+
+static ReplayState state;
+static char* replayPath = NULL;
+
+void lovrHeadsetSetReplayPath(const char* path) {
+  free(replayPath);
+  replayPath = path ? strdup(path) : NULL;
+}
+
+// Before the first update the first frame is shown, after the last one the replay starts over
+static RecordedFrame* replayGetFrame() {
+  return state.frames.data[MAX(state.frame, 0)];
+}
+
+static RecordedController* replayGetController(RecordedFrame* frame, Controller* controller) {
+  if (!controller || controller->id >= frame->controllerCount) {
+    return NULL;
+  }
+
+  return (RecordedController*) (frame + 1) + controller->id;
+}
+
+static bool replayInit() {
+  if (state.initialized) return true;
+  if (!replayPath) return false;
+
+  size_t size;
+  char* data = lovrFilesystemRead(replayPath, &size);
+  lovrAssert(data, "Could not read headset recording '%s'", replayPath);
+
+  RecordingHeader* header = (RecordingHeader*) data;
+  if (size < sizeof(RecordingHeader) || header->magic != RECORDING_MAGIC || header->version != RECORDING_VERSION) {
+    free(data);
+    lovrThrow("'%s' is not a headset recording", replayPath);
+  }
+
+  // A recording that was interrupted can end with a partial frame, which is ignored
+  vec_init(&state.frames);
+  uint32_t controllerCount = 0;
+  size_t offset = sizeof(RecordingHeader);
+  while (offset + sizeof(RecordedFrame) <= size) {
+    RecordedFrame* frame = (RecordedFrame*) (data + offset);
+    size_t next = offset + sizeof(RecordedFrame) + frame->controllerCount * sizeof(RecordedController);
+    if (frame->controllerCount > MAX_RECORDED_CONTROLLERS || next > size) {
+      break;
+    }
+
+    vec_push(&state.frames, frame);
+    controllerCount = MAX(controllerCount, frame->controllerCount);
+    offset = next;
+  }
+
+  if (state.frames.length == 0) {
+    vec_deinit(&state.frames);
+    free(data);
+    lovrThrow("Headset recording '%s' has no frames", replayPath);
+  }
+
+  vec_init(&state.controllers);
+  for (uint32_t i = 0; i < controllerCount; i++) {
+    Controller* controller = lovrAlloc(sizeof(Controller), free);
+    controller->id = i;
+    vec_push(&state.controllers, controller);
+  }
+
+  state.data = data;
+  state.header = header;
+  state.frame = -1;
+  state.clipNear = 0.1f;
+  state.clipFar = 100.f;
+
+  // Each step gets the dt its frame was recorded with, the timer's own fixed delta comes back after
+  state.fixedDelta = lovrTimerGetFixedDelta();
+  lovrTimerSetFixedDelta(state.frames.data[0]->dt);
+
+  state.initialized = true;
+  return true;
+}
+
+static void replayDestroy() {
+  if (!state.initialized) return;
+
+  int i;
+  Controller* controller;
+  vec_foreach(&state.controllers, controller, i) {
+    lovrRelease(controller);
+  }
+  vec_deinit(&state.controllers);
+  vec_deinit(&state.frames);
+  free(state.data);
+  lovrTimerSetFixedDelta(state.fixedDelta);
+  memset(&state, 0, sizeof(ReplayState));
+}
+
+static HeadsetType replayGetType() {
+  return state.header->type;
+}
+
+static HeadsetOrigin replayGetOriginType() {
+  return state.header->origin;
+}
+
+static bool replayIsMounted() {
+  return true;
+}
+
+static bool replayIsMirrored() {
+  return true;
+}
+
+static void replaySetMirrored(bool mirror) {
+  //
+}
+
+static void replayGetDisplayDimensions(int* width, int* height) {
+  GLFWwindow* window = glfwGetCurrentContext();
+  if (window) {
+    glfwGetFramebufferSize(window, width, height);
+  }
+}
+
+static void replayGetClipDistance(float* clipNear, float* clipFar) {
+  *clipNear = state.clipNear;
+  *clipFar = state.clipFar;
+}
+
+static void replaySetClipDistance(float clipNear, float clipFar) {
+  state.clipNear = clipNear;
+  state.clipFar = clipFar;
+}
+
+static float replayGetBoundsWidth() {
+  return state.header->boundsWidth;
+}
+
+static float replayGetBoundsDepth() {
+  return state.header->boundsDepth;
+}
+
+static void replayGetPose(float* x, float* y, float* z, float* angle, float* ax, float* ay, float* az) {
+  float* pose = replayGetFrame()->pose;
+  *x = pose[0];
+  *y = pose[1];
+  *z = pose[2];
+  *angle = pose[3];
+  *ax = pose[4];
+  *ay = pose[5];
+  *az = pose[6];
+}
+
+static void replayGetEyePose(HeadsetEye eye, float* x, float* y, float* z, float* angle, float* ax, float* ay, float* az) {
+  replayGetPose(x, y, z, angle, ax, ay, az);
+}
+
+static void replayGetVelocity(float* x, float* y, float* z) {
+  float* velocity = replayGetFrame()->velocity;
+  *x = velocity[0];
+  *y = velocity[1];
+  *z = velocity[2];
+}
+
+static void replayGetAngularVelocity(float* x, float* y, float* z) {
+  float* angularVelocity = replayGetFrame()->angularVelocity;
+  *x = angularVelocity[0];
+  *y = angularVelocity[1];
+  *z = angularVelocity[2];
+}
+
+static vec_controller_t* replayGetControllers() {
+  return &state.controllers;
+}
+
+static bool replayControllerIsConnected(Controller* controller) {
+  return replayGetController(replayGetFrame(), controller) != NULL;
+}
+
+static ControllerHand replayControllerGetHand(Controller* controller) {
+  RecordedController* recorded = replayGetController(replayGetFrame(), controller);
+  return recorded ? recorded->hand : HAND_UNKNOWN;
+}
+
+static void replayControllerGetPose(Controller* controller, float* x, float* y, float* z, float* angle, float* ax, float* ay, float* az) {
+  RecordedController* recorded = replayGetController(replayGetFrame(), controller);
+  if (!recorded) {
+    *x = *y = *z = *angle = *ax = *ay = *az = 0.f;
+    return;
+  }
+
+  float* pose = recorded->pose;
+  *x = pose[0];
+  *y = pose[1];
+  *z = pose[2];
+  *angle = pose[3];
+  *ax = pose[4];
+  *ay = pose[5];
+  *az = pose[6];
+}
+
+static float replayControllerGetAxis(Controller* controller, ControllerAxis axis) {
+  RecordedController* recorded = replayGetController(replayGetFrame(), controller);
+  return recorded ? recorded->axes[axis] : 0.f;
+}
+
+static bool replayControllerIsDown(Controller* controller, ControllerButton button) {
+  RecordedController* recorded = replayGetController(replayGetFrame(), controller);
+  return recorded ? recorded->buttons & (1u << button) : false;
+}
+
+static bool replayControllerIsTouched(Controller* controller, ControllerButton button) {
+  RecordedController* recorded = replayGetController(replayGetFrame(), controller);
+  return recorded ? recorded->touches & (1u << button) : false;
+}
+
+static void replayControllerVibrate(Controller* controller, float duration, float power) {
+  //
+}
+
+static ModelData* replayControllerNewModelData(Controller* controller) {
+  return NULL;
+}
+
+static void replayRenderTo(headsetRenderCallback callback, void* userdata) {
+  GLFWwindow* window = glfwGetCurrentContext();
+  if (!window) {
+    return;
+  }
+
+  int w, h;
+  glfwGetFramebufferSize(window, &w, &h);
+  int viewport[4] = { 0, 0, w, h };
+
+  // Sample again right before the view matrix is built, moving the recorded pose forward by its
+  // recorded velocity for the time since update
+  uint64_t now = lovrGetTicks();
+  float elapsed = state.poseTime ? (now - state.poseTime) / 1e9f : 0.f;
+  float x, y, z, angle, ax, ay, az;
+  lovrHeadsetGetPredictedPose(elapsed, &x, &y, &z, &angle, &ax, &ay, &az);
+  state.poseTime = now;
+
+  float transform[16];
+  mat4_identity(transform);
+  mat4_translate(transform, x, y, z);
+  mat4_rotate(transform, angle, ax, ay, az);
+  mat4_invert(transform);
+
+  if (lovrHeadsetGetStereoMode() == STEREO_SINGLEPASS) {
+    float projections[32], offsets[32];
+    for (int eye = 0; eye < 2; eye++) {
+      mat4_perspective(projections + 16 * eye, state.clipNear, state.clipFar, 67 * M_PI / 180.0, (float) w / 2 / h);
+      mat4_translate(mat4_identity(offsets + 16 * eye), eye == EYE_LEFT ? REPLAY_IPD / 2 : -REPLAY_IPD / 2, 0, 0);
+    }
+
+    lovrGraphicsPushStereoDisplay(0, projections, offsets, viewport);
+    lovrGraphicsPush();
+    lovrGraphicsMatrixTransform(MATRIX_VIEW, transform);
+    lovrGraphicsClear(true, true, true, lovrGraphicsGetBackgroundColor(), 1., 0);
+    callback(EYE_BOTH, userdata);
+    lovrGraphicsPop();
+    lovrGraphicsPopDisplay();
+    return;
+  }
+
+  float projection[16];
+  mat4_perspective(projection, state.clipNear, state.clipFar, 67 * M_PI / 180.0, (float) w / h);
+  lovrGraphicsPushDisplay(0, projection, viewport);
+  lovrGraphicsPush();
+  lovrGraphicsMatrixTransform(MATRIX_VIEW, transform);
+  lovrGraphicsClear(true, true, true, lovrGraphicsGetBackgroundColor(), 1., 0);
+  callback(EYE_LEFT, userdata);
+  lovrGraphicsPop();
+  lovrGraphicsPopDisplay();
+}
+
+// Pushes the controller events that happened between two frames
+static void replayPushEvents(RecordedFrame* previous, RecordedFrame* frame) {
+  Controller* controller; int i;
+  vec_foreach(&state.controllers, controller, i) {
+    RecordedController* before = replayGetController(previous, controller);
+    RecordedController* after = replayGetController(frame, controller);
+
+    if (!before && after) {
+      Event event = { .type = EVENT_CONTROLLER_ADDED, .data = { .controlleradded = { controller } } };
+      lovrRetain(controller);
+      lovrEventPush(event);
+    } else if (before && !after) {
+      Event event = { .type = EVENT_CONTROLLER_REMOVED, .data = { .controllerremoved = { controller } } };
+      lovrRetain(controller);
+      lovrEventPush(event);
+    }
+
+    uint32_t buttonsBefore = before ? before->buttons : 0;
+    uint32_t buttonsAfter = after ? after->buttons : 0;
+    for (ControllerButton button = CONTROLLER_BUTTON_SYSTEM; button <= CONTROLLER_BUTTON_Y; button++) {
+      uint32_t mask = 1u << button;
+      if ((buttonsBefore & mask) != (buttonsAfter & mask)) {
+        Event event;
+        event.type = (buttonsAfter & mask) ? EVENT_CONTROLLER_PRESSED : EVENT_CONTROLLER_RELEASED;
+        event.data.controllerpressed.controller = controller;
+        event.data.controllerpressed.button = button;
+        lovrEventPush(event);
+      }
+    }
+  }
+}
+
+// Every update advances exactly one recorded frame, regardless of dt, so replays are repeatable.
+// The timer has already stepped by now, so the next frame's dt is the one set here.
+static void replayUpdate(float dt) {
+  RecordedFrame* previous = replayGetFrame();
+  state.frame = (state.frame + 1) % state.frames.length;
+  replayPushEvents(previous, replayGetFrame());
+  lovrTimerSetFixedDelta(state.frames.data[(state.frame + 1) % state.frames.length]->dt);
+  state.poseTime = lovrGetTicks();
+}
+
+static uint64_t replayGetPoseTime() {
+  return state.poseTime;
+}
+
+HeadsetInterface lovrHeadsetReplayDriver = {
+  DRIVER_REPLAY,
+  replayInit,
+  replayDestroy,
+  replayGetType,
+  replayGetOriginType,
+  replayIsMounted,
+  replayIsMirrored,
+  replaySetMirrored,
+  replayGetDisplayDimensions,
+  replayGetClipDistance,
+  replaySetClipDistance,
+  replayGetBoundsWidth,
+  replayGetBoundsDepth,
+  replayGetPose,
+  replayGetEyePose,
+  NULL,
+  replayGetVelocity,
+  replayGetAngularVelocity,
+  replayGetControllers,
+  replayControllerIsConnected,
+  replayControllerGetHand,
+  replayControllerGetPose,
+  replayControllerGetAxis,
+  replayControllerIsDown,
+  replayControllerIsTouched,
+  replayControllerVibrate,
+  replayControllerNewModelData,
+  replayRenderTo,
+  replayGetPoseTime,
+  replayUpdate
+};
@@ -269,6 +269,7 @@ HeadsetInterface lovrHeadsetWebVRDriver = {
   webvrGetBoundsDepth,
   webvrGetPose,
   webvrGetEyePose,
+  NULL,
   webvrGetVelocity,
   webvrGetAngularVelocity,
   webvrGetControllers,
@@ -281,5 +282,6 @@ HeadsetInterface lovrHeadsetWebVRDriver = {
   webvrControllerVibrate,
   webvrControllerNewModelData,
   webvrRenderTo,
+  NULL,
   webvrUpdate
 };
@@ -9,162 +9,166 @@
 #include <string.h>
 #include "map.h"
 
+/* The table is open addressed with linear probing.  Each slot holds the hash
+ * and a pointer to a node, so probing only touches the slot array and keys
+ * are compared when the hashes match.  Nodes are allocated once and never
+ * move, so pointers returned by map_get stay valid when the table grows. */
+
 struct map_node_t {
   unsigned hash;
   void *value;
-  map_node_t *next;
   /* char key[]; */
   /* char value[]; */
 };
 
+struct map_slot_t {
+  unsigned hash;
+  map_node_t *node;
+};
+
+#define MAP_MIN_BUCKETS 8
+
 
 static unsigned map_hash(const char *str) {
-  unsigned hash = 5381;
+  unsigned hash = 2166136261u;
   while (*str) {
-    hash = ((hash << 5) + hash) ^ *str++;
+    hash = (hash ^ (unsigned char) *str++) * 16777619u;
   }
   return hash;
 }
 
 
-static map_node_t *map_newnode(const char *key, void *value, int vsize) {
+static map_node_t *map_newnode(const char *key, unsigned hash, void *value, int vsize) {
   map_node_t *node;
   int ksize = strlen(key) + 1;
   int voffset = ksize + ((sizeof(void*) - ksize) % sizeof(void*));
   node = malloc(sizeof(*node) + voffset + vsize);
   if (!node) return NULL;
   memcpy(node + 1, key, ksize);
-  node->hash = map_hash(key);
+  node->hash = hash;
   node->value = ((char*) (node + 1)) + voffset;
   memcpy(node->value, value, vsize);
   return node;
 }
 
 
-static int map_bucketidx(map_base_t *m, unsigned hash) {
-  /* If the implementation is changed to allow a non-power-of-2 bucket count,
-   * the line below should be changed to use mod instead of AND */
+static unsigned map_bucketidx(map_base_t *m, unsigned hash) {
+  /* The bucket count is always a power of 2 */
   return hash & (m->nbuckets - 1);
 }
 
 
 static void map_addnode(map_base_t *m, map_node_t *node) {
-  int n = map_bucketidx(m, node->hash);
-  node->next = m->buckets[n];
-  m->buckets[n] = node;
+  unsigned n = map_bucketidx(m, node->hash);
+  while (m->slots[n].node) {
+    n = (n + 1) & (m->nbuckets - 1);
+  }
+  m->slots[n].hash = node->hash;
+  m->slots[n].node = node;
 }
 
 
-static int map_resize(map_base_t *m, int nbuckets) {
-  map_node_t *nodes, *node, *next;
-  map_node_t **buckets;
-  int i; 
-  /* Chain all nodes together */
-  nodes = NULL;
-  i = m->nbuckets;
-  while (i--) {
-    node = (m->buckets)[i];
-    while (node) {
-      next = node->next;
-      node->next = nodes;
-      nodes = node;
-      node = next;
-    }
+static int map_resize(map_base_t *m, unsigned nbuckets) {
+  map_slot_t *slots = m->slots;
+  unsigned i = m->nbuckets;
+  m->slots = calloc(nbuckets, sizeof(*m->slots));
+  /* Keep the old table if allocation failed */
+  if (m->slots == NULL) {
+    m->slots = slots;
+    return -1;
   }
-  /* Reset buckets */
-  buckets = realloc(m->buckets, sizeof(*m->buckets) * nbuckets);
-  if (buckets != NULL) {
-    m->buckets = buckets;
-    m->nbuckets = nbuckets;
-  }
-  if (m->buckets) {
-    memset(m->buckets, 0, sizeof(*m->buckets) * m->nbuckets);
-    /* Re-add nodes to buckets */
-    node = nodes;
-    while (node) {
-      next = node->next;
-      map_addnode(m, node);
-      node = next;
+  m->nbuckets = nbuckets;
+  while (i--) {
+    if (slots[i].node) {
+      map_addnode(m, slots[i].node);
     }
   }
-  /* Return error code if realloc() failed */
-  return (buckets == NULL) ? -1 : 0;
+  free(slots);
+  return 0;
 }
 
 
-static map_node_t **map_getref(map_base_t *m, const char *key) {
-  unsigned hash = map_hash(key);
-  map_node_t **next;
-  if (m->nbuckets > 0) {
-    next = &m->buckets[map_bucketidx(m, hash)];
-    while (*next) {
-      if ((*next)->hash == hash && !strcmp((char*) (*next + 1), key)) {
-        return next;
-      }
-      next = &(*next)->next;
+static int map_getidx(map_base_t *m, const char *key, unsigned hash) {
+  unsigned n;
+  if (m->nbuckets == 0) {
+    return -1;
+  }
+  n = map_bucketidx(m, hash);
+  while (m->slots[n].node) {
+    if (m->slots[n].hash == hash && !strcmp((char*) (m->slots[n].node + 1), key)) {
+      return n;
     }
+    n = (n + 1) & (m->nbuckets - 1);
   }
-  return NULL;
+  return -1;
 }
 
 
 void map_deinit_(map_base_t *m) {
-  map_node_t *next, *node;
-  int i;
-  i = m->nbuckets;
+  unsigned i = m->nbuckets;
   while (i--) {
-    node = m->buckets[i];
-    while (node) {
-      next = node->next;
-      free(node);
-      node = next;
-    }
+    free(m->slots[i].node);
   }
-  free(m->buckets);
+  free(m->slots);
 }
 
 
 void *map_get_(map_base_t *m, const char *key) {
-  map_node_t **next = map_getref(m, key);
-  return next ? (*next)->value : NULL;
+  int n = map_getidx(m, key, map_hash(key));
+  return n >= 0 ? m->slots[n].node->value : NULL;
 }
 
 
 int map_set_(map_base_t *m, const char *key, void *value, int vsize) {
-  int n, err;
-  map_node_t **next, *node;
+  unsigned hash = map_hash(key);
+  map_node_t *node;
   /* Find & replace existing node */
-  next = map_getref(m, key);
-  if (next) {
-    memcpy((*next)->value, value, vsize);
+  int n = map_getidx(m, key, hash);
+  if (n >= 0) {
+    memcpy(m->slots[n].node->value, value, vsize);
     return 0;
   }
-  /* Add new node */
-  node = map_newnode(key, value, vsize);
-  if (node == NULL) goto fail;
-  if (m->nnodes >= m->nbuckets) {
-    n = (m->nbuckets > 0) ? (m->nbuckets << 1) : 1;
-    err = map_resize(m, n);
-    if (err) goto fail;
+  /* Add new node, keeping the table at most half full so probes stay short */
+  node = map_newnode(key, hash, value, vsize);
+  if (node == NULL) return -1;
+  if ((m->nnodes + 1) * 2 > m->nbuckets) {
+    if (map_resize(m, m->nbuckets > 0 ? m->nbuckets << 1 : MAP_MIN_BUCKETS)) {
+      free(node);
+      return -1;
+    }
   }
   map_addnode(m, node);
   m->nnodes++;
   return 0;
-  fail:
-  if (node) free(node);
-  return -1;
 }
 
 
 void map_remove_(map_base_t *m, const char *key) {
-  map_node_t *node;
-  map_node_t **next = map_getref(m, key);
-  if (next) {
-    node = *next;
-    *next = (*next)->next;
-    free(node);
-    m->nnodes--;
+  unsigned i, j, k, mask;
+  int n = map_getidx(m, key, map_hash(key));
+  if (n < 0) {
+    return;
   }
+  free(m->slots[n].node);
+  m->nnodes--;
+  /* Shift later entries of the probe sequence back into the hole, so lookups
+   * never need tombstones.  An entry moves if its home bucket is not between
+   * the hole and its current slot. */
+  mask = m->nbuckets - 1;
+  i = j = n;
+  for (;;) {
+    j = (j + 1) & mask;
+    if (!m->slots[j].node) {
+      break;
+    }
+    k = map_bucketidx(m, m->slots[j].hash);
+    if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) {
+      continue;
+    }
+    m->slots[i] = m->slots[j];
+    i = j;
+  }
+  m->slots[i].node = NULL;
 }
 
 
@@ -177,17 +181,12 @@ map_iter_t map_iter_(void) {
 
 
 const char *map_next_(map_base_t *m, map_iter_t *iter) {
-  if (iter->node) {
-    iter->node = iter->node->next;
-    if (iter->node == NULL) goto nextBucket;
-  } else {
-    nextBucket:
-    do {
-      if (++iter->bucketidx >= m->nbuckets) {
-        return NULL;
-      }
-      iter->node = m->buckets[iter->bucketidx];
-    } while (iter->node == NULL);
-  }
+  do {
+    if (++iter->bucketidx >= m->nbuckets) {
+      iter->node = NULL;
+      return NULL;
+    }
+    iter->node = m->slots[iter->bucketidx].node;
+  } while (iter->node == NULL);
   return (char*) (iter->node + 1);
 }
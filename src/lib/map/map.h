@@ -15,8 +15,11 @@
 struct map_node_t;
 typedef struct map_node_t map_node_t;
 
+struct map_slot_t;
+typedef struct map_slot_t map_slot_t;
+
 typedef struct {
-  map_node_t **buckets;
+  map_slot_t *slots;
   unsigned nbuckets, nnodes;
 } map_base_t;
 
@@ -10,9 +10,9 @@
 void lovrDestroy() {
   lovrAudioDestroy();
   lovrEventDestroy();
+  lovrHeadsetDestroy(); // Flushes headset recordings, so it needs the filesystem
   lovrFilesystemDestroy();
   lovrGraphicsDestroy();
-  lovrHeadsetDestroy();
   lovrMathDestroy();
   lovrPhysicsDestroy();
   lovrTimerDestroy();
@@ -7,8 +7,13 @@ static int luax_pushobjectname(lua_State* L) {
   return 1;
 }
 
+// The address of this variable is the registry key of the object registry, since a light userdata
+// key is cheaper to look up than a string key that has to be interned on every access.
+static char objectRegistryKey;
+
 static void luax_pushobjectregistry(lua_State* L) {
-  lua_getfield(L, LUA_REGISTRYINDEX, "_lovrobjects");
+  lua_pushlightuserdata(L, &objectRegistryKey);
+  lua_rawget(L, LUA_REGISTRYINDEX);
 
   // Create the registry if it doesn't exist yet
   if (lua_isnil(L, -1)) {
@@ -26,8 +31,9 @@ static void luax_pushobjectregistry(lua_State* L) {
     lua_setmetatable(L, -2);
 
     // Write the table to the registry
-    lua_pushvalue(L, -1);
-    lua_setfield(L, LUA_REGISTRYINDEX, "_lovrobjects");
+    lua_pushlightuserdata(L, &objectRegistryKey);
+    lua_pushvalue(L, -2);
+    lua_rawset(L, LUA_REGISTRYINDEX);
   }
 }
 
@@ -86,7 +92,13 @@ void luax_extendtype(lua_State* L, const char* base, const char* name, const lua
 }
 
 int luax_releasetype(lua_State* L) {
-  lovrRelease(*(Ref**) lua_touserdata(L, 1));
+  Ref* ref = *(Ref**) lua_touserdata(L, 1);
+  if (ref->shared) {
+    lovrAtomicDecrement(&ref->handles);
+  } else {
+    ref->handles--;
+  }
+  lovrRelease(ref);
   return 0;
 }
 
@@ -104,10 +116,15 @@ void* luax_testudata(lua_State* L, int index, const char* type) {
 }
 
 // Find an object, pushing it onto the stack if it's found or leaving the stack unchanged otherwise.
+// Objects that don't have a userdata in any Lua state can skip the registry lookup entirely.
 int luax_getobject(lua_State* L, void* object) {
+  if (((Ref*) object)->handles == 0) {
+    return 0;
+  }
+
   luax_pushobjectregistry(L);
   lua_pushlightuserdata(L, object);
-  lua_gettable(L, -2);
+  lua_rawget(L, -2);
 
   if (lua_isnil(L, -1)) {
     lua_pop(L, 2);
@@ -123,8 +140,14 @@ void luax_registerobject(lua_State* L, void* object) {
   luax_pushobjectregistry(L);
   lua_pushlightuserdata(L, object);
   lua_pushvalue(L, -3);
-  lua_settable(L, -3);
+  lua_rawset(L, -3);
   lua_pop(L, 1);
+  Ref* ref = object;
+  if (ref->shared) {
+    lovrAtomicIncrement(&ref->handles);
+  } else {
+    ref->handles++;
+  }
   lovrRetain(object);
 }
 
@@ -150,16 +173,54 @@ int luax_setconf(lua_State* L) {
   return 0;
 }
 
-void luax_pushenum(lua_State* L, map_int_t* map, int value) {
-  const char* key;
-  map_iter_t iter = map_iter(map);
-  while ((key = map_next(map, &iter))) {
-    if (*map_get(map, key) == value) {
+// Each enum map gets a registry table mapping its values back to their (interned) Lua strings, so
+// pushing an enum is a rawgeti instead of a walk over the map.  Strings are still looked up in the
+// map itself, which is faster than going through a Lua table with the C API (see test/enums.c).
+static void luax_pushenumcache(lua_State* L, map_int_t* map) {
+  lua_pushlightuserdata(L, map);
+  lua_rawget(L, LUA_REGISTRYINDEX);
+
+  if (lua_isnil(L, -1)) {
+    lua_pop(L, 1);
+    lua_newtable(L);
+
+    const char* key;
+    map_iter_t iter = map_iter(map);
+    while ((key = map_next(map, &iter))) {
       lua_pushstring(L, key);
-      return;
+      lua_rawseti(L, -2, *map_get(map, key));
+    }
+
+    lua_pushlightuserdata(L, map);
+    lua_pushvalue(L, -2);
+    lua_rawset(L, LUA_REGISTRYINDEX);
+  }
+}
+
+void luax_pushenum(lua_State* L, map_int_t* map, int value) {
+  luax_pushenumcache(L, map);
+  lua_rawgeti(L, -1, value);
+
+  // Values added to the map after the cache was built are picked up here
+  if (lua_isnil(L, -1)) {
+    lua_pop(L, 1);
+    const char* key;
+    map_iter_t iter = map_iter(map);
+    while ((key = map_next(map, &iter))) {
+      if (*map_get(map, key) == value) {
+        lua_pushstring(L, key);
+        lua_pushvalue(L, -1);
+        lua_rawseti(L, -3, value);
+        break;
+      }
+    }
+
+    if (!key) {
+      lua_pushnil(L);
     }
   }
-  lua_pushnil(L);
+
+  lua_remove(L, -2);
 }
 
 void* luax_checkenum(lua_State* L, int index, map_int_t* map, const char* typeName) {
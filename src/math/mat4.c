@@ -5,6 +5,17 @@
 #include <stdlib.h>
 #include <string.h>
 
+// Define LOVR_NO_SIMD to force the scalar reference implementations
+#ifndef LOVR_NO_SIMD
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define LOVR_USE_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define LOVR_USE_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
 // m0 m4 m8  m12
 // m1 m5 m9  m13
 // m2 m6 m10 m14
@@ -60,6 +71,78 @@ mat4 mat4_identity(mat4 m) {
   return m;
 }
 
+#if defined(LOVR_USE_SSE)
+// Blockwise inverse: the matrix is split into four 2x2 blocks, each held in one register, and the
+// inverse is assembled from their adjugates and determinants.  It's run on the columns, which gives
+// the transpose of the inverse of the transpose, which is the inverse.
+#define SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define SWIZZLE(a, x, y, z, w) SHUFFLE(a, a, x, y, z, w)
+
+// A * B, A# * B and A * B# for 2x2 matrices stored as (m00, m01, m10, m11), where # is the adjugate
+static __m128 mat2_multiply(__m128 a, __m128 b) {
+  return _mm_add_ps(_mm_mul_ps(a, SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+static __m128 mat2_adjugateMultiply(__m128 a, __m128 b) {
+  return _mm_sub_ps(_mm_mul_ps(SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(SWIZZLE(a, 1, 1, 2, 2), SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+static __m128 mat2_multiplyAdjugate(__m128 a, __m128 b) {
+  return _mm_sub_ps(_mm_mul_ps(a, SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+mat4 mat4_invert(mat4 m) {
+  __m128 c0 = _mm_loadu_ps(m + 0);
+  __m128 c1 = _mm_loadu_ps(m + 4);
+  __m128 c2 = _mm_loadu_ps(m + 8);
+  __m128 c3 = _mm_loadu_ps(m + 12);
+
+  __m128 a = _mm_movelh_ps(c0, c1);
+  __m128 b = _mm_movehl_ps(c1, c0);
+  __m128 c = _mm_movelh_ps(c2, c3);
+  __m128 d = _mm_movehl_ps(c3, c2);
+
+  // (|A|, |B|, |C|, |D|)
+  __m128 determinants = _mm_sub_ps(
+    _mm_mul_ps(SHUFFLE(c0, c2, 0, 2, 0, 2), SHUFFLE(c1, c3, 1, 3, 1, 3)),
+    _mm_mul_ps(SHUFFLE(c0, c2, 1, 3, 1, 3), SHUFFLE(c1, c3, 0, 2, 0, 2))
+  );
+  __m128 detA = SWIZZLE(determinants, 0, 0, 0, 0);
+  __m128 detB = SWIZZLE(determinants, 1, 1, 1, 1);
+  __m128 detC = SWIZZLE(determinants, 2, 2, 2, 2);
+  __m128 detD = SWIZZLE(determinants, 3, 3, 3, 3);
+
+  __m128 dc = mat2_adjugateMultiply(d, c);
+  __m128 ab = mat2_adjugateMultiply(a, b);
+  __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), mat2_multiply(b, dc));
+  __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), mat2_multiply(c, ab));
+  __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), mat2_multiplyAdjugate(d, ab));
+  __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), mat2_multiplyAdjugate(a, dc));
+
+  // |M| = |A||D| + |B||C| - tr(A#B D#C)
+  __m128 trace = _mm_mul_ps(ab, SWIZZLE(dc, 0, 2, 1, 3));
+  trace = _mm_add_ps(trace, _mm_movehl_ps(trace, trace));
+  trace = _mm_add_ss(trace, SWIZZLE(trace, 1, 1, 1, 1));
+  float det = _mm_cvtss_f32(_mm_sub_ss(_mm_add_ss(_mm_mul_ss(detA, detD), _mm_mul_ss(detB, detC)), trace));
+
+  if (!det) { return NULL; }
+  __m128 invDet = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), _mm_set1_ps(det));
+  x = _mm_mul_ps(x, invDet);
+  y = _mm_mul_ps(y, invDet);
+  z = _mm_mul_ps(z, invDet);
+  w = _mm_mul_ps(w, invDet);
+
+  // The blocks are adjugates, so their elements are swapped back while they're stored
+  _mm_storeu_ps(m + 0, SHUFFLE(x, y, 3, 1, 3, 1));
+  _mm_storeu_ps(m + 4, SHUFFLE(x, y, 2, 0, 2, 0));
+  _mm_storeu_ps(m + 8, SHUFFLE(z, w, 3, 1, 3, 1));
+  _mm_storeu_ps(m + 12, SHUFFLE(z, w, 2, 0, 2, 0));
+  return m;
+}
+
+#undef SHUFFLE
+#undef SWIZZLE
+#else
 // Modified from gl-matrix.c
 mat4 mat4_invert(mat4 m) {
   float a00 = m[0], a01 = m[1], a02 = m[2], a03 = m[3],
@@ -105,6 +188,7 @@ mat4 mat4_invert(mat4 m) {
 
   return m;
 }
+#endif
 
 mat4 mat4_transpose(mat4 m) {
   float a01 = m[1], a02 = m[2], a03 = m[3],
@@ -126,6 +210,53 @@ mat4 mat4_transpose(mat4 m) {
   return m;
 }
 
+// Each column of the result is a linear combination of the columns of m.  All of n is loaded
+// before anything is stored, so m and n can alias.
+#if defined(LOVR_USE_SSE)
+mat4 mat4_multiply(mat4 m, mat4 n) {
+  __m128 c0 = _mm_loadu_ps(m + 0);
+  __m128 c1 = _mm_loadu_ps(m + 4);
+  __m128 c2 = _mm_loadu_ps(m + 8);
+  __m128 c3 = _mm_loadu_ps(m + 12);
+  __m128 r[4];
+
+  for (int i = 0; i < 4; i++) {
+    __m128 x = _mm_mul_ps(c0, _mm_set1_ps(n[4 * i + 0]));
+    __m128 y = _mm_mul_ps(c1, _mm_set1_ps(n[4 * i + 1]));
+    __m128 z = _mm_mul_ps(c2, _mm_set1_ps(n[4 * i + 2]));
+    __m128 w = _mm_mul_ps(c3, _mm_set1_ps(n[4 * i + 3]));
+    r[i] = _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, w));
+  }
+
+  for (int i = 0; i < 4; i++) {
+    _mm_storeu_ps(m + 4 * i, r[i]);
+  }
+
+  return m;
+}
+#elif defined(LOVR_USE_NEON)
+mat4 mat4_multiply(mat4 m, mat4 n) {
+  float32x4_t c0 = vld1q_f32(m + 0);
+  float32x4_t c1 = vld1q_f32(m + 4);
+  float32x4_t c2 = vld1q_f32(m + 8);
+  float32x4_t c3 = vld1q_f32(m + 12);
+  float32x4_t r[4];
+
+  for (int i = 0; i < 4; i++) {
+    float32x4_t v = vmulq_n_f32(c0, n[4 * i + 0]);
+    v = vmlaq_n_f32(v, c1, n[4 * i + 1]);
+    v = vmlaq_n_f32(v, c2, n[4 * i + 2]);
+    v = vmlaq_n_f32(v, c3, n[4 * i + 3]);
+    r[i] = v;
+  }
+
+  for (int i = 0; i < 4; i++) {
+    vst1q_f32(m + 4 * i, r[i]);
+  }
+
+  return m;
+}
+#else
 // Modified from gl-matrix.c
 mat4 mat4_multiply(mat4 m, mat4 n) {
   float m00 = m[0], m01 = m[1], m02 = m[2], m03 = m[3],
@@ -157,6 +288,7 @@ mat4 mat4_multiply(mat4 m, mat4 n) {
 
   return m;
 }
+#endif
 
 mat4 mat4_translate(mat4 m, float x, float y, float z) {
   m[12] = m[0] * x + m[4] * y + m[8] * z + m[12];
@@ -329,6 +461,26 @@ mat4 mat4_lookAt(mat4 m, vec3 from, vec3 to, vec3 up) {
   return m;
 }
 
+#if defined(LOVR_USE_SSE)
+void mat4_transform(mat4 m, vec3 v) {
+  __m128 x = _mm_mul_ps(_mm_loadu_ps(m + 0), _mm_set1_ps(v[0]));
+  __m128 y = _mm_mul_ps(_mm_loadu_ps(m + 4), _mm_set1_ps(v[1]));
+  __m128 z = _mm_mul_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(v[2]));
+  __m128 result = _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, _mm_loadu_ps(m + 12)));
+  float r[4];
+  _mm_storeu_ps(r, result);
+  vec3_set(v, r[0], r[1], r[2]);
+}
+#elif defined(LOVR_USE_NEON)
+void mat4_transform(mat4 m, vec3 v) {
+  float32x4_t result = vmlaq_n_f32(vld1q_f32(m + 12), vld1q_f32(m + 0), v[0]);
+  result = vmlaq_n_f32(result, vld1q_f32(m + 4), v[1]);
+  result = vmlaq_n_f32(result, vld1q_f32(m + 8), v[2]);
+  float r[4];
+  vst1q_f32(r, result);
+  vec3_set(v, r[0], r[1], r[2]);
+}
+#else
 void mat4_transform(mat4 m, vec3 v) {
   vec3_set(v,
     v[0] * m[0] + v[1] * m[4] + v[2] * m[8] + m[12],
@@ -336,6 +488,7 @@ void mat4_transform(mat4 m, vec3 v) {
     v[0] * m[2] + v[1] * m[6] + v[2] * m[10] + m[14]
   );
 }
+#endif
 
 void mat4_transformDirection(mat4 m, vec3 v) {
   vec3_set(v,
@@ -344,3 +497,100 @@ void mat4_transformDirection(mat4 m, vec3 v) {
     v[0] * m[2] + v[1] * m[6] + v[2] * m[10]
   );
 }
+
+// Batched kernels, for transforming many matrices or points with the same matrix.  Matrices are
+// tightly packed arrays of 16 floats and points are tightly packed arrays of 3 floats.
+
+// Sets each matrix to m * matrix
+void mat4_multiplyArray(mat4 m, float* matrices, int count) {
+  float result[16];
+  for (int i = 0; i < count; i++) {
+    mat4 n = matrices + 16 * i;
+    mat4_multiply(mat4_set(result, m), n);
+    mat4_set(n, result);
+  }
+}
+
+void mat4_transformArray(mat4 m, float* points, int count) {
+#if defined(LOVR_USE_SSE)
+  __m128 c0 = _mm_loadu_ps(m + 0);
+  __m128 c1 = _mm_loadu_ps(m + 4);
+  __m128 c2 = _mm_loadu_ps(m + 8);
+  __m128 c3 = _mm_loadu_ps(m + 12);
+
+  for (int i = 0; i < count; i++) {
+    float* p = points + 3 * i;
+    __m128 v = _mm_add_ps(
+      _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(p[0])), _mm_mul_ps(c1, _mm_set1_ps(p[1]))),
+      _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(p[2])), c3)
+    );
+    float result[4];
+    _mm_storeu_ps(result, v);
+    vec3_set(p, result[0], result[1], result[2]);
+  }
+#elif defined(LOVR_USE_NEON)
+  float32x4_t c0 = vld1q_f32(m + 0);
+  float32x4_t c1 = vld1q_f32(m + 4);
+  float32x4_t c2 = vld1q_f32(m + 8);
+  float32x4_t c3 = vld1q_f32(m + 12);
+
+  for (int i = 0; i < count; i++) {
+    float* p = points + 3 * i;
+    float32x4_t v = vmlaq_n_f32(c3, c0, p[0]);
+    v = vmlaq_n_f32(v, c1, p[1]);
+    v = vmlaq_n_f32(v, c2, p[2]);
+    float result[4];
+    vst1q_f32(result, v);
+    vec3_set(p, result[0], result[1], result[2]);
+  }
+#else
+  for (int i = 0; i < count; i++) {
+    mat4_transform(m, points + 3 * i);
+  }
+#endif
+}
+
+// Inverts a matrix whose last row is (0, 0, 0, 1) by inverting its upper 3x3 and transforming the
+// translation, which is much cheaper than a general inverse.  Returns NULL if it isn't invertible.
+mat4 mat4_invertAffine(mat4 m) {
+  float a00 = m[0], a01 = m[1], a02 = m[2],
+        a10 = m[4], a11 = m[5], a12 = m[6],
+        a20 = m[8], a21 = m[9], a22 = m[10],
+        tx = m[12], ty = m[13], tz = m[14],
+
+        b01 = a22 * a11 - a12 * a21,
+        b11 = -a22 * a10 + a12 * a20,
+        b21 = a21 * a10 - a11 * a20,
+
+        d = a00 * b01 + a01 * b11 + a02 * b21;
+
+  if (!d) { return NULL; }
+  float invDet = 1 / d;
+
+  m[0] = b01 * invDet;
+  m[1] = (-a22 * a01 + a02 * a21) * invDet;
+  m[2] = (a12 * a01 - a02 * a11) * invDet;
+  m[3] = 0.f;
+  m[4] = b11 * invDet;
+  m[5] = (a22 * a00 - a02 * a20) * invDet;
+  m[6] = (-a12 * a00 + a02 * a10) * invDet;
+  m[7] = 0.f;
+  m[8] = b21 * invDet;
+  m[9] = (-a21 * a00 + a01 * a20) * invDet;
+  m[10] = (a11 * a00 - a01 * a10) * invDet;
+  m[11] = 0.f;
+  m[12] = -(m[0] * tx + m[4] * ty + m[8] * tz);
+  m[13] = -(m[1] * tx + m[5] * ty + m[9] * tz);
+  m[14] = -(m[2] * tx + m[6] * ty + m[10] * tz);
+  m[15] = 1.f;
+  return m;
+}
+
+// Returns the number of matrices that could not be inverted, which are left unchanged
+int mat4_invertAffineArray(float* matrices, int count) {
+  int failures = 0;
+  for (int i = 0; i < count; i++) {
+    failures += !mat4_invertAffine(matrices + 16 * i);
+  }
+  return failures;
+}
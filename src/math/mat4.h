@@ -8,6 +8,7 @@ mat4 mat4_fromMat34(mat4 m, float (*n)[4]);
 mat4 mat4_fromMat44(mat4 m, float (*n)[4]);
 mat4 mat4_identity(mat4 m);
 mat4 mat4_invert(mat4 m);
+mat4 mat4_invertAffine(mat4 m);
 mat4 mat4_transpose(mat4 m);
 mat4 mat4_multiply(mat4 m, mat4 n);
 mat4 mat4_translate(mat4 m, float x, float y, float z);
@@ -21,3 +22,6 @@ mat4 mat4_perspective(mat4 m, float near, float far, float fov, float aspect);
 mat4 mat4_lookAt(mat4 m, vec3 from, vec3 to, vec3 up);
 void mat4_transform(mat4 m, vec3 v);
 void mat4_transformDirection(mat4 m, vec3 v);
+void mat4_multiplyArray(mat4 m, float* matrices, int count);
+void mat4_transformArray(mat4 m, float* points, int count);
+int mat4_invertAffineArray(float* matrices, int count);
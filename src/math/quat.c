@@ -40,6 +40,16 @@ quat quat_fromMat4(quat q, mat4 m) {
   return q;
 }
 
+quat quat_multiply(quat q, quat r) {
+  float qx = q[0], qy = q[1], qz = q[2], qw = q[3];
+  float rx = r[0], ry = r[1], rz = r[2], rw = r[3];
+  q[0] = qw * rx + qx * rw + qy * rz - qz * ry;
+  q[1] = qw * ry - qx * rz + qy * rw + qz * rx;
+  q[2] = qw * rz + qx * ry - qy * rx + qz * rw;
+  q[3] = qw * rw - qx * rx - qy * ry - qz * rz;
+  return q;
+}
+
 quat quat_normalize(quat q) {
   float len = quat_length(q);
   if (len == 0) {
@@ -1,8 +1,13 @@
 #include "math/randomGenerator.h"
+#include "math/math.h"
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#define RANDOM_BATCH 256
 
 // Thomas Wang's 64-bit integer hashing function:
 // https://web.archive.org/web/20110807030012/http://www.cris.com/%7ETtwang/tech/inthash.htm
@@ -86,3 +91,127 @@ double lovrRandomGeneratorRandomNormal(RandomGenerator* generator) {
   generator->lastRandomNormal = r * cos(phi);
   return r * sin(phi);
 }
+
+// Fills a buffer with floats in [0, 1).  Each lane is its own Xorshift* stream and every step
+// yields two floats from the high bits, so the loop over lanes has no dependencies between
+// iterations and can be vectorized.
+// Buffers are written in blocks of 2 * RANDOM_LANES floats, so count is rounded up to that.
+static void lovrRandomGeneratorFillUniform(uint64_t* lanes, float* data, int count) {
+  union { uint32_t i; float f; } u;
+  for (int i = 0; i < count; i += 2 * RANDOM_LANES) {
+    for (int lane = 0; lane < RANDOM_LANES; lane++) {
+      uint64_t x = lanes[lane];
+      x ^= x >> 12;
+      x ^= x << 25;
+      x ^= x >> 27;
+      lanes[lane] = x;
+      uint64_t r = x * 2685821657736338717ULL;
+      u.i = 0x3F800000 | (uint32_t) (r >> 41);
+      data[i + 2 * lane] = u.f - 1.f;
+      u.i = 0x3F800000 | ((uint32_t) (r >> 18) & 0x7FFFFF);
+      data[i + 2 * lane + 1] = u.f - 1.f;
+    }
+  }
+}
+
+// Writes count elements of components floats each, stride bytes apart.  The bulk streams are seeded
+// from one step of the scalar generator, so a fill is reproducible from getState/setState.
+void lovrRandomGeneratorFill(RandomGenerator* generator, RandomDistribution distribution, float* params, float* data, uint32_t count, int components, size_t stride) {
+  lovrAssert(components >= 1 && components <= 4, "Random vectors must have between 1 and 4 components");
+  lovrAssert(distribution != DISTRIBUTION_SPHERE || components == 2 || components == 3, "Sphere samples need 2 or 3 components");
+
+  uint64_t lanes[RANDOM_LANES];
+  lovrRandomGeneratorRandom(generator);
+  for (int lane = 0; lane < RANDOM_LANES; lane++) {
+    uint64_t x = generator->state.b64 + lane;
+    do {
+      x = wangHash64(x);
+    } while (x == 0);
+    lanes[lane] = x;
+  }
+
+  // Number of uniform samples used by each element, normal samples are generated in pairs
+  int samples = distribution == DISTRIBUTION_SPHERE ? 2 : components;
+  if (distribution == DISTRIBUTION_NORMAL) {
+    samples += samples & 1;
+  }
+
+  int perBatch = RANDOM_BATCH / samples;
+  bool packed = stride == components * sizeof(float);
+
+  float batch[RANDOM_BATCH];
+  char* element = (char*) data;
+  while (count > 0) {
+    int n = MIN(count, (uint32_t) perBatch);
+    lovrRandomGeneratorFillUniform(lanes, batch, n * samples);
+
+    switch (distribution) {
+      case DISTRIBUTION_UNIFORM: {
+        float lower = params[0];
+        float range = params[1] - params[0];
+        if (packed) {
+          float* out = (float*) element;
+          for (int i = 0; i < n * components; i++) {
+            out[i] = lower + batch[i] * range;
+          }
+          element += n * stride;
+          break;
+        }
+
+        for (int i = 0; i < n; i++, element += stride) {
+          float* u = batch + i * samples;
+          float* out = (float*) element;
+          for (int c = 0; c < components; c++) {
+            out[c] = lower + u[c] * range;
+          }
+        }
+        break;
+      }
+
+      case DISTRIBUTION_NORMAL:
+        for (int i = 0; i < n; i++, element += stride) {
+          float* u = batch + i * samples;
+          float* out = (float*) element;
+          for (int c = 0; c < components; c += 2) {
+            float r = sqrtf(-2.f * logf(1.f - u[c]));
+            float phi = 2.f * (float) M_PI * u[c + 1];
+            out[c] = params[1] + params[0] * r * sinf(phi);
+            if (c + 1 < components) {
+              out[c + 1] = params[1] + params[0] * r * cosf(phi);
+            }
+          }
+        }
+        break;
+
+      case DISTRIBUTION_SPHERE:
+        for (int i = 0; i < n; i++, element += stride) {
+          float* u = batch + i * samples;
+          float* out = (float*) element;
+          float phi = 2.f * (float) M_PI * u[1];
+          if (components == 2) {
+            out[0] = params[0] * cosf(phi);
+            out[1] = params[0] * sinf(phi);
+          } else {
+            float z = 2.f * u[0] - 1.f;
+            float r = sqrtf(1.f - z * z);
+            out[0] = params[0] * r * cosf(phi);
+            out[1] = params[0] * r * sinf(phi);
+            out[2] = params[0] * z;
+          }
+        }
+        break;
+
+      case DISTRIBUTION_BOX:
+        for (int i = 0; i < n; i++, element += stride) {
+          float* u = batch + i * samples;
+          float* out = (float*) element;
+          for (int c = 0; c < components; c++) {
+            out[c] = (u[c] - .5f) * params[c];
+          }
+        }
+        break;
+    }
+
+    count -= n;
+  }
+}
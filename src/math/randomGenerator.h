@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <stddef.h>
 #include "util.h"
 
 #pragma once
@@ -13,6 +14,16 @@ typedef union {
   } b32;
 } Seed;
 
+// Bulk generation runs this many independent Xorshift* streams side by side
+#define RANDOM_LANES 4
+
+typedef enum {
+  DISTRIBUTION_UNIFORM,
+  DISTRIBUTION_NORMAL,
+  DISTRIBUTION_SPHERE,
+  DISTRIBUTION_BOX
+} RandomDistribution;
+
 typedef struct {
   Ref ref;
   Seed seed;
@@ -27,3 +38,4 @@ void lovrRandomGeneratorGetState(RandomGenerator* generator, char* state, size_t
 int lovrRandomGeneratorSetState(RandomGenerator* generator, const char* state, size_t length);
 double lovrRandomGeneratorRandom(RandomGenerator* generator);
 double lovrRandomGeneratorRandomNormal(RandomGenerator* generator);
+void lovrRandomGeneratorFill(RandomGenerator* generator, RandomDistribution distribution, float* params, float* data, uint32_t count, int components, size_t stride);
@@ -1,9 +1,12 @@
 #include "transform.h"
 #include "math/mat4.h"
+#include "allocator.h"
 #include <stdlib.h>
 
+static Pool transformPool = POOL_INIT("Transform", Transform);
+
 Transform* lovrTransformCreate(mat4 transfrom) {
-  Transform* transform = lovrAlloc(sizeof(Transform), free);
+  Transform* transform = lovrAllocPooled(&transformPool, lovrTransformDestroy);
   if (!transform) return NULL;
 
   transform->isDirty = true;
@@ -17,6 +20,10 @@ Transform* lovrTransformCreate(mat4 transfrom) {
   return transform;
 }
 
+void lovrTransformDestroy(void* ref) {
+  lovrPoolFree(&transformPool, ref);
+}
+
 void lovrTransformGetMatrix(Transform* transform, mat4 m) {
   mat4_set(m, transform->matrix);
 }
@@ -29,7 +36,13 @@ void lovrTransformSetMatrix(Transform* transform, mat4 m) {
 mat4 lovrTransformInverse(Transform* transform) {
   if (transform->isDirty) {
     transform->isDirty = false;
-    mat4_invert(mat4_set(transform->inverse, transform->matrix));
+    mat4 m = transform->matrix;
+    bool affine = m[3] == 0.f && m[7] == 0.f && m[11] == 0.f && m[15] == 1.f;
+    if (affine) {
+      mat4_invertAffine(mat4_set(transform->inverse, m));
+    } else {
+      mat4_invert(mat4_set(transform->inverse, m));
+    }
   }
 
   return transform->inverse;
@@ -67,3 +80,11 @@ void lovrTransformTransformPoint(Transform* transform, vec3 point) {
 void lovrTransformInverseTransformPoint(Transform* transform, vec3 point) {
   mat4_transform(lovrTransformInverse(transform), point);
 }
+
+void lovrTransformTransformPoints(Transform* transform, float* points, int count) {
+  mat4_transformArray(transform->matrix, points, count);
+}
+
+void lovrTransformInverseTransformPoints(Transform* transform, float* points, int count) {
+  mat4_transformArray(lovrTransformInverse(transform), points, count);
+}
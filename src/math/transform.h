@@ -12,6 +12,7 @@ typedef struct Transform {
 } Transform;
 
 Transform* lovrTransformCreate(mat4 transfrom);
+void lovrTransformDestroy(void* ref);
 void lovrTransformGetMatrix(Transform* transform, mat4 m);
 void lovrTransformSetMatrix(Transform* transform, mat4 m);
 void lovrTransformApply(Transform* transform, Transform* other);
@@ -22,3 +23,5 @@ void lovrTransformRotate(Transform* transform, float angle, float x, float y, fl
 void lovrTransformScale(Transform* transform, float x, float y, float z);
 void lovrTransformTransformPoint(Transform* transform, vec3 point);
 void lovrTransformInverseTransformPoint(Transform* transform, vec3 point);
+void lovrTransformTransformPoints(Transform* transform, float* points, int count);
+void lovrTransformInverseTransformPoints(Transform* transform, float* points, int count);
@@ -1,5 +1,9 @@
 #include "physics.h"
+#include "math/mat4.h"
 #include "math/quat.h"
+#include "math/vec3.h"
+#include "timer/profiler.h"
+#include "allocator.h"
 #include <stdlib.h>
 #include <stdbool.h>
 
@@ -30,6 +34,8 @@ static void raycastCallback(void* data, dGeomID a, dGeomID b) {
 }
 
 static bool initialized = false;
+static Pool colliderPool = POOL_INIT("Collider", Collider);
+static Pool shapePool = POOL_INIT("Shape", Shape);
 
 void lovrPhysicsInit() {
   if (initialized) return;
@@ -51,6 +57,7 @@ World* lovrWorldCreate(float xg, float yg, float zg, bool allowSleep, const char
   world->space = dHashSpaceCreate(0);
   dHashSpaceSetLevels(world->space, -4, 8);
   world->contactGroup = dJointGroupCreate(0);
+  vec_init(&world->colliders);
   vec_init(&world->overlaps);
   lovrWorldSetGravity(world, xg, yg, zg);
   lovrWorldSetSleepingAllowed(world, allowSleep);
@@ -69,11 +76,22 @@ World* lovrWorldCreate(float xg, float yg, float zg, bool allowSleep, const char
 void lovrWorldDestroy(void* ref) {
   World* world = ref;
   lovrWorldDestroyData(world);
+  vec_deinit(&world->colliders);
   vec_deinit(&world->overlaps);
   free(world);
 }
 
 void lovrWorldDestroyData(World* world) {
+  // Destroying colliders one at a time would search the vector for each of them
+  Collider* collider; int i;
+  vec_foreach(&world->colliders, collider, i) {
+    if (collider->body) {
+      dBodyDestroy(collider->body);
+      collider->body = NULL;
+    }
+  }
+  vec_clear(&world->colliders);
+
   if (world->contactGroup) {
     dJointGroupEmpty(world->contactGroup);
     world->contactGroup = NULL;
@@ -91,6 +109,8 @@ void lovrWorldDestroyData(World* world) {
 }
 
 void lovrWorldUpdate(World* world, float dt, CollisionResolver resolver, void* userdata) {
+  lovrProfilerPush("physics");
+
   if (resolver) {
     resolver(world, userdata);
   } else {
@@ -102,6 +122,7 @@ void lovrWorldUpdate(World* world, float dt, CollisionResolver resolver, void* u
   }
 
   dJointGroupEmpty(world->contactGroup);
+  lovrProfilerPop();
 }
 
 void lovrWorldComputeOverlaps(World* world) {
@@ -266,13 +287,72 @@ int lovrWorldIsCollisionEnabledBetween(World* world, const char* tag1, const cha
   return (world->masks[*index1] & (1 << *index2)) && (world->masks[*index2] & (1 << *index1));
 }
 
+vec_void_t* lovrWorldGetColliders(World* world) {
+  return &world->colliders;
+}
+
+size_t lovrWorldGetTransformSize(TransformFormat format) {
+  switch (format) {
+    case TRANSFORM_POSE: return 7 * sizeof(float);
+    case TRANSFORM_MATRIX: return 16 * sizeof(float);
+    default: return 0;
+  }
+}
+
+// Writes the transform of each collider (or all colliders in the world if colliders is NULL) to a
+// tightly packed float array, either as position + quaternion (xyzw) or as a column-major matrix.
+void lovrWorldGetColliderTransforms(World* world, Collider** colliders, int count, TransformFormat format, float* dest) {
+  if (!colliders) {
+    colliders = (Collider**) world->colliders.data;
+    count = world->colliders.length;
+  }
+
+  for (int i = 0; i < count; i++) {
+    dBodyID body = colliders[i]->body;
+    const dReal* position = dBodyGetPosition(body);
+
+    if (format == TRANSFORM_POSE) {
+      const dReal* q = dBodyGetQuaternion(body);
+      dest[0] = position[0];
+      dest[1] = position[1];
+      dest[2] = position[2];
+      dest[3] = q[1];
+      dest[4] = q[2];
+      dest[5] = q[3];
+      dest[6] = q[0];
+      dest += 7;
+    } else {
+      const dReal* r = dBodyGetRotation(body);
+      dest[0] = r[0];
+      dest[1] = r[4];
+      dest[2] = r[8];
+      dest[3] = 0;
+      dest[4] = r[1];
+      dest[5] = r[5];
+      dest[6] = r[9];
+      dest[7] = 0;
+      dest[8] = r[2];
+      dest[9] = r[6];
+      dest[10] = r[10];
+      dest[11] = 0;
+      dest[12] = position[0];
+      dest[13] = position[1];
+      dest[14] = position[2];
+      dest[15] = 1;
+      dest += 16;
+    }
+  }
+}
+
 Collider* lovrColliderCreate(World* world, float x, float y, float z) {
   lovrAssert(world, "No world specified");
-  Collider* collider = lovrAlloc(sizeof(Collider), lovrColliderDestroy);
+  Collider* collider = lovrAllocPooled(&colliderPool, lovrColliderDestroy);
   if (!collider) return NULL;
 
   collider->body = dBodyCreate(world->id);
   collider->world = world;
+  lovrRetain(world);
+  vec_push(&world->colliders, collider);
   collider->friction = 0;
   collider->restitution = 0;
   collider->tag = NO_TAG;
@@ -290,11 +370,13 @@ void lovrColliderDestroy(void* ref) {
   vec_deinit(&collider->shapes);
   vec_deinit(&collider->joints);
   lovrColliderDestroyData(collider);
-  free(collider);
+  lovrRelease(collider->world);
+  lovrPoolFree(&colliderPool, collider);
 }
 
 void lovrColliderDestroyData(Collider* collider) {
   if (collider->body) {
+    vec_remove(&collider->world->colliders, collider);
     dBodyDestroy(collider->body);
     collider->body = NULL;
   }
@@ -631,7 +713,7 @@ void lovrColliderGetAABB(Collider* collider, float aabb[6]) {
 void lovrShapeDestroy(void* ref) {
   Shape* shape = ref;
   lovrShapeDestroyData(shape);
-  free(shape);
+  lovrPoolFree(&shapePool, shape);
 }
 
 void lovrShapeDestroyData(Shape* shape) {
@@ -639,6 +721,16 @@ void lovrShapeDestroyData(Shape* shape) {
     dGeomDestroy(shape->id);
     shape->id = NULL;
   }
+
+  if (shape->mesh) {
+    lovrRelease(shape->mesh);
+    shape->mesh = NULL;
+  }
+
+  if (shape->heightfield) {
+    dGeomHeightfieldDataDestroy(shape->heightfield);
+    shape->heightfield = NULL;
+  }
 }
 
 ShapeType lovrShapeGetType(Shape* shape) {
@@ -724,6 +816,14 @@ void lovrShapeGetMass(Shape* shape, float density, float* cx, float* cy, float*
       dMassSetCylinder(&m, density, 3, radius, length);
       break;
     }
+
+    case SHAPE_MESH: {
+      dMassSetTrimesh(&m, density, shape->id);
+      break;
+    }
+
+    case SHAPE_HEIGHTFIELD:
+      break;
   }
 
   const dReal* position = dGeomGetOffsetPosition(shape->id);
@@ -752,10 +852,12 @@ void lovrShapeGetAABB(Shape* shape, float aabb[6]) {
 }
 
 SphereShape* lovrSphereShapeCreate(float radius) {
-  SphereShape* sphere = lovrAlloc(sizeof(SphereShape), lovrShapeDestroy);
+  SphereShape* sphere = lovrAllocPooled(&shapePool, lovrShapeDestroy);
   if (!sphere) return NULL;
 
   sphere->type = SHAPE_SPHERE;
+  sphere->mesh = NULL;
+  sphere->heightfield = NULL;
   sphere->id = dCreateSphere(0, radius);
   dGeomSetData(sphere->id, sphere);
 
@@ -771,10 +873,12 @@ void lovrSphereShapeSetRadius(SphereShape* sphere, float radius) {
 }
 
 BoxShape* lovrBoxShapeCreate(float x, float y, float z) {
-  BoxShape* box = lovrAlloc(sizeof(BoxShape), lovrShapeDestroy);
+  BoxShape* box = lovrAllocPooled(&shapePool, lovrShapeDestroy);
   if (!box) return NULL;
 
   box->type = SHAPE_BOX;
+  box->mesh = NULL;
+  box->heightfield = NULL;
   box->id = dCreateBox(0, x, y, z);
   dGeomSetData(box->id, box);
 
@@ -794,10 +898,12 @@ void lovrBoxShapeSetDimensions(BoxShape* box, float x, float y, float z) {
 }
 
 CapsuleShape* lovrCapsuleShapeCreate(float radius, float length) {
-  CapsuleShape* capsule = lovrAlloc(sizeof(CapsuleShape), lovrShapeDestroy);
+  CapsuleShape* capsule = lovrAllocPooled(&shapePool, lovrShapeDestroy);
   if (!capsule) return NULL;
 
   capsule->type = SHAPE_CAPSULE;
+  capsule->mesh = NULL;
+  capsule->heightfield = NULL;
   capsule->id = dCreateCapsule(0, radius, length);
   dGeomSetData(capsule->id, capsule);
 
@@ -825,10 +931,12 @@ void lovrCapsuleShapeSetLength(CapsuleShape* capsule, float length) {
 }
 
 CylinderShape* lovrCylinderShapeCreate(float radius, float length) {
-  CylinderShape* cylinder = lovrAlloc(sizeof(CylinderShape), lovrShapeDestroy);
+  CylinderShape* cylinder = lovrAllocPooled(&shapePool, lovrShapeDestroy);
   if (!cylinder) return NULL;
 
   cylinder->type = SHAPE_CYLINDER;
+  cylinder->mesh = NULL;
+  cylinder->heightfield = NULL;
   cylinder->id = dCreateCylinder(0, radius, length);
   dGeomSetData(cylinder->id, cylinder);
 
@@ -855,6 +963,182 @@ void lovrCylinderShapeSetLength(CylinderShape* cylinder, float length) {
   dGeomCylinderSetParams(cylinder->id, lovrCylinderShapeGetRadius(cylinder), length);
 }
 
+static TriMesh* lovrTriMeshAllocate(int vertexCount, int indexCount) {
+  TriMesh* mesh = lovrAlloc(sizeof(TriMesh), lovrTriMeshDestroy);
+  if (!mesh) return NULL;
+
+  mesh->id = dGeomTriMeshDataCreate();
+  mesh->vertices = malloc(3 * vertexCount * sizeof(float));
+  mesh->indices = malloc(indexCount * sizeof(dTriIndex));
+  mesh->vertexCount = vertexCount;
+  mesh->indexCount = indexCount;
+
+  return mesh;
+}
+
+// ODE does not copy the mesh, so this has to be called once the arrays are filled in and left alone
+static void lovrTriMeshBuild(TriMesh* mesh) {
+  size_t vertexStride = 3 * sizeof(float);
+  size_t triangleStride = 3 * sizeof(dTriIndex);
+  dGeomTriMeshDataBuildSingle(mesh->id, mesh->vertices, vertexStride, mesh->vertexCount, mesh->indices, mesh->indexCount, triangleStride);
+  dGeomTriMeshDataPreprocess(mesh->id);
+}
+
+TriMesh* lovrTriMeshCreate(float* vertices, int vertexCount, uint32_t* indices, int indexCount) {
+  lovrAssert(indexCount % 3 == 0, "Triangle mesh index count must be a multiple of 3");
+  for (int i = 0; i < indexCount; i++) {
+    lovrAssert(indices[i] < (uint32_t) vertexCount, "Invalid triangle mesh index: %d", indices[i] + 1);
+  }
+
+  TriMesh* mesh = lovrTriMeshAllocate(vertexCount, indexCount);
+  if (!mesh) return NULL;
+
+  memcpy(mesh->vertices, vertices, 3 * vertexCount * sizeof(float));
+  for (int i = 0; i < indexCount; i++) {
+    mesh->indices[i] = indices[i];
+  }
+
+  lovrTriMeshBuild(mesh);
+  return mesh;
+}
+
+static int countModelNodeIndices(ModelData* modelData, ModelNode* node) {
+  int count = 0;
+
+  for (int i = 0; i < node->primitives.length; i++) {
+    count += modelData->primitives[node->primitives.data[i]].drawCount;
+  }
+
+  for (int i = 0; i < node->children.length; i++) {
+    count += countModelNodeIndices(modelData, &modelData->nodes[node->children.data[i]]);
+  }
+
+  return count;
+}
+
+// Vertices are baked into model space, so every node gets its own copy of the triangles it draws
+static void bakeModelNode(ModelData* modelData, ModelNode* node, TriMesh* mesh, int* cursor) {
+  size_t stride = modelData->vertexData->format.stride;
+
+  for (int i = 0; i < node->primitives.length; i++) {
+    ModelPrimitive* primitive = &modelData->primitives[node->primitives.data[i]];
+    for (int j = 0; j < primitive->drawCount; j++) {
+      uint32_t index;
+      if (modelData->indexSize == sizeof(uint16_t)) {
+        index = modelData->indices.shorts[primitive->drawStart + j];
+      } else {
+        index = modelData->indices.ints[primitive->drawStart + j];
+      }
+
+      float* vertex = mesh->vertices + 3 * *cursor;
+      vec3_init(vertex, (float*) (modelData->vertexData->data.bytes + index * stride));
+      mat4_transform(node->globalTransform, vertex);
+      mesh->indices[*cursor] = *cursor;
+      (*cursor)++;
+    }
+  }
+
+  for (int i = 0; i < node->children.length; i++) {
+    bakeModelNode(modelData, &modelData->nodes[node->children.data[i]], mesh, cursor);
+  }
+}
+
+TriMesh* lovrTriMeshCreateFromModelData(ModelData* modelData) {
+  int count = countModelNodeIndices(modelData, &modelData->nodes[0]);
+  lovrAssert(count % 3 == 0, "Triangle mesh index count must be a multiple of 3");
+  TriMesh* mesh = lovrTriMeshAllocate(count, count);
+  if (!mesh) return NULL;
+
+  int cursor = 0;
+  bakeModelNode(modelData, &modelData->nodes[0], mesh, &cursor);
+  lovrTriMeshBuild(mesh);
+  return mesh;
+}
+
+TriMesh* lovrTriMeshCreateFromVertexData(VertexData* vertexData, uint32_t* indices, int indexCount) {
+  VertexFormat* format = &vertexData->format;
+  Attribute* position = NULL;
+  for (int i = 0; i < format->count; i++) {
+    if (!strcmp(format->attributes[i].name, "lovrPosition")) {
+      position = &format->attributes[i];
+      break;
+    }
+  }
+
+  lovrAssert(position && position->type == ATTR_FLOAT && position->count >= 3, "VertexData needs a lovrPosition attribute with 3 floats");
+  lovrAssert(indexCount % 3 == 0, "Triangle mesh index count must be a multiple of 3");
+  for (int i = 0; i < indexCount; i++) {
+    lovrAssert(indices[i] < vertexData->count, "Invalid triangle mesh index: %d", indices[i] + 1);
+  }
+
+  TriMesh* mesh = lovrTriMeshAllocate(vertexData->count, indexCount);
+  if (!mesh) return NULL;
+
+  for (uint32_t i = 0; i < vertexData->count; i++) {
+    vec3_init(mesh->vertices + 3 * i, (float*) (vertexData->data.bytes + i * format->stride + position->offset));
+  }
+
+  for (int i = 0; i < indexCount; i++) {
+    mesh->indices[i] = indices[i];
+  }
+
+  lovrTriMeshBuild(mesh);
+  return mesh;
+}
+
+void lovrTriMeshDestroy(void* ref) {
+  TriMesh* mesh = ref;
+  dGeomTriMeshDataDestroy(mesh->id);
+  free(mesh->vertices);
+  free(mesh->indices);
+  free(mesh);
+}
+
+MeshShape* lovrMeshShapeCreate(TriMesh* mesh) {
+  MeshShape* shape = lovrAllocPooled(&shapePool, lovrShapeDestroy);
+  if (!shape) return NULL;
+
+  lovrRetain(mesh);
+  shape->type = SHAPE_MESH;
+  shape->mesh = mesh;
+  shape->heightfield = NULL;
+  shape->id = dCreateTriMesh(0, mesh->id, NULL, NULL, NULL);
+  dGeomSetData(shape->id, shape);
+
+  return shape;
+}
+
+TriMesh* lovrMeshShapeGetTriMesh(MeshShape* mesh) {
+  return mesh->mesh;
+}
+
+int lovrMeshShapeGetTriangleCount(MeshShape* mesh) {
+  return mesh->mesh->indexCount / 3;
+}
+
+HeightfieldShape* lovrHeightfieldShapeCreate(float* heights, int samplesX, int samplesZ, float width, float depth, float scale) {
+  lovrAssert(samplesX >= 2 && samplesZ >= 2, "Heightfield needs at least 2 samples in each direction");
+  HeightfieldShape* heightfield = lovrAllocPooled(&shapePool, lovrShapeDestroy);
+  if (!heightfield) return NULL;
+
+  float min = heights[0];
+  float max = heights[0];
+  for (int i = 1; i < samplesX * samplesZ; i++) {
+    min = MIN(min, heights[i]);
+    max = MAX(max, heights[i]);
+  }
+
+  heightfield->type = SHAPE_HEIGHTFIELD;
+  heightfield->mesh = NULL;
+  heightfield->heightfield = dGeomHeightfieldDataCreate();
+  dGeomHeightfieldDataBuildSingle(heightfield->heightfield, heights, 1, width, depth, samplesX, samplesZ, scale, 0, 1, 0);
+  dGeomHeightfieldDataSetBounds(heightfield->heightfield, min * scale, max * scale);
+  heightfield->id = dCreateHeightfield(0, heightfield->heightfield, 1);
+  dGeomSetData(heightfield->id, heightfield);
+
+  return heightfield;
+}
+
 void lovrJointDestroy(void* ref) {
   Joint* joint = ref;
   lovrJointDestroyData(joint);
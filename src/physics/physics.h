@@ -1,3 +1,5 @@
+#include "data/modelData.h"
+#include "data/vertexData.h"
 #include "util.h"
 #include "lib/vec/vec.h"
 #include "lib/map/map.h"
@@ -15,7 +17,9 @@ typedef enum {
   SHAPE_SPHERE,
   SHAPE_BOX,
   SHAPE_CAPSULE,
-  SHAPE_CYLINDER
+  SHAPE_CYLINDER,
+  SHAPE_MESH,
+  SHAPE_HEIGHTFIELD
 } ShapeType;
 
 typedef enum {
@@ -25,11 +29,17 @@ typedef enum {
   JOINT_SLIDER
 } JointType;
 
+typedef enum {
+  TRANSFORM_POSE,
+  TRANSFORM_MATRIX
+} TransformFormat;
+
 typedef struct {
   Ref ref;
   dWorldID id;
   dSpaceID space;
   dJointGroupID contactGroup;
+  vec_void_t colliders;
   vec_void_t overlaps;
   map_int_t tags;
   uint16_t masks[MAX_TAGS];
@@ -47,18 +57,31 @@ typedef struct {
   float restitution;
 } Collider;
 
+typedef struct {
+  Ref ref;
+  dTriMeshDataID id;
+  float* vertices;
+  dTriIndex* indices;
+  int vertexCount;
+  int indexCount;
+} TriMesh;
+
 typedef struct {
   Ref ref;
   ShapeType type;
   dGeomID id;
   Collider* collider;
   void* userdata;
+  TriMesh* mesh;
+  dHeightfieldDataID heightfield;
 } Shape;
 
 typedef Shape SphereShape;
 typedef Shape BoxShape;
 typedef Shape CapsuleShape;
 typedef Shape CylinderShape;
+typedef Shape MeshShape;
+typedef Shape HeightfieldShape;
 
 typedef struct {
   Ref ref;
@@ -103,6 +126,9 @@ const char* lovrWorldGetTagName(World* world, int tag);
 int lovrWorldDisableCollisionBetween(World* world, const char* tag1, const char* tag2);
 int lovrWorldEnableCollisionBetween(World* world, const char* tag1, const char* tag2);
 int lovrWorldIsCollisionEnabledBetween(World* world, const char* tag1, const char* tag);
+vec_void_t* lovrWorldGetColliders(World* world);
+size_t lovrWorldGetTransformSize(TransformFormat format);
+void lovrWorldGetColliderTransforms(World* world, Collider** colliders, int count, TransformFormat format, float* dest);
 
 Collider* lovrColliderCreate(World* world, float x, float y, float z);
 void lovrColliderDestroy(void* ref);
@@ -191,6 +217,17 @@ void lovrCylinderShapeSetRadius(CylinderShape* cylinder, float radius);
 float lovrCylinderShapeGetLength(CylinderShape* cylinder);
 void lovrCylinderShapeSetLength(CylinderShape* cylinder, float length);
 
+TriMesh* lovrTriMeshCreate(float* vertices, int vertexCount, uint32_t* indices, int indexCount);
+TriMesh* lovrTriMeshCreateFromModelData(ModelData* modelData);
+TriMesh* lovrTriMeshCreateFromVertexData(VertexData* vertexData, uint32_t* indices, int indexCount);
+void lovrTriMeshDestroy(void* ref);
+
+MeshShape* lovrMeshShapeCreate(TriMesh* mesh);
+TriMesh* lovrMeshShapeGetTriMesh(MeshShape* mesh);
+int lovrMeshShapeGetTriangleCount(MeshShape* mesh);
+
+HeightfieldShape* lovrHeightfieldShapeCreate(float* heights, int samplesX, int samplesZ, float width, float depth, float scale);
+
 void lovrJointDestroy(void* ref);
 void lovrJointDestroyData(Joint* joint);
 JointType lovrJointGetType(Joint* joint);
@@ -10,11 +10,26 @@ local conf = {
     thread = true,
     timer = true
   },
+  audio = {
+    device = nil
+  },
+  benchmark = {
+    frames = 0,
+    dt = 1 / 90,
+    report = 'benchmark.json'
+  },
   gammacorrect = false,
   headset = {
     drivers = { 'openvr', 'webvr', 'fake' },
     mirror = true,
-    offset = 1.7
+    offset = 1.7,
+    stereo = 'multipass',
+    record = nil,
+    replay = nil
+  },
+  timer = {
+    framerate = 0,
+    smoothing = 'none'
   },
   window = {
     width = 800,
@@ -22,7 +37,8 @@ local conf = {
     fullscreen = false,
     msaa = 0,
     title = 'LÖVR',
-    icon = nil
+    icon = nil,
+    visible = true
   }
 }
 
@@ -33,7 +49,8 @@ end
 function lovr.errhand(message)
   message = 'Error:\n' .. message:gsub('\n[^\n]+$', ''):gsub('\t', ''):gsub('stack traceback', '\nStack')
   print(message)
-  if not lovr.graphics then return end
+  -- Without a visible window nothing can show the error or send the quit that ends the loop below
+  if not lovr.graphics or conf.benchmark.frames > 0 or (conf.window and conf.window.visible == false) then return end
   lovr.graphics.reset()
   lovr.graphics.setBackgroundColor(.105, .098, .137)
   lovr.graphics.setColor(.863, .863, .863)
@@ -131,6 +148,39 @@ if lovr.filesystem.isFile('conf.lua') then
   end
 end
 
+-- lovr <project> --benchmark [frames] --record <file> --replay <file>
+for i = 1, #arg do
+  if arg[i] == '--benchmark' then
+    conf.benchmark.frames = tonumber(arg[i + 1]) or 600
+  elseif arg[i] == '--record' then
+    conf.headset = conf.headset or {}
+    conf.headset.record = arg[i + 1]
+  elseif arg[i] == '--replay' then
+    conf.headset = conf.headset or {}
+    conf.headset.replay = arg[i + 1]
+  end
+end
+
+-- A replay file, from conf.lua or the command line, selects the replay driver ahead of the others
+if conf.headset and conf.headset.replay then
+  local drivers = conf.headset.drivers or {}
+  if drivers[1] ~= 'replay' then
+    conf.headset.drivers = { 'replay', unpack(drivers) }
+  end
+end
+
+-- Benchmarks run headless with a hidden window, the fake headset and no audio output
+local benchmarking = conf.benchmark and conf.benchmark.frames > 0
+if benchmarking then
+  conf.window = conf.window or {}
+  conf.window.visible = false
+  conf.headset = conf.headset or {}
+  conf.headset.drivers = conf.headset.replay and { 'replay', 'fake' } or { 'fake' }
+  conf.headset.mirror = false
+  conf.audio = conf.audio or {}
+  conf.audio.device = 'No Output'
+end
+
 lovr._setConf(conf)
 
 lovr.filesystem.setIdentity(conf.identity)
@@ -147,6 +197,10 @@ if confError then
   error(confError)
 end
 
+if lovr.headset and conf.headset and conf.headset.record then
+  lovr.headset.startRecording(conf.headset.record)
+end
+
 lovr.handlers = setmetatable({}, { __index = lovr })
 
 local function headsetRenderCallback(eye)
@@ -176,21 +230,30 @@ function lovr.step()
       lovr.audio.setVelocity(lovr.headset.getVelocity())
     end
   end
-  if lovr.update then lovr.update(dt) end
+  if lovr.update then
+    lovr.timer.push('update')
+    lovr.update(dt)
+    lovr.timer.pop()
+  end
   if lovr.graphics then
     lovr.graphics.clear()
     lovr.graphics.origin()
     if lovr.draw then
+      lovr.timer.push('draw')
       if lovr.headset then
         lovr.headset.renderTo(headsetRenderCallback)
       else
         applyHeadsetOffset()
         lovr.draw()
       end
+      lovr.timer.pop()
     end
     lovr.graphics.present()
   end
-  lovr.timer.sleep(.001)
+  -- Presenting (or a target framerate) is what throttles the loop, only yield when neither happens
+  if not benchmarking and not lovr.graphics and not lovr.timer.getTargetDelta() then
+    lovr.timer.sleep(.001)
+  end
 end
 
 function lovr.run()
@@ -202,6 +265,98 @@ function lovr.run()
   end
 end
 
+local function percentile(sorted, p)
+  return sorted[math.max(1, math.ceil(#sorted * p))]
+end
+
+-- Runs a fixed number of frames with a fixed dt and writes a JSON report to the save directory
+local function benchmark()
+  local options = conf.benchmark
+  local report = {
+    os = lovr.getOS(),
+    version = table.concat({ lovr.getVersion() }, '.'),
+    dt = options.dt,
+    frames = {},
+    scopes = {},
+    graphics = {}
+  }
+
+  -- A replay sets the dt of every frame to the one it was recorded with
+  if not (lovr.headset and lovr.headset.getDriver() == 'replay') then
+    lovr.timer.setFixedDelta(options.dt)
+  end
+  lovr.timer.setTargetDelta()
+  lovr.timer.setProfilerEnabled(true)
+  if lovr.headset then lovr.headset.resetPoseStats() end
+  lovr.timer.step()
+  if lovr.load then lovr.load() end
+
+  local times = {}
+  for i = 1, options.frames do
+    local start = lovr.timer.getTime()
+    local exit = lovr.step()
+    local frame = { time = lovr.timer.getTime() - start }
+
+    for _, event in ipairs(lovr.timer.getProfile()) do
+      local key = event.track .. ':' .. event.name
+      local scope = report.scopes[key] or { total = 0, max = 0, count = 0 }
+      scope.total = scope.total + event.duration
+      scope.max = math.max(scope.max, event.duration)
+      scope.count = scope.count + 1
+      report.scopes[key] = scope
+    end
+
+    if lovr.graphics then
+      frame.stats = {}
+      for stat in pairs(lovr.graphics.getStats()) do
+        local value = lovr.graphics.getStatsHistory(stat, 1)[1] or 0
+        frame.stats[stat] = value
+        report.graphics[stat] = (report.graphics[stat] or 0) + value
+      end
+    end
+
+    table.insert(report.frames, frame)
+    table.insert(times, frame.time)
+    if exit then break end
+  end
+
+  local count = #times
+  local total = 0
+  for _, time in ipairs(times) do total = total + time end
+  table.sort(times)
+  report.summary = {
+    frames = count,
+    mean = count > 0 and total / count or 0,
+    min = times[1] or 0,
+    max = times[count] or 0,
+    p50 = count > 0 and percentile(times, .5) or 0,
+    p95 = count > 0 and percentile(times, .95) or 0,
+    p99 = count > 0 and percentile(times, .99) or 0
+  }
+
+  for _, scope in pairs(report.scopes) do
+    scope.mean = scope.total / math.max(count, 1)
+  end
+
+  for stat, value in pairs(report.graphics) do
+    report.graphics[stat] = value / math.max(count, 1)
+  end
+
+  if lovr.headset then
+    report.pose = lovr.headset.getPoseStats()
+  end
+
+  lovr.timer.setProfilerEnabled(false)
+  lovr.filesystem.write(options.report, require('json').encode(report))
+  print(('Benchmark: %d frames, %.3fms mean, %.3fms p99 -> %s/%s'):format(count, report.summary.mean * 1000,
+    report.summary.p99 * 1000, lovr.filesystem.getSaveDirectory(), options.report))
+  return 0
+end
+
 if lovr.filesystem.isFile('main.lua') then
   require('main')
 end
+
+if benchmarking then
+  lovr.run = benchmark
+end
@@ -44,6 +44,10 @@ const char* lovrShaderVertexPrefix = ""
 "uniform mat3 lovrNormalMatrix; \n"
 "uniform float lovrPointSize; \n"
 "uniform mat4 lovrPose[MAX_BONES]; \n"
+"uniform int lovrStereo; \n"
+"uniform mat4 lovrStereoTransforms[2]; \n"
+"uniform mat4 lovrStereoProjections[2]; \n"
+"int lovrInstanceID; \n"
 "#line 0 \n";
 
 const char* lovrShaderFragmentPrefix = ""
@@ -81,7 +85,23 @@ const char* lovrShaderVertexSuffix = ""
 "    lovrPose[lovrBones[2]] * lovrBoneWeights[2] + \n"
 "    lovrPose[lovrBones[3]] * lovrBoneWeights[3]; \n"
 "  gl_PointSize = lovrPointSize; \n"
+#ifdef EMSCRIPTEN
+"  lovrInstanceID = gl_InstanceID; \n"
 "  gl_Position = position(lovrProjection, lovrTransform, pose * vec4(lovrPosition, 1.0)); \n"
+#else
+"  if (lovrStereo != 0) { \n"
+"    int eye = gl_InstanceID % 2; \n"
+"    lovrInstanceID = gl_InstanceID / 2; \n"
+"    vec4 clip = position(lovrStereoProjections[eye], lovrStereoTransforms[eye], pose * vec4(lovrPosition, 1.0)); \n"
+"    clip.x = clip.x * .5 + (eye == 0 ? -.5 : .5) * clip.w; \n"
+"    gl_ClipDistance[0] = eye == 0 ? -clip.x : clip.x; \n"
+"    gl_Position = clip; \n"
+"  } else { \n"
+"    lovrInstanceID = gl_InstanceID; \n"
+"    gl_ClipDistance[0] = 1.; \n"
+"    gl_Position = position(lovrProjection, lovrTransform, pose * vec4(lovrPosition, 1.0)); \n"
+"  } \n"
+#endif
 "}";
 
 const char* lovrShaderFragmentSuffix = ""
@@ -7,6 +7,7 @@ Channel* lovrChannelCreate() {
   Channel* channel = lovrAlloc(sizeof(Channel), lovrChannelDestroy);
   if (!channel) return NULL;
 
+  lovrShare(channel);
   vec_init(&channel->messages);
   mtx_init(&channel->lock, mtx_plain | mtx_timed);
   cnd_init(&channel->cond);
@@ -33,6 +33,7 @@ Thread* lovrThreadCreate(int (*runner)(void*), const char* body) {
   Thread* thread = lovrAlloc(sizeof(Thread), lovrThreadDestroy);
   if (!thread) return NULL;
 
+  lovrShare(thread);
   thread->runner = runner;
   thread->body = body;
   thread->error = NULL;
@@ -46,6 +47,7 @@ void lovrThreadDestroy(void* ref) {
   Thread* thread = ref;
   mtx_destroy(&thread->lock);
   thrd_detach(thread->handle);
+  free(thread->error);
   free(thread);
 }
 
@@ -17,7 +17,7 @@ typedef struct {
   mtx_t lock;
   int (*runner)(void*);
   const char* body;
-  const char* error;
+  char* error;
   bool running;
 } Thread;
 
@@ -0,0 +1,152 @@
+#include "timer/profiler.h"
+#include "math/math.h"
+#include "util.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static ProfilerState state;
+
+void lovrProfilerDestroy() {
+  vec_deinit(&state.frame);
+  vec_deinit(&state.lastFrame);
+  vec_deinit(&state.trace);
+  memset(&state, 0, sizeof(ProfilerState));
+}
+
+// Only the thread that enabled the profiler records scopes, so modules used from other threads
+// (e.g. a World updated on a Thread) don't need to synchronize with it
+bool lovrProfilerIsEnabled() {
+  return state.enabled && thrd_equal(thrd_current(), state.thread);
+}
+
+void lovrProfilerSetEnabled(bool enabled) {
+  if (enabled && !state.enabled) {
+    state.thread = thrd_current();
+    state.epoch = lovrGetTicks() / 1e9;
+    state.depth = 0;
+    vec_clear(&state.frame);
+    vec_clear(&state.lastFrame);
+  }
+
+  state.enabled = enabled;
+}
+
+void lovrProfilerPush(const char* name) {
+  if (!lovrProfilerIsEnabled()) return;
+  lovrAssert(state.depth < MAX_PROFILER_DEPTH, "Profiler scopes are nested too deeply (the maximum is %d)", MAX_PROFILER_DEPTH);
+  state.stack[state.depth] = state.frame.length;
+  lovrProfilerAddEvent(name, PROFILE_CPU, state.depth, lovrGetTicks() / 1e9, 0);
+  state.depth++;
+}
+
+// Popping a scope that was opened before the profiler was enabled is ignored
+void lovrProfilerPop() {
+  if (!lovrProfilerIsEnabled() || state.depth == 0) return;
+  ProfileEvent* event = &state.frame.data[state.stack[--state.depth]];
+  event->duration = lovrGetTicks() / 1e9 - event->start;
+}
+
+void lovrProfilerAddEvent(const char* name, ProfileTrack track, int depth, double start, double duration) {
+  if (!lovrProfilerIsEnabled()) return;
+  ProfileEvent event = { .track = track, .depth = depth, .start = start, .duration = duration };
+  strncpy(event.name, name, MAX_PROFILER_NAME - 1);
+  event.name[MAX_PROFILER_NAME - 1] = '\0';
+  vec_push(&state.frame, event);
+}
+
+// Scopes that are still open at a frame boundary are split, continuing in the next frame
+void lovrProfilerFrame() {
+  if (!lovrProfilerIsEnabled()) return;
+
+  double now = lovrGetTicks() / 1e9;
+  for (int i = 0; i < state.depth; i++) {
+    ProfileEvent* event = &state.frame.data[state.stack[i]];
+    event->duration = now - event->start;
+  }
+
+  if (state.tracing) {
+    vec_extend(&state.trace, &state.frame);
+  }
+
+  vec_profileevent_t lastFrame = state.lastFrame;
+  state.lastFrame = state.frame;
+  state.frame = lastFrame;
+  vec_clear(&state.frame);
+
+  for (int i = 0; i < state.depth; i++) {
+    ProfileEvent event = state.lastFrame.data[state.stack[i]];
+    event.start = now;
+    event.duration = 0;
+    state.stack[i] = state.frame.length;
+    vec_push(&state.frame, event);
+  }
+}
+
+vec_profileevent_t* lovrProfilerGetFrame() {
+  return &state.lastFrame;
+}
+
+double lovrProfilerGetEpoch() {
+  return state.epoch;
+}
+
+bool lovrProfilerIsTracing() {
+  return state.tracing;
+}
+
+void lovrProfilerStartTrace() {
+  lovrProfilerSetEnabled(true);
+  vec_clear(&state.trace);
+  state.tracing = true;
+}
+
+static void lovrProfilerAppend(vec_char_t* buffer, const char* format, ...) {
+  char string[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(string, sizeof(string), format, args);
+  va_end(args);
+  vec_pusharr(buffer, string, MIN(length, (int) sizeof(string) - 1));
+}
+
+// Returns the recorded trace in the Chrome tracing JSON format (chrome://tracing), with one thread
+// for CPU scopes and one for GPU timers.  The caller is responsible for freeing the string.
+char* lovrProfilerStopTrace(size_t* size) {
+  if (!state.tracing) {
+    *size = 0;
+    return NULL;
+  }
+
+  state.tracing = false;
+
+  vec_char_t buffer;
+  vec_init(&buffer);
+  lovrProfilerAppend(&buffer, "{\"traceEvents\":[");
+
+  for (int i = 0; i < state.trace.length; i++) {
+    ProfileEvent* event = &state.trace.data[i];
+
+    char name[2 * MAX_PROFILER_NAME];
+    int length = 0;
+    for (const char* c = event->name; *c; c++) {
+      if (*c == '"' || *c == '\\') {
+        name[length++] = '\\';
+      }
+      name[length++] = (unsigned char) *c < ' ' ? ' ' : *c;
+    }
+    name[length] = '\0';
+
+    double start = (event->start - state.epoch) * 1e6;
+    double duration = event->duration * 1e6;
+    int thread = event->track == PROFILE_GPU ? 2 : 1;
+    const char* separator = i > 0 ? "," : "";
+    lovrProfilerAppend(&buffer, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}", separator, name, start, duration, thread);
+  }
+
+  lovrProfilerAppend(&buffer, "]}\n");
+  vec_clear(&state.trace);
+  *size = buffer.length;
+  return buffer.data;
+}
@@ -0,0 +1,49 @@
+#include "lib/vec/vec.h"
+#include "lib/tinycthread/tinycthread.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#pragma once
+
+#define MAX_PROFILER_DEPTH 32
+#define MAX_PROFILER_NAME 32
+
+typedef enum {
+  PROFILE_CPU,
+  PROFILE_GPU
+} ProfileTrack;
+
+typedef struct {
+  char name[MAX_PROFILER_NAME];
+  ProfileTrack track;
+  int depth;
+  double start;
+  double duration;
+} ProfileEvent;
+
+typedef vec_t(ProfileEvent) vec_profileevent_t;
+
+typedef struct {
+  bool enabled;
+  bool tracing;
+  thrd_t thread;
+  double epoch;
+  int stack[MAX_PROFILER_DEPTH];
+  int depth;
+  vec_profileevent_t frame;
+  vec_profileevent_t lastFrame;
+  vec_profileevent_t trace;
+} ProfilerState;
+
+void lovrProfilerDestroy();
+bool lovrProfilerIsEnabled();
+void lovrProfilerSetEnabled(bool enabled);
+void lovrProfilerPush(const char* name);
+void lovrProfilerPop();
+void lovrProfilerAddEvent(const char* name, ProfileTrack track, int depth, double start, double duration);
+void lovrProfilerFrame();
+vec_profileevent_t* lovrProfilerGetFrame();
+double lovrProfilerGetEpoch();
+bool lovrProfilerIsTracing();
+void lovrProfilerStartTrace();
+char* lovrProfilerStopTrace(size_t* size);
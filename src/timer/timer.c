@@ -1,5 +1,7 @@
 #include "timer/timer.h"
-#include "lib/glfw.h"
+#include "timer/profiler.h"
+#include "allocator.h"
+#include "math/math.h"
 #include "util.h"
 
 static TimerState state;
@@ -7,11 +9,15 @@ static TimerState state;
 void lovrTimerInit() {
   if (state.initialized) return;
   lovrTimerDestroy();
+  state.epoch = lovrGetTicks();
+  state.smoothing = SMOOTH_NONE;
+  state.smoothingAmount = 0;
   state.initialized = true;
 }
 
 void lovrTimerDestroy() {
   if (!state.initialized) return;
+  lovrProfilerDestroy();
   memset(&state, 0, sizeof(TimerState));
 }
 
@@ -20,21 +26,97 @@ double lovrTimerGetDelta() {
 }
 
 double lovrTimerGetTime() {
-  return glfwGetTime();
+  return (lovrGetTicks() - state.epoch) / 1e9;
+}
+
+// Sleeps for most of the wait and spins for the rest, so the deadline is hit precisely without
+// spending the whole frame in a busy loop
+static void lovrTimerWait(uint64_t deadline) {
+  uint64_t threshold = (uint64_t) (PACING_SPIN_THRESHOLD * 1e9);
+  for (;;) {
+    uint64_t now = lovrGetTicks();
+    if (now >= deadline) {
+      break;
+    } else if (deadline - now > threshold) {
+      lovrSleep((deadline - now - threshold) / 1e9);
+    } else {
+      thrd_yield();
+    }
+  }
+}
+
+// Waits out the rest of the frame when there's a target delta.  The next deadline is based on the
+// previous one instead of on the current time so frames don't drift, unless the frame was so late
+// that catching up would mean running several frames back to back.
+static uint64_t lovrTimerPace(uint64_t now) {
+  PacingStats* stats = &state.pacing;
+  uint64_t target = (uint64_t) (state.targetDelta * 1e9);
+
+  if (target == 0 || state.frameStart == 0) {
+    state.frameStart = now;
+    return now;
+  }
+
+  uint64_t deadline = state.frameStart + target;
+  stats->frames++;
+  stats->workTime = (now - state.frameStart) / 1e9;
+
+  if (now < deadline) {
+    lovrTimerWait(deadline);
+    uint64_t end = lovrGetTicks();
+    stats->waitTime = (end - now) / 1e9;
+    stats->lastLateness = 0;
+    state.frameStart = deadline;
+    return end;
+  }
+
+  stats->waitTime = 0;
+  stats->lastLateness = (now - deadline) / 1e9;
+  stats->maxLateness = MAX(stats->maxLateness, stats->lastLateness);
+  stats->lateFrames++;
+  state.frameStart = now - deadline < target ? deadline : now;
+  return now;
+}
+
+static double lovrTimerSmooth(double dt) {
+  switch (state.smoothing) {
+    case SMOOTH_AVERAGE: {
+      int count = CLAMP((int) state.smoothingAmount, 1, TICK_SAMPLES);
+      double sum = 0;
+      for (int i = 0; i < count; i++) {
+        sum += state.tickBuffer[(state.tickIndex - 1 - i + TICK_SAMPLES) % TICK_SAMPLES];
+      }
+      return sum / count;
+    }
+
+    case SMOOTH_EXPONENTIAL:
+      if (state.smoothDelta <= 0) {
+        state.smoothDelta = dt;
+      }
+      state.smoothDelta += (dt - state.smoothDelta) * CLAMP(state.smoothingAmount, 0, 1);
+      return state.smoothDelta;
+
+    default:
+      return dt;
+  }
 }
 
 double lovrTimerStep() {
+  lovrProfilerFrame();
+  lovrMemoryFrame();
+  uint64_t now = lovrTimerPace(lovrGetTicks());
+  double rawDelta = state.time > 0 ? (now - state.epoch) / 1e9 - state.time : 0;
   state.lastTime = state.time;
-  state.time = glfwGetTime();
-  state.dt = state.time - state.lastTime;
+  state.time = (now - state.epoch) / 1e9;
   state.tickSum -= state.tickBuffer[state.tickIndex];
-  state.tickSum += state.dt;
-  state.tickBuffer[state.tickIndex] = state.dt;
+  state.tickSum += rawDelta;
+  state.tickBuffer[state.tickIndex] = rawDelta;
   state.averageDelta = state.tickSum / TICK_SAMPLES;
   state.fps = (int) (1 / (state.tickSum / TICK_SAMPLES) + .5);
   if (++state.tickIndex == TICK_SAMPLES) {
     state.tickIndex = 0;
   }
+  state.dt = state.fixedDelta > 0 ? state.fixedDelta : lovrTimerSmooth(rawDelta);
   return state.dt;
 }
 
@@ -46,6 +128,45 @@ int lovrTimerGetFPS() {
   return state.fps;
 }
 
+// With a fixed delta, every step reports the same dt regardless of how long frames actually take
+double lovrTimerGetFixedDelta() {
+  return state.fixedDelta;
+}
+
+void lovrTimerSetFixedDelta(double delta) {
+  state.fixedDelta = delta > 0 ? delta : 0;
+}
+
+// A target delta makes lovrTimerStep wait until at least that much time has passed since the start
+// of the previous frame.  This is separate from the fixed delta, which only changes the reported dt.
+double lovrTimerGetTargetDelta() {
+  return state.targetDelta;
+}
+
+void lovrTimerSetTargetDelta(double delta) {
+  state.targetDelta = delta > 0 ? delta : 0;
+  state.frameStart = 0;
+}
+
+void lovrTimerGetSmoothing(TimerSmoothing* smoothing, double* amount) {
+  *smoothing = state.smoothing;
+  *amount = state.smoothingAmount;
+}
+
+void lovrTimerSetSmoothing(TimerSmoothing smoothing, double amount) {
+  state.smoothing = smoothing;
+  state.smoothingAmount = amount;
+  state.smoothDelta = 0;
+}
+
+PacingStats* lovrTimerGetPacingStats() {
+  return &state.pacing;
+}
+
+void lovrTimerResetPacingStats() {
+  memset(&state.pacing, 0, sizeof(PacingStats));
+}
+
 void lovrTimerSleep(double seconds) {
   lovrSleep(seconds);
 }
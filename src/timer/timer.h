@@ -1,11 +1,33 @@
 #include <stdbool.h>
+#include <stdint.h>
 
 #pragma once
 
 #define TICK_SAMPLES 90
 
+// The frame pacer sleeps until it's this close to the deadline and then spins, since sleeps can
+// overshoot by about a millisecond on most platforms
+#define PACING_SPIN_THRESHOLD 2e-3
+
+typedef enum {
+  SMOOTH_NONE,
+  SMOOTH_AVERAGE,
+  SMOOTH_EXPONENTIAL
+} TimerSmoothing;
+
+typedef struct {
+  uint64_t frames;
+  uint64_t lateFrames;
+  double lastLateness;
+  double maxLateness;
+  double workTime;
+  double waitTime;
+} PacingStats;
+
 typedef struct {
   bool initialized;
+  uint64_t epoch;
+  uint64_t frameStart;
   double lastTime;
   double time;
   double dt;
@@ -14,6 +36,12 @@ typedef struct {
   double tickBuffer[TICK_SAMPLES];
   double averageDelta;
   int fps;
+  double fixedDelta;
+  double targetDelta;
+  TimerSmoothing smoothing;
+  double smoothingAmount;
+  double smoothDelta;
+  PacingStats pacing;
 } TimerState;
 
 void lovrTimerInit();
@@ -23,4 +51,12 @@ double lovrTimerGetTime();
 double lovrTimerStep();
 double lovrTimerGetAverageDelta();
 int lovrTimerGetFPS();
+double lovrTimerGetFixedDelta();
+void lovrTimerSetFixedDelta(double delta);
+double lovrTimerGetTargetDelta();
+void lovrTimerSetTargetDelta(double delta);
+void lovrTimerGetSmoothing(TimerSmoothing* smoothing, double* amount);
+void lovrTimerSetSmoothing(TimerSmoothing smoothing, double amount);
+PacingStats* lovrTimerGetPacingStats();
+void lovrTimerResetPacingStats();
 void lovrTimerSleep(double seconds);
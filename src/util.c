@@ -1,10 +1,12 @@
 #include "util.h"
+#include "allocator.h"
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #ifdef _WIN32
 #include <Windows.h>
 #else
+#include <time.h>
 #include <unistd.h>
 #endif
 
@@ -34,20 +36,57 @@ void lovrSleep(double seconds) {
 #endif
 }
 
+// Monotonic time in nanoseconds, from an unspecified starting point.  Safe to call from any thread.
+uint64_t lovrGetTicks() {
+#ifdef _WIN32
+  static LARGE_INTEGER frequency;
+  LARGE_INTEGER counter;
+  if (!frequency.QuadPart) {
+    QueryPerformanceFrequency(&frequency);
+  }
+  QueryPerformanceCounter(&counter);
+  return (uint64_t) (counter.QuadPart / frequency.QuadPart) * 1000000000ULL + (uint64_t) (counter.QuadPart % frequency.QuadPart) * 1000000000ULL / frequency.QuadPart;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
 void* lovrAlloc(size_t size, void (*destructor)(void* object)) {
   void* object = malloc(size);
   if (!object) return NULL;
-  *((Ref*) object) = (Ref) { destructor, 1 };
+  *((Ref*) object) = (Ref) { destructor, 1, 0, false };
+  lovrMemoryCount();
   return object;
 }
 
 void lovrRetain(void* object) {
-  if (object) ((Ref*) object)->count++;
+  Ref* ref = object;
+  if (!ref) return;
+
+  if (ref->shared) {
+    lovrAtomicIncrement(&ref->count);
+  } else {
+    ref->count++;
+  }
 }
 
 void lovrRelease(void* object) {
   Ref* ref = object;
-  if (ref && --ref->count == 0) ref->free(object);
+  if (!ref) return;
+
+  int count = ref->shared ? lovrAtomicDecrement(&ref->count) : --ref->count;
+  if (count == 0) {
+    ref->free(object);
+  }
+}
+
+// Switches an object over to atomic reference counting.  This has to happen on the thread that
+// owns the object, before it's published to another thread (e.g. while a Channel lock is held).
+// Objects never go back to being unshared.
+void lovrShare(void* object) {
+  if (object) ((Ref*) object)->shared = true;
 }
 
 // https://github.com/starwing/luautf8
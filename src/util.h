@@ -1,18 +1,35 @@
 #include "lib/vec/vec.h"
 #include "lib/tinycthread/tinycthread.h"
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <setjmp.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 #pragma once
 
 #define lovrAssert(c, ...) if (!(c)) { lovrThrow(__VA_ARGS__); }
 
+// Increments are relaxed since taking a reference never publishes anything.  The decrement that
+// drops the last reference has to see every write made through the other references, so it is
+// acquire/release.
+#ifdef _MSC_VER
+#define lovrAtomicIncrement(p) _InterlockedIncrement((volatile long*) (p))
+#define lovrAtomicDecrement(p) _InterlockedDecrement((volatile long*) (p))
+#else
+#define lovrAtomicIncrement(p) __atomic_add_fetch((p), 1, __ATOMIC_RELAXED)
+#define lovrAtomicDecrement(p) __atomic_sub_fetch((p), 1, __ATOMIC_ACQ_REL)
+#endif
+
 typedef vec_t(unsigned int) vec_uint_t;
 
 typedef struct ref {
   void (*free)(void* object);
   int count;
+  int handles;
+  bool shared;
 } Ref;
 
 typedef struct {
@@ -24,7 +41,9 @@ extern _Thread_local jmp_buf* lovrCatch;
 
 void lovrThrow(const char* format, ...);
 void lovrSleep(double seconds);
+uint64_t lovrGetTicks();
 void* lovrAlloc(size_t size, void (*destructor)(void* object));
 void lovrRetain(void* object);
 void lovrRelease(void* object);
+void lovrShare(void* object);
 size_t utf8_decode(const char *s, const char *e, unsigned *pch);
@@ -0,0 +1,149 @@
+#include "test.h"
+#include "luax.h"
+#include <stdlib.h>
+
+// Enum conversions in the Lua bindings.  The benchmark times them against the alternatives: walking
+// the map to push a value, and looking strings up in a Lua table through the C API, which was
+// slower than hashing the string into the map.  The enum matches lovr.graphics' BlendModes.
+
+static map_int_t BlendModes;
+static const char* blendModes[] = { "add", "alpha", "darken", "lighten", "multiply", "replace", "screen", "subtract" };
+
+static int l_check(lua_State* L) {
+  lua_pushinteger(L, *(int*) luax_checkenum(L, 1, &BlendModes, "blend mode"));
+  return 1;
+}
+
+static int l_opt(lua_State* L) {
+  lua_pushinteger(L, *(int*) luax_optenum(L, 1, "alpha", &BlendModes, "blend mode"));
+  return 1;
+}
+
+static int l_push(lua_State* L) {
+  luax_pushenum(L, &BlendModes, luaL_checkint(L, 1));
+  return 1;
+}
+
+// Strings looked up in a registry table of interned strings instead of the map
+static char tableKey;
+
+static int l_checkTable(lua_State* L) {
+  lua_pushlightuserdata(L, &tableKey);
+  lua_rawget(L, LUA_REGISTRYINDEX);
+  lua_pushvalue(L, 1);
+  lua_rawget(L, -2);
+  if (lua_isnil(L, -1)) {
+    return luaL_error(L, "Invalid blend mode '%s'", luaL_checkstring(L, 1));
+  }
+  return 1;
+}
+
+static int l_pushWalk(lua_State* L) {
+  int value = luaL_checkint(L, 1);
+  const char* key;
+  map_iter_t iter = map_iter(&BlendModes);
+  while ((key = map_next(&BlendModes, &iter))) {
+    if (*map_get(&BlendModes, key) == value) {
+      lua_pushstring(L, key);
+      return 1;
+    }
+  }
+  lua_pushnil(L);
+  return 1;
+}
+
+// Runs a chunk that returns whether it passed, printing the error if it threw
+static bool run(lua_State* L, const char* code) {
+  if (luaL_loadstring(L, code) || lua_pcall(L, 0, 1, 0)) {
+    printf("%s\n", lua_tostring(L, -1));
+    lua_pop(L, 1);
+    return false;
+  }
+
+  bool passed = lua_toboolean(L, -1);
+  lua_pop(L, 1);
+  return passed;
+}
+
+static void testConversions(lua_State* L) {
+  // Twice, so the second pass pushes from the cache the first one built
+  check(run(L,
+    "for pass = 1, 2 do"
+    "  for i, name in ipairs(blendModes) do"
+    "    if check(name) ~= i - 1 or push(i - 1) ~= name then return false end"
+    "  end "
+    "end "
+    "return true"
+  ), "Enums didn't round trip between strings and values");
+
+  check(run(L, "return opt() == check('alpha') and opt(nil) == check('alpha') and opt('screen') == check('screen')"), "Optional enums didn't fall back to the default");
+  check(run(L, "return push(1000) == nil"), "Pushing a value that isn't in the enum didn't push nil");
+
+  check(run(L,
+    "local ok, err = pcall(check, 'sideways') "
+    "return not ok and err:find(\"Invalid blend mode 'sideways'\", 1, true) ~= nil"
+  ), "An invalid enum didn't raise the right error");
+
+  check(run(L, "local ok = pcall(check, {}) return not ok"), "A table was accepted as an enum");
+}
+
+// Values added to the map after the cache was built still resolve in both directions
+static void testLateValues(lua_State* L) {
+  map_set(&BlendModes, "custom", 42);
+  check(run(L, "return check('custom') == 42 and push(42) == 'custom' and check('custom') == 42"), "A value added after the cache was built wasn't found");
+}
+
+// Calls per second from a Lua loop, which is how the bindings are actually used
+static void benchmark(lua_State* L) {
+  const char* loops[] = {
+    "for i = 1, 2000000 do check('multiply') end return true",
+    "for i = 1, 2000000 do checkTable('multiply') end return true",
+    "for i = 1, 2000000 do opt() end return true",
+    "for i = 1, 2000000 do push(7) end return true",
+    "for i = 1, 2000000 do pushWalk(7) end return true"
+  };
+
+  const char* names[] = { "check", "check (Lua table)", "opt (default)", "push", "push (walk map)" };
+
+  for (int i = 0; i < 5; i++) {
+    double start = testSeconds();
+    run(L, loops[i]);
+    double elapsed = testSeconds() - start;
+    printf("%-18s %6.2f ns/call\n", names[i], elapsed * 1e9 / 2000000);
+  }
+}
+
+int main(int argc, char** argv) {
+  map_init(&BlendModes);
+  lua_State* L = luaL_newstate();
+  luaL_openlibs(L);
+
+  lua_pushlightuserdata(L, &tableKey);
+  lua_createtable(L, 0, 8);
+  lua_createtable(L, 8, 0);
+  for (int i = 0; i < 8; i++) {
+    map_set(&BlendModes, blendModes[i], i);
+    lua_pushstring(L, blendModes[i]);
+    lua_rawseti(L, -2, i + 1);
+    lua_pushinteger(L, i);
+    lua_setfield(L, -3, blendModes[i]);
+  }
+  lua_setglobal(L, "blendModes");
+  lua_rawset(L, LUA_REGISTRYINDEX);
+  lua_register(L, "check", l_check);
+  lua_register(L, "opt", l_opt);
+  lua_register(L, "push", l_push);
+  lua_register(L, "checkTable", l_checkTable);
+  lua_register(L, "pushWalk", l_pushWalk);
+
+  testConversions(L);
+  testLateValues(L);
+
+  if (testWantsBenchmarks(argc, argv)) {
+    benchmark(L);
+  }
+
+  lua_close(L);
+  map_deinit(&BlendModes);
+  return testFailures;
+}
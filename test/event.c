@@ -0,0 +1,163 @@
+#include "test.h"
+#include "event/event.h"
+#include "math/math.h"
+#include <stdlib.h>
+
+// Several threads flood the event queue while the main thread drains it, once in each overflow
+// mode.  Each event carries a sequence number, a string and a reference to a shared object, so
+// the test can tell when events are lost, reordered, or dropped without releasing what they own.
+
+#define PRODUCERS 4
+#define EVENTS_PER_PRODUCER 50000
+#define TOTAL_EVENTS (PRODUCERS * EVENTS_PER_PRODUCER)
+#define BATCH_SIZE 64
+
+static Ref* payload;
+static int lastSequence[PRODUCERS];
+
+static void lovrPayloadDestroy(void* ref) {
+  //
+}
+
+static int produce(void* userdata) {
+  int producer = (int) (intptr_t) userdata;
+  for (int i = 0; i < EVENTS_PER_PRODUCER; i++) {
+    Event event = { .type = EVENT_CUSTOM };
+    strcpy(event.data.custom.name, "flood");
+    event.data.custom.data[0].type = TYPE_NUMBER;
+    event.data.custom.data[0].value.number = producer * EVENTS_PER_PRODUCER + i;
+    event.data.custom.data[1].type = TYPE_STRING;
+    event.data.custom.data[1].value.string = strdup("payload");
+    event.data.custom.data[2].type = TYPE_OBJECT;
+    event.data.custom.data[2].value.ref = payload;
+    event.data.custom.count = 3;
+    lovrRetain(payload);
+    lovrEventPush(event);
+  }
+  return 0;
+}
+
+// Returns the number of events received, checking that each producer's events arrive in order
+static int consume(Event* events, int count, bool allowGaps) {
+  for (int i = 0; i < count; i++) {
+    Event* event = &events[i];
+    int sequence = (int) event->data.custom.data[0].value.number;
+    int producer = sequence / EVENTS_PER_PRODUCER;
+    int index = sequence % EVENTS_PER_PRODUCER;
+    bool inOrder = allowGaps ? index > lastSequence[producer] : index == lastSequence[producer] + 1;
+    check(inOrder, "Producer %d's event %d arrived after event %d", producer, index, lastSequence[producer]);
+    lastSequence[producer] = index;
+    lovrEventDestroyData(event);
+  }
+  return count;
+}
+
+static void flood(EventOverflow overflow, const char* name) {
+  // A queue that grew stays grown, so each mode starts with a new one
+  lovrEventDestroy();
+  lovrEventInit();
+  lovrEventSetOverflow(overflow);
+  for (int i = 0; i < PRODUCERS; i++) {
+    lastSequence[i] = -1;
+  }
+
+  thrd_t threads[PRODUCERS];
+  for (int i = 0; i < PRODUCERS; i++) {
+    thrd_create(&threads[i], produce, (void*) (intptr_t) i);
+  }
+
+  // Polling slowly lets the queue fill up so the overflow mode actually kicks in
+  Event events[BATCH_SIZE];
+  int received = 0;
+  int maxCount = 0;
+  for (int i = 0; i < 200; i++) {
+    maxCount = MAX(maxCount, lovrEventGetCount());
+    received += consume(events, lovrEventPollBatch(events, BATCH_SIZE), overflow == OVERFLOW_DROP);
+    lovrSleep(.0005);
+  }
+
+  // Blocked producers only finish once the queue is drained, so drain before joining them
+  while (received + (int) lovrEventGetDropped() < TOTAL_EVENTS) {
+    received += consume(events, lovrEventPollBatch(events, BATCH_SIZE), overflow == OVERFLOW_DROP);
+  }
+
+  for (int i = 0; i < PRODUCERS; i++) {
+    thrd_join(threads[i], NULL);
+  }
+
+  int dropped = (int) lovrEventGetDropped();
+  check(lovrEventGetCount() == 0, "%s: %d events were left over", name, lovrEventGetCount());
+  printf("%-6s received %d, dropped %d, peak queue length %d\n", name, received, dropped, maxCount);
+  check(received + dropped == TOTAL_EVENTS, "%s: %d events received and %d dropped, expected %d in total", name, received, dropped, TOTAL_EVENTS);
+  check(payload->count == 1, "%s: payload has %d references after the flood, expected 1", name, payload->count);
+
+  if (overflow != OVERFLOW_DROP) {
+    check(dropped == 0, "%s: %d events were dropped", name, dropped);
+  }
+
+  if (overflow != OVERFLOW_GROW) {
+    check(maxCount <= EVENT_QUEUE_SIZE, "%s: queue grew to %d events", name, maxCount);
+  }
+}
+
+// Clearing the queue releases whatever the events own
+static void testClear() {
+  lovrEventSetOverflow(OVERFLOW_GROW);
+  produce((void*) 0);
+
+  // Thread errors own a copy of the error as well as the thread
+  Event error = { .type = EVENT_THREAD_ERROR };
+  error.data.threaderror.thread = (Thread*) payload;
+  error.data.threaderror.error = strdup("error");
+  lovrRetain(payload);
+  lovrEventPush(error);
+
+  check(lovrEventGetCount() == EVENTS_PER_PRODUCER + 1, "Queue has %d events instead of %d", lovrEventGetCount(), EVENTS_PER_PRODUCER + 1);
+  lovrEventClear();
+  check(lovrEventGetCount() == 0, "Queue has %d events after clearing", lovrEventGetCount());
+  check(payload->count == 1, "Payload has %d references after clearing, expected 1", payload->count);
+}
+
+// Events per second through one producer, polled one at a time and in batches
+static void benchmark() {
+  lovrEventSetOverflow(OVERFLOW_BLOCK);
+  Event events[BATCH_SIZE];
+
+  int batchSizes[] = { 1, BATCH_SIZE };
+  for (int j = 0; j < 2; j++) {
+    int batch = batchSizes[j];
+    for (int i = 0; i < PRODUCERS; i++) {
+      lastSequence[i] = -1;
+    }
+
+    double start = testSeconds();
+    thrd_t thread;
+    thrd_create(&thread, produce, (void*) 0);
+    int received = 0;
+    while (received < EVENTS_PER_PRODUCER) {
+      received += consume(events, lovrEventPollBatch(events, batch), false);
+    }
+    thrd_join(thread, NULL);
+    double elapsed = testSeconds() - start;
+    printf("poll batch of %-2d %10.0f events/s\n", batch, EVENTS_PER_PRODUCER / elapsed);
+  }
+}
+
+int main(int argc, char** argv) {
+  payload = lovrAlloc(sizeof(Ref), lovrPayloadDestroy);
+  lovrShare(payload);
+
+  flood(OVERFLOW_GROW, "grow");
+  flood(OVERFLOW_DROP, "drop");
+  flood(OVERFLOW_BLOCK, "block");
+  testClear();
+
+  if (testWantsBenchmarks(argc, argv)) {
+    benchmark();
+  }
+
+  lovrRelease(payload);
+  free(payload);
+  lovrEventDestroy();
+  return testFailures;
+}
@@ -0,0 +1,230 @@
+#include "test.h"
+#include "lib/map/map.h"
+#include <stdlib.h>
+
+// Checks the open addressing map behind map_t, and compares its lookups against the chained map it
+// replaced on the kinds of keys lovr actually uses: shader uniforms, model nodes and font kerning.
+
+typedef struct chained_node_t chained_node_t;
+
+typedef struct {
+  chained_node_t** buckets;
+  unsigned nbuckets, nnodes;
+} chained_map_t;
+
+void chained_map_deinit(chained_map_t* m);
+void* chained_map_get(chained_map_t* m, const char* key);
+int chained_map_set(chained_map_t* m, const char* key, void* value, int vsize);
+
+#define COUNT 10000
+
+static char keys[COUNT][32];
+
+static void testSetGet() {
+  map_int_t map;
+  map_init(&map);
+  check(map_get(&map, "missing") == NULL, "Empty map found a key");
+  map_remove(&map, "missing");
+
+  for (int i = 0; i < COUNT; i++) {
+    map_set(&map, keys[i], i);
+  }
+
+  int wrong = 0;
+  for (int i = 0; i < COUNT; i++) {
+    int* value = map_get(&map, keys[i]);
+    wrong += !value || *value != i;
+  }
+  check(wrong == 0, "%d of %d keys had the wrong value", wrong, COUNT);
+  check(map.base.nnodes == COUNT, "Map has %d entries instead of %d", map.base.nnodes, COUNT);
+
+  // Setting an existing key replaces the value without adding an entry
+  map_set(&map, keys[0], -1);
+  check(*map_get(&map, keys[0]) == -1, "Setting an existing key didn't replace its value");
+  check(map.base.nnodes == COUNT, "Replacing a value added an entry");
+  map_deinit(&map);
+}
+
+// map_get pointers are kept around (by the enum cache, the filesystem index and the animator), so
+// values can't move when the table grows
+static void testStability() {
+  map_int_t map;
+  map_init(&map);
+  map_set(&map, keys[0], 0);
+  int* first = map_get(&map, keys[0]);
+
+  for (int i = 1; i < COUNT; i++) {
+    map_set(&map, keys[i], i);
+  }
+
+  check(map_get(&map, keys[0]) == first, "A value moved when the map grew");
+  check(*first == 0, "A value changed when the map grew");
+  map_deinit(&map);
+}
+
+// Removing shifts later entries back, so every other key has to stay reachable
+static void testRemove() {
+  map_int_t map;
+  map_init(&map);
+  for (int i = 0; i < COUNT; i++) {
+    map_set(&map, keys[i], i);
+  }
+
+  uint32_t seed = 1;
+  bool removed[COUNT] = { false };
+  for (int i = 0; i < COUNT / 2; i++) {
+    int index = (int) (testRandom(&seed) * COUNT);
+    if (!removed[index]) {
+      map_remove(&map, keys[index]);
+      removed[index] = true;
+    }
+  }
+
+  int wrong = 0, remaining = 0;
+  for (int i = 0; i < COUNT; i++) {
+    int* value = map_get(&map, keys[i]);
+    wrong += removed[i] ? value != NULL : (!value || *value != i);
+    remaining += !removed[i];
+  }
+  check(wrong == 0, "%d keys were wrong after removing some of them", wrong);
+  check(map.base.nnodes == (unsigned) remaining, "Map has %d entries instead of %d", map.base.nnodes, remaining);
+
+  for (int i = 0; i < COUNT; i++) {
+    if (removed[i]) {
+      map_set(&map, keys[i], i);
+    }
+  }
+
+  wrong = 0;
+  for (int i = 0; i < COUNT; i++) {
+    int* value = map_get(&map, keys[i]);
+    wrong += !value || *value != i;
+  }
+  check(wrong == 0, "%d keys were wrong after adding the removed ones back", wrong);
+  map_deinit(&map);
+}
+
+static void testIterate() {
+  map_int_t map;
+  map_init(&map);
+
+  const char* key;
+  map_iter_t iter = map_iter(&map);
+  check(map_next(&map, &iter) == NULL, "Iterating an empty map returned a key");
+
+  for (int i = 0; i < COUNT; i++) {
+    map_set(&map, keys[i], i);
+  }
+
+  int count = 0;
+  static bool seen[COUNT];
+  iter = map_iter(&map);
+  while ((key = map_next(&map, &iter)) != NULL) {
+    int value = *map_get(&map, key);
+    check(!seen[value], "Iteration visited %s twice", key);
+    seen[value] = true;
+    count++;
+  }
+  check(count == COUNT, "Iteration visited %d keys instead of %d", count, COUNT);
+  map_deinit(&map);
+}
+
+// Benchmarks
+
+#define LOOKUPS 2000000
+
+typedef struct {
+  const char* name;
+  char (*keys)[32];
+  int count;
+} Workload;
+
+static void benchmarkWorkload(Workload* workload) {
+  map_int_t map;
+  chained_map_t chained;
+  map_init(&map);
+  memset(&chained, 0, sizeof(chained));
+  for (int i = 0; i < workload->count; i++) {
+    map_set(&map, workload->keys[i], i);
+    chained_map_set(&chained, workload->keys[i], &i, sizeof(i));
+  }
+
+  volatile int sum = 0;
+  double start = testSeconds();
+  for (int i = 0; i < LOOKUPS; i++) {
+    sum += *(int*) chained_map_get(&chained, workload->keys[i % workload->count]);
+  }
+  double chainedTime = testSeconds() - start;
+
+  start = testSeconds();
+  for (int i = 0; i < LOOKUPS; i++) {
+    sum += *map_get(&map, workload->keys[i % workload->count]);
+  }
+  double openTime = testSeconds() - start;
+
+  start = testSeconds();
+  for (int i = 0; i < LOOKUPS; i++) {
+    sum += chained_map_get(&chained, "lovrMissing") != NULL;
+  }
+  double chainedMissTime = testSeconds() - start;
+
+  start = testSeconds();
+  for (int i = 0; i < LOOKUPS; i++) {
+    sum += map_get(&map, "lovrMissing") != NULL;
+  }
+  double openMissTime = testSeconds() - start;
+
+  printf("%-10s %5d keys   hit %6.2f ns (chained %6.2f)   miss %6.2f ns (chained %6.2f)\n", workload->name, workload->count,
+    openTime * 1e9 / LOOKUPS, chainedTime * 1e9 / LOOKUPS, openMissTime * 1e9 / LOOKUPS, chainedMissTime * 1e9 / LOOKUPS);
+
+  map_deinit(&map);
+  chained_map_deinit(&chained);
+}
+
+static void benchmark() {
+  static const char* uniformNames[] = {
+    "lovrModel", "lovrView", "lovrProjection", "lovrTransform", "lovrNormalMatrix", "lovrColor",
+    "lovrDiffuseColor", "lovrEmissiveColor", "lovrDiffuseTexture", "lovrEmissiveTexture",
+    "lovrMetalnessTexture", "lovrRoughnessTexture", "lovrOcclusionTexture", "lovrNormalTexture",
+    "lovrEnvironmentTexture", "lovrMetalness", "lovrRoughness", "lovrPose", "lovrViewportCount",
+    "lovrPoint", "lovrPointSize", "lovrDirection", "lovrLightColor", "lovrTime"
+  };
+
+  static char uniforms[24][32], nodes[200][32], kerning[4096][32];
+  for (int i = 0; i < 24; i++) {
+    snprintf(uniforms[i], 32, "%s", uniformNames[i]);
+  }
+  for (int i = 0; i < 200; i++) {
+    snprintf(nodes[i], 32, "Bone.%03d", i);
+  }
+  for (int i = 0; i < 4096; i++) {
+    snprintf(kerning[i], 32, "%d,%d", 32 + i / 64, 32 + i % 64);
+  }
+
+  Workload workloads[] = {
+    { "uniforms", uniforms, 24 },
+    { "nodes", nodes, 200 },
+    { "kerning", kerning, 4096 }
+  };
+
+  for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+    benchmarkWorkload(&workloads[i]);
+  }
+}
+
+int main(int argc, char** argv) {
+  for (int i = 0; i < COUNT; i++) {
+    snprintf(keys[i], 32, "key%d", i);
+  }
+
+  testSetGet();
+  testStability();
+  testRemove();
+  testIterate();
+
+  if (testWantsBenchmarks(argc, argv)) {
+    benchmark();
+  }
+
+  return testFailures;
+}
@@ -0,0 +1,169 @@
+/** 
+ * Copyright (c) 2014 rxi
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ */
+
+// The chained map that lib/map used before it switched to open addressing, renamed so the map
+// benchmark can compare the two.  Only the functions the benchmark needs are kept.
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct chained_node_t chained_node_t;
+
+typedef struct {
+  chained_node_t **buckets;
+  unsigned nbuckets, nnodes;
+} chained_map_t;
+
+void chained_map_deinit(chained_map_t *m);
+void *chained_map_get(chained_map_t *m, const char *key);
+int chained_map_set(chained_map_t *m, const char *key, void *value, int vsize);
+
+struct chained_node_t {
+  unsigned hash;
+  void *value;
+  chained_node_t *next;
+  /* char key[]; */
+  /* char value[]; */
+};
+
+
+static unsigned chained_hash(const char *str) {
+  unsigned hash = 5381;
+  while (*str) {
+    hash = ((hash << 5) + hash) ^ *str++;
+  }
+  return hash;
+}
+
+
+static chained_node_t *chained_newnode(const char *key, void *value, int vsize) {
+  chained_node_t *node;
+  int ksize = strlen(key) + 1;
+  int voffset = ksize + ((sizeof(void*) - ksize) % sizeof(void*));
+  node = malloc(sizeof(*node) + voffset + vsize);
+  if (!node) return NULL;
+  memcpy(node + 1, key, ksize);
+  node->hash = chained_hash(key);
+  node->value = ((char*) (node + 1)) + voffset;
+  memcpy(node->value, value, vsize);
+  return node;
+}
+
+
+static int chained_bucketidx(chained_map_t *m, unsigned hash) {
+  /* If the implementation is changed to allow a non-power-of-2 bucket count,
+   * the line below should be changed to use mod instead of AND */
+  return hash & (m->nbuckets - 1);
+}
+
+
+static void chained_addnode(chained_map_t *m, chained_node_t *node) {
+  int n = chained_bucketidx(m, node->hash);
+  node->next = m->buckets[n];
+  m->buckets[n] = node;
+}
+
+
+static int chained_resize(chained_map_t *m, int nbuckets) {
+  chained_node_t *nodes, *node, *next;
+  chained_node_t **buckets;
+  int i; 
+  /* Chain all nodes together */
+  nodes = NULL;
+  i = m->nbuckets;
+  while (i--) {
+    node = (m->buckets)[i];
+    while (node) {
+      next = node->next;
+      node->next = nodes;
+      nodes = node;
+      node = next;
+    }
+  }
+  /* Reset buckets */
+  buckets = realloc(m->buckets, sizeof(*m->buckets) * nbuckets);
+  if (buckets != NULL) {
+    m->buckets = buckets;
+    m->nbuckets = nbuckets;
+  }
+  if (m->buckets) {
+    memset(m->buckets, 0, sizeof(*m->buckets) * m->nbuckets);
+    /* Re-add nodes to buckets */
+    node = nodes;
+    while (node) {
+      next = node->next;
+      chained_addnode(m, node);
+      node = next;
+    }
+  }
+  /* Return error code if realloc() failed */
+  return (buckets == NULL) ? -1 : 0;
+}
+
+
+static chained_node_t **chained_getref(chained_map_t *m, const char *key) {
+  unsigned hash = chained_hash(key);
+  chained_node_t **next;
+  if (m->nbuckets > 0) {
+    next = &m->buckets[chained_bucketidx(m, hash)];
+    while (*next) {
+      if ((*next)->hash == hash && !strcmp((char*) (*next + 1), key)) {
+        return next;
+      }
+      next = &(*next)->next;
+    }
+  }
+  return NULL;
+}
+
+
+void chained_map_deinit(chained_map_t *m) {
+  chained_node_t *next, *node;
+  int i;
+  i = m->nbuckets;
+  while (i--) {
+    node = m->buckets[i];
+    while (node) {
+      next = node->next;
+      free(node);
+      node = next;
+    }
+  }
+  free(m->buckets);
+}
+
+
+void *chained_map_get(chained_map_t *m, const char *key) {
+  chained_node_t **next = chained_getref(m, key);
+  return next ? (*next)->value : NULL;
+}
+
+
+int chained_map_set(chained_map_t *m, const char *key, void *value, int vsize) {
+  int n, err;
+  chained_node_t **next, *node;
+  /* Find & replace existing node */
+  next = chained_getref(m, key);
+  if (next) {
+    memcpy((*next)->value, value, vsize);
+    return 0;
+  }
+  /* Add new node */
+  node = chained_newnode(key, value, vsize);
+  if (node == NULL) goto fail;
+  if (m->nnodes >= m->nbuckets) {
+    n = (m->nbuckets > 0) ? (m->nbuckets << 1) : 1;
+    err = chained_resize(m, n);
+    if (err) goto fail;
+  }
+  chained_addnode(m, node);
+  m->nnodes++;
+  return 0;
+  fail:
+  if (node) free(node);
+  return -1;
+}
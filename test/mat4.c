@@ -0,0 +1,248 @@
+#include "test.h"
+#include "math/mat4.h"
+#include <math.h>
+
+// Compares the accelerated mat4 kernels (SSE or NEON, whichever this build selected) against the
+// scalar reference path, and the affine inverse against the general inverse.
+
+mat4 scalar_mat4_multiply(mat4 m, mat4 n);
+void scalar_mat4_transform(mat4 m, vec3 v);
+void scalar_mat4_transformArray(mat4 m, float* points, int count);
+mat4 scalar_mat4_invert(mat4 m);
+
+#define COUNT 1024
+#define EPSILON 1e-4f
+
+static bool nearlyEqual(float* a, float* b, int count) {
+  for (int i = 0; i < count; i++) {
+    float tolerance = EPSILON * fmaxf(1.f, fmaxf(fabsf(a[i]), fabsf(b[i])));
+    if (!(fabsf(a[i] - b[i]) <= tolerance)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void randomMatrix(uint32_t* seed, mat4 m) {
+  for (int i = 0; i < 16; i++) {
+    m[i] = testRandomRange(seed, -2.f, 2.f);
+  }
+}
+
+static void randomAffine(uint32_t* seed, mat4 m) {
+  float x = testRandomRange(seed, -10.f, 10.f);
+  float y = testRandomRange(seed, -10.f, 10.f);
+  float z = testRandomRange(seed, -10.f, 10.f);
+  float s = testRandomRange(seed, .5f, 2.f);
+  float angle = testRandomRange(seed, -3.14f, 3.14f);
+  float ax = testRandomRange(seed, -1.f, 1.f);
+  float ay = testRandomRange(seed, -1.f, 1.f);
+  float az = testRandomRange(seed, .1f, 1.f);
+  mat4_setTransform(m, x, y, z, s, s * 1.5f, s * .75f, angle, ax, ay, az);
+}
+
+static void testMultiply() {
+  uint32_t seed = 1;
+  for (int i = 0; i < COUNT; i++) {
+    float a[16], b[16], expected[16];
+    randomMatrix(&seed, a);
+    randomMatrix(&seed, b);
+    scalar_mat4_multiply(mat4_set(expected, a), b);
+    mat4_multiply(a, b);
+    check(nearlyEqual(a, expected, 16), "mat4_multiply differs from the scalar path (matrix %d)", i);
+  }
+
+  // The result is written over m, which can also be n
+  float m[16], expected[16];
+  randomMatrix(&seed, m);
+  scalar_mat4_multiply(mat4_set(expected, m), m);
+  mat4_multiply(m, m);
+  check(nearlyEqual(m, expected, 16), "mat4_multiply is wrong when m and n alias");
+}
+
+static void testInvert() {
+  uint32_t seed = 6;
+  for (int i = 0; i < COUNT; i++) {
+    float m[16], expected[16];
+    randomMatrix(&seed, m);
+    bool invertible = scalar_mat4_invert(mat4_set(expected, m));
+    check(!!mat4_invert(m) == invertible && (!invertible || nearlyEqual(m, expected, 16)), "mat4_invert differs from the scalar path (matrix %d)", i);
+  }
+
+  // Singular matrices are reported and left alone
+  float m[16], original[16];
+  mat4_scale(mat4_identity(m), 2.f, 0.f, 1.f);
+  mat4_set(original, m);
+  check(!mat4_invert(m) && !memcmp(m, original, sizeof(m)), "mat4_invert modified a singular matrix");
+}
+
+static void testTransform() {
+  uint32_t seed = 7;
+  for (int i = 0; i < COUNT; i++) {
+    float m[16], v[3], expected[3];
+    randomAffine(&seed, m);
+    for (int j = 0; j < 3; j++) {
+      v[j] = expected[j] = testRandomRange(&seed, -100.f, 100.f);
+    }
+    scalar_mat4_transform(m, expected);
+    mat4_transform(m, v);
+    check(nearlyEqual(v, expected, 3), "mat4_transform differs from the scalar path (point %d)", i);
+  }
+}
+
+static void testMultiplyArray() {
+  uint32_t seed = 2;
+  static float matrices[16 * COUNT], expected[16 * COUNT];
+  float m[16];
+  randomMatrix(&seed, m);
+  for (int i = 0; i < COUNT; i++) {
+    randomMatrix(&seed, matrices + 16 * i);
+    scalar_mat4_multiply(mat4_set(expected + 16 * i, m), matrices + 16 * i);
+  }
+
+  mat4_multiplyArray(m, matrices, COUNT);
+  check(nearlyEqual(matrices, expected, 16 * COUNT), "mat4_multiplyArray differs from multiplying one at a time");
+}
+
+static void testTransformArray() {
+  uint32_t seed = 3;
+  static float points[3 * COUNT], expected[3 * COUNT];
+  float m[16];
+  randomAffine(&seed, m);
+  for (int i = 0; i < 3 * COUNT; i++) {
+    points[i] = expected[i] = testRandomRange(&seed, -100.f, 100.f);
+  }
+
+  for (int i = 0; i < COUNT; i++) {
+    scalar_mat4_transform(m, expected + 3 * i);
+  }
+
+  mat4_transformArray(m, points, COUNT);
+  check(nearlyEqual(points, expected, 3 * COUNT), "mat4_transformArray differs from the scalar mat4_transform");
+
+  // An empty batch shouldn't touch anything
+  float sentinel[3] = { 1.f, 2.f, 3.f };
+  mat4_transformArray(m, sentinel, 0);
+  check(sentinel[0] == 1.f && sentinel[1] == 2.f && sentinel[2] == 3.f, "mat4_transformArray wrote past a batch of 0");
+}
+
+static void testInvertAffine() {
+  uint32_t seed = 4;
+  static float matrices[16 * COUNT], expected[16 * COUNT];
+  for (int i = 0; i < COUNT; i++) {
+    randomAffine(&seed, matrices + 16 * i);
+    check(scalar_mat4_invert(mat4_set(expected + 16 * i, matrices + 16 * i)), "Affine matrix %d is singular", i);
+  }
+
+  float m[16];
+  mat4_set(m, matrices);
+  check(mat4_invertAffine(m) && nearlyEqual(m, expected, 16), "mat4_invertAffine differs from mat4_invert");
+
+  int failures = mat4_invertAffineArray(matrices, COUNT);
+  check(failures == 0, "mat4_invertAffineArray failed to invert %d matrices", failures);
+  check(nearlyEqual(matrices, expected, 16 * COUNT), "mat4_invertAffineArray differs from mat4_invert");
+
+  // Singular matrices are reported and left alone
+  float singular[32];
+  randomAffine(&seed, singular);
+  mat4_scale(mat4_identity(singular + 16), 1.f, 0.f, 1.f);
+  float original[32];
+  memcpy(original, singular, sizeof(singular));
+  failures = mat4_invertAffineArray(singular, 2);
+  check(failures == 1, "mat4_invertAffineArray reported %d failures instead of 1", failures);
+  check(!memcmp(singular + 16, original + 16, 16 * sizeof(float)), "mat4_invertAffineArray modified a singular matrix");
+}
+
+// Benchmarks
+
+#define ITERATIONS 200
+static volatile float sink;
+
+static void benchmarkMultiply(const char* name, mat4 (*multiply)(mat4, mat4), float* matrices) {
+  float m[16];
+  mat4_identity(m);
+  double start = testSeconds();
+  for (int j = 0; j < ITERATIONS; j++) {
+    for (int i = 0; i < COUNT; i++) {
+      multiply(m, matrices + 16 * i);
+    }
+    mat4_identity(m);
+  }
+  double elapsed = testSeconds() - start;
+  sink += m[0];
+  printf("%-28s %8.2f ns/matrix\n", name, elapsed * 1e9 / (ITERATIONS * COUNT));
+}
+
+static void benchmarkTransform(const char* name, void (*transform)(mat4, float*, int), mat4 m, float* points) {
+  double start = testSeconds();
+  for (int j = 0; j < ITERATIONS; j++) {
+    transform(m, points, COUNT);
+  }
+  double elapsed = testSeconds() - start;
+  sink += points[0];
+  printf("%-28s %8.2f ns/point\n", name, elapsed * 1e9 / (ITERATIONS * COUNT));
+}
+
+static void benchmarkTransformPoint(const char* name, void (*transform)(mat4, vec3), mat4 m, float* points) {
+  double start = testSeconds();
+  for (int j = 0; j < ITERATIONS; j++) {
+    for (int i = 0; i < COUNT; i++) {
+      transform(m, points + 3 * i);
+    }
+  }
+  double elapsed = testSeconds() - start;
+  sink += points[0];
+  printf("%-28s %8.2f ns/point\n", name, elapsed * 1e9 / (ITERATIONS * COUNT));
+}
+
+static void benchmarkInvert(const char* name, mat4 (*invert)(mat4), float* matrices) {
+  double start = testSeconds();
+  for (int j = 0; j < ITERATIONS; j++) {
+    for (int i = 0; i < COUNT; i++) {
+      invert(matrices + 16 * i);
+    }
+  }
+  double elapsed = testSeconds() - start;
+  sink += matrices[0];
+  printf("%-28s %8.2f ns/matrix\n", name, elapsed * 1e9 / (ITERATIONS * COUNT));
+}
+
+static void benchmark() {
+  uint32_t seed = 5;
+  static float matrices[16 * COUNT], points[3 * COUNT];
+  float m[16];
+
+  // Rotations keep the running products, repeated transforms and repeated inverses finite
+  mat4_setTransform(m, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+  for (int i = 0; i < COUNT; i++) {
+    mat4_setTransform(matrices + 16 * i, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f, testRandomRange(&seed, -3.f, 3.f), 0.f, 1.f, 0.f);
+  }
+  for (int i = 0; i < 3 * COUNT; i++) {
+    points[i] = testRandomRange(&seed, -1.f, 1.f);
+  }
+
+  benchmarkMultiply("mat4_multiply (scalar)", scalar_mat4_multiply, matrices);
+  benchmarkMultiply("mat4_multiply", mat4_multiply, matrices);
+  benchmarkTransform("mat4_transformArray (scalar)", scalar_mat4_transformArray, m, points);
+  benchmarkTransform("mat4_transformArray", mat4_transformArray, m, points);
+  benchmarkTransformPoint("mat4_transform (scalar)", scalar_mat4_transform, m, points);
+  benchmarkTransformPoint("mat4_transform", mat4_transform, m, points);
+  benchmarkInvert("mat4_invert (scalar)", scalar_mat4_invert, matrices);
+  benchmarkInvert("mat4_invert", mat4_invert, matrices);
+  benchmarkInvert("mat4_invertAffine", mat4_invertAffine, matrices);
+}
+
+int main(int argc, char** argv) {
+  testMultiply();
+  testInvert();
+  testTransform();
+  testMultiplyArray();
+  testTransformArray();
+  testInvertAffine();
+
+  if (testWantsBenchmarks(argc, argv)) {
+    benchmark();
+  }
+
+  return testFailures;
+}
@@ -0,0 +1,26 @@
+// The scalar reference path: mat4.c built a second time with SIMD disabled, with every function
+// renamed so it can be linked next to the accelerated build.
+#define LOVR_NO_SIMD
+#define mat4_set scalar_mat4_set
+#define mat4_fromMat34 scalar_mat4_fromMat34
+#define mat4_fromMat44 scalar_mat4_fromMat44
+#define mat4_identity scalar_mat4_identity
+#define mat4_invert scalar_mat4_invert
+#define mat4_invertAffine scalar_mat4_invertAffine
+#define mat4_transpose scalar_mat4_transpose
+#define mat4_multiply scalar_mat4_multiply
+#define mat4_translate scalar_mat4_translate
+#define mat4_rotate scalar_mat4_rotate
+#define mat4_rotateQuat scalar_mat4_rotateQuat
+#define mat4_scale scalar_mat4_scale
+#define mat4_getTransform scalar_mat4_getTransform
+#define mat4_setTransform scalar_mat4_setTransform
+#define mat4_orthographic scalar_mat4_orthographic
+#define mat4_perspective scalar_mat4_perspective
+#define mat4_lookAt scalar_mat4_lookAt
+#define mat4_transform scalar_mat4_transform
+#define mat4_transformDirection scalar_mat4_transformDirection
+#define mat4_multiplyArray scalar_mat4_multiplyArray
+#define mat4_transformArray scalar_mat4_transformArray
+#define mat4_invertAffineArray scalar_mat4_invertAffineArray
+#include "math/mat4.c"
@@ -0,0 +1,5 @@
+function lovr.conf(t)
+  t.identity = 'objects-benchmark'
+  t.modules.audio = false
+  t.modules.physics = false
+end
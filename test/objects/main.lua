@@ -0,0 +1,26 @@
+-- Pushes objects to Lua in bulk.  The report's scopes separate objects that Lua already holds a
+-- handle to, which go through the object registry, from new objects, which skip it:
+--
+--   lovr test/objects --benchmark 300
+
+local count = 20000
+local font
+
+-- Holding on to the font keeps its handle alive, so getFont always finds it in the registry
+function lovr.load()
+  font = lovr.graphics.getFont()
+end
+
+function lovr.update()
+  lovr.timer.push('existing')
+  for i = 1, count do
+    lovr.graphics.getFont()
+  end
+  lovr.timer.pop()
+
+  lovr.timer.push('new')
+  for i = 1, count do
+    lovr.math.newTransform()
+  end
+  lovr.timer.pop()
+end
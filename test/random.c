@@ -0,0 +1,196 @@
+#include "test.h"
+#include "math/math.h"
+#include "math/randomGenerator.h"
+#include <math.h>
+#include <stdlib.h>
+
+// Statistical checks for the bulk fills.  Every stream is seeded the same way on each run, so the
+// thresholds are fixed and a failure means the output really changed.  The bounds are loose
+// enough (around 4 standard errors) that a correct generator passes with any seed.
+
+#define COUNT 1000000
+#define BINS 100
+
+static float data[4 * COUNT];
+
+static void testUniform(RandomGenerator* generator) {
+  float params[4] = { -2.f, 6.f };
+  lovrRandomGeneratorFill(generator, DISTRIBUTION_UNIFORM, params, data, COUNT, 1, sizeof(float));
+
+  double sum = 0., sumSquares = 0., lag1 = 0., lag8 = 0.;
+  int histogram[BINS] = { 0 };
+  int outOfRange = 0;
+  for (int i = 0; i < COUNT; i++) {
+    double x = (data[i] + 2.) / 8.;
+    outOfRange += !(x >= 0. && x < 1.);
+    histogram[MIN((int) (x * BINS), BINS - 1)]++;
+    sum += x;
+    sumSquares += x * x;
+    lag1 += i >= 1 ? (x - .5) * ((data[i - 1] + 2.) / 8. - .5) : 0.;
+    lag8 += i >= 8 ? (x - .5) * ((data[i - 8] + 2.) / 8. - .5) : 0.;
+  }
+
+  double mean = sum / COUNT;
+  double variance = sumSquares / COUNT - mean * mean;
+  double expected = (double) COUNT / BINS;
+  double chiSquare = 0.;
+  for (int i = 0; i < BINS; i++) {
+    chiSquare += (histogram[i] - expected) * (histogram[i] - expected) / expected;
+  }
+
+  // Neighboring samples come from different lanes, and samples 8 apart from the same lane
+  double correlation1 = lag1 / (COUNT - 1) * 12.;
+  double correlation8 = lag8 / (COUNT - 8) * 12.;
+
+  check(outOfRange == 0, "uniform: %d samples were outside [min, max)", outOfRange);
+  check(fabs(mean - .5) < .002, "uniform: mean is %f, expected .5", mean);
+  check(fabs(variance - 1. / 12.) < .0005, "uniform: variance is %f, expected %f", variance, 1. / 12.);
+  check(chiSquare < 99. + 4. * sqrt(2. * 99.), "uniform: chi-square over %d bins is %f", BINS, chiSquare);
+  check(fabs(correlation1) < .005, "uniform: lag 1 correlation is %f", correlation1);
+  check(fabs(correlation8) < .005, "uniform: lag 8 correlation is %f", correlation8);
+}
+
+static void testNormal(RandomGenerator* generator) {
+  float params[4] = { 2.f, 5.f };
+  lovrRandomGeneratorFill(generator, DISTRIBUTION_NORMAL, params, data, COUNT, 3, 3 * sizeof(float));
+
+  double moments[5] = { 0. };
+  for (int i = 0; i < 3 * COUNT; i++) {
+    double x = (data[i] - 5.) / 2.;
+    double x2 = x * x;
+    moments[1] += x;
+    moments[2] += x2;
+    moments[3] += x2 * x;
+    moments[4] += x2 * x2;
+  }
+
+  int n = 3 * COUNT;
+  double mean = moments[1] / n, variance = moments[2] / n, skew = moments[3] / n, kurtosis = moments[4] / n;
+  check(fabs(mean) < .005, "normal: mean is %f standard deviations off", mean);
+  check(fabs(variance - 1.) < .005, "normal: variance is %f, expected 1", variance);
+  check(fabs(skew) < .01, "normal: skewness is %f, expected 0", skew);
+  check(fabs(kurtosis - 3.) < .03, "normal: kurtosis is %f, expected 3", kurtosis);
+}
+
+static void testSphere(RandomGenerator* generator) {
+  for (int components = 2; components <= 3; components++) {
+    float params[4] = { 3.f };
+    lovrRandomGeneratorFill(generator, DISTRIBUTION_SPHERE, params, data, COUNT, components, components * sizeof(float));
+
+    double maxError = 0.;
+    double centroid[3] = { 0. };
+    for (int i = 0; i < COUNT; i++) {
+      float* v = data + components * i;
+      double length = 0.;
+      for (int c = 0; c < components; c++) {
+        length += v[c] * v[c];
+        centroid[c] += v[c] / COUNT;
+      }
+      maxError = fmax(maxError, fabs(sqrt(length) - 3.));
+    }
+
+    check(maxError < 1e-5 * 3., "sphere: a %d component sample is %f away from the radius", components, maxError);
+    for (int c = 0; c < components; c++) {
+      check(fabs(centroid[c]) < .01, "sphere: %d component centroid is off by %f on axis %d", components, centroid[c], c);
+    }
+  }
+}
+
+static void testBox(RandomGenerator* generator) {
+  float params[4] = { 1.f, 2.f, 4.f, 8.f };
+  lovrRandomGeneratorFill(generator, DISTRIBUTION_BOX, params, data, COUNT, 4, 4 * sizeof(float));
+
+  int outside = 0;
+  double mean[4] = { 0. };
+  for (int i = 0; i < COUNT; i++) {
+    for (int c = 0; c < 4; c++) {
+      float x = data[4 * i + c];
+      outside += !(x >= -params[c] / 2.f && x <= params[c] / 2.f);
+      mean[c] += x / params[c] / COUNT;
+    }
+  }
+
+  check(outside == 0, "box: %d coordinates were outside the box", outside);
+  for (int c = 0; c < 4; c++) {
+    check(fabs(mean[c]) < .002, "box: axis %d is off center by %f of its size", c, mean[c]);
+  }
+}
+
+// Strided fills write the components of each element and leave the rest of the stride alone
+static void testStride(RandomGenerator* generator) {
+  for (int i = 0; i < 4 * COUNT; i++) {
+    data[i] = -1.f;
+  }
+
+  int count = 1000;
+  float params[4] = { 0.f, 1.f };
+  lovrRandomGeneratorFill(generator, DISTRIBUTION_UNIFORM, params, data, count, 3, 4 * sizeof(float));
+
+  int written = 0, untouched = 0;
+  for (int i = 0; i < count; i++) {
+    for (int c = 0; c < 3; c++) {
+      written += data[4 * i + c] >= 0.f;
+    }
+    untouched += data[4 * i + 3] == -1.f;
+  }
+
+  check(written == 3 * count, "stride: %d of %d components were written", written, 3 * count);
+  check(untouched == count, "stride: %d of %d padding floats were overwritten", count - untouched, count);
+  check(data[4 * count] == -1.f, "stride: the fill wrote past its last element");
+}
+
+// Restoring the state reproduces a fill exactly
+static void testState(RandomGenerator* generator) {
+  char state[32];
+  float a[100], b[100];
+  float params[4] = { 0.f, 1.f };
+  lovrRandomGeneratorGetState(generator, state, sizeof(state));
+  lovrRandomGeneratorFill(generator, DISTRIBUTION_UNIFORM, params, a, 100, 1, sizeof(float));
+  lovrRandomGeneratorSetState(generator, state, sizeof(state));
+  lovrRandomGeneratorFill(generator, DISTRIBUTION_UNIFORM, params, b, 100, 1, sizeof(float));
+  check(!memcmp(a, b, sizeof(a)), "state: restoring the state didn't reproduce the fill");
+}
+
+// Samples per second from the bulk fills and from calling the scalar generator in a loop
+static void benchmark(RandomGenerator* generator) {
+  double start = testSeconds();
+  volatile double sum = 0.;
+  for (int i = 0; i < COUNT; i++) {
+    sum += lovrRandomGeneratorRandom(generator);
+  }
+  printf("%-26s %6.1f Msamples/s\n", "scalar", COUNT / (testSeconds() - start) / 1e6);
+
+  struct { const char* name; RandomDistribution distribution; float params[4]; int components; size_t stride; } fills[] = {
+    { "uniform", DISTRIBUTION_UNIFORM, { 0.f, 1.f }, 1, sizeof(float) },
+    { "uniform (strided)", DISTRIBUTION_UNIFORM, { 0.f, 1.f }, 1, 4 * sizeof(float) },
+    { "normal", DISTRIBUTION_NORMAL, { 1.f, 0.f }, 1, sizeof(float) },
+    { "sphere", DISTRIBUTION_SPHERE, { 1.f }, 3, 3 * sizeof(float) },
+    { "box", DISTRIBUTION_BOX, { 1.f, 1.f, 1.f }, 3, 3 * sizeof(float) }
+  };
+
+  for (size_t i = 0; i < sizeof(fills) / sizeof(fills[0]); i++) {
+    int count = fills[i].stride > fills[i].components * sizeof(float) ? COUNT : COUNT * 4 / fills[i].components;
+    start = testSeconds();
+    lovrRandomGeneratorFill(generator, fills[i].distribution, fills[i].params, data, count, fills[i].components, fills[i].stride);
+    double elapsed = testSeconds() - start;
+    printf("%-26s %6.1f Melements/s\n", fills[i].name, count / elapsed / 1e6);
+  }
+}
+
+int main(int argc, char** argv) {
+  RandomGenerator* generator = lovrRandomGeneratorCreate();
+
+  testUniform(generator);
+  testNormal(generator);
+  testSphere(generator);
+  testBox(generator);
+  testStride(generator);
+  testState(generator);
+
+  if (testWantsBenchmarks(argc, argv)) {
+    benchmark(generator);
+  }
+
+  lovrRelease(generator);
+  return testFailures;
+}
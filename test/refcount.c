@@ -0,0 +1,157 @@
+#include "test.h"
+#include <stdlib.h>
+
+// Shared objects are retained and released from several threads at once, the way Blobs and other
+// Variants are when they're sent through a Channel.  Every object has to be destroyed exactly once.
+
+#define THREADS 8
+#define ITERATIONS 200000
+#define OBJECTS 20000
+
+typedef struct {
+  Ref ref;
+  int destroyed;
+} Object;
+
+static int destroyedCount;
+static mtx_t destroyedLock;
+
+// Threads wait for each other before starting so their loops actually overlap
+static mtx_t startLock;
+static cnd_t startSignal;
+static bool started;
+
+static void waitForStart() {
+  mtx_lock(&startLock);
+  while (!started) {
+    cnd_wait(&startSignal, &startLock);
+  }
+  mtx_unlock(&startLock);
+}
+
+static void start() {
+  mtx_lock(&startLock);
+  started = true;
+  cnd_broadcast(&startSignal);
+  mtx_unlock(&startLock);
+}
+
+// Objects are freed by the tests instead, so they can still check how often this ran
+static void lovrObjectDestroy(void* ref) {
+  Object* object = ref;
+  mtx_lock(&destroyedLock);
+  object->destroyed++;
+  destroyedCount++;
+  mtx_unlock(&destroyedLock);
+}
+
+static Object* lovrObjectCreate() {
+  Object* object = lovrAlloc(sizeof(Object), lovrObjectDestroy);
+  object->destroyed = 0;
+  lovrShare(object);
+  return object;
+}
+
+// Every thread takes and drops references to the same object
+static int hammer(void* userdata) {
+  Object* object = userdata;
+  waitForStart();
+  for (int i = 0; i < ITERATIONS; i++) {
+    lovrRetain(object);
+    lovrRetain(object);
+    lovrRelease(object);
+    lovrRelease(object);
+  }
+  return 0;
+}
+
+static void testHammer() {
+  Object* object = lovrObjectCreate();
+  thrd_t threads[THREADS];
+  started = false;
+  for (int i = 0; i < THREADS; i++) {
+    thrd_create(&threads[i], hammer, object);
+  }
+  start();
+
+  for (int i = 0; i < THREADS; i++) {
+    thrd_join(threads[i], NULL);
+  }
+
+  check(object->ref.count == 1, "Expected 1 reference after the threads finished, got %d", object->ref.count);
+  check(object->destroyed == 0, "Object was destroyed while a reference was still held");
+  lovrRelease(object);
+  check(object->destroyed == 1, "Object was destroyed %d times", object->destroyed);
+  free(object);
+}
+
+// Two threads race to drop the last reference to each object, so exactly one of them frees it
+static Object* objects[OBJECTS];
+
+static int releaseAll(void* userdata) {
+  waitForStart();
+  for (int i = 0; i < OBJECTS; i++) {
+    lovrRelease(objects[i]);
+  }
+  return 0;
+}
+
+static void testLastRelease() {
+  destroyedCount = 0;
+  for (int i = 0; i < OBJECTS; i++) {
+    objects[i] = lovrObjectCreate();
+    lovrRetain(objects[i]);
+  }
+
+  thrd_t thread;
+  started = false;
+  thrd_create(&thread, releaseAll, NULL);
+  start();
+  releaseAll(NULL);
+  thrd_join(thread, NULL);
+
+  check(destroyedCount == OBJECTS, "Destroyed %d objects instead of %d", destroyedCount, OBJECTS);
+  for (int i = 0; i < OBJECTS; i++) {
+    check(objects[i]->destroyed == 1, "Object %d was destroyed %d times", i, objects[i]->destroyed);
+    free(objects[i]);
+  }
+}
+
+// Unshared objects keep the plain increment, shared ones pay for the atomic
+static void benchmark() {
+  int count = 50000000;
+  Object* object = lovrAlloc(sizeof(Object), lovrObjectDestroy);
+
+  for (int shared = 0; shared <= 1; shared++) {
+    if (shared) {
+      lovrShare(object);
+    }
+
+    double start = testSeconds();
+    for (int i = 0; i < count; i++) {
+      lovrRetain(object);
+      lovrRelease(object);
+    }
+    double elapsed = testSeconds() - start;
+    printf("%-30s %6.2f ns/pair\n", shared ? "retain + release (shared)" : "retain + release (unshared)", elapsed * 1e9 / count);
+  }
+
+  free(object);
+}
+
+int main(int argc, char** argv) {
+  mtx_init(&destroyedLock, mtx_plain);
+  mtx_init(&startLock, mtx_plain);
+  cnd_init(&startSignal);
+  testHammer();
+  testLastRelease();
+
+  if (testWantsBenchmarks(argc, argv)) {
+    benchmark();
+  }
+
+  mtx_destroy(&destroyedLock);
+  mtx_destroy(&startLock);
+  cnd_destroy(&startSignal);
+  return testFailures;
+}
@@ -0,0 +1,53 @@
+-- Writes a small headset recording to the save directory and replays it by setting
+-- t.headset.replay, with no --replay on the command line.  main.lua checks that the replay driver
+-- was picked and that every frame comes back as it was written, with the dt it was written with.
+
+frames = 30
+
+-- Recordings use native byte order, this assumes a little endian machine
+local function uint32(n)
+  return string.char(n % 256, math.floor(n / 256) % 256, math.floor(n / 65536) % 256, math.floor(n / 16777216) % 256)
+end
+
+local function float(x)
+  if x == 0 then return uint32(0) end
+  local sign = x < 0 and 2 ^ 31 or 0
+  local mantissa, exponent = math.frexp(math.abs(x))
+  return uint32(sign + (exponent + 126) * 2 ^ 23 + math.floor((mantissa * 2 - 1) * 2 ^ 23 + .5))
+end
+
+function framePosition(i)
+  return i * .25, 1.5, -i * .125
+end
+
+function frameDelta(i)
+  return (10 + i) / 1000
+end
+
+function lovr.conf(t)
+  local chunks = {
+    uint32(0x5052564c), -- magic
+    uint32(1), -- version
+    uint32(0), -- unknown headset type
+    uint32(0), -- head origin
+    float(2), float(2) -- bounds
+  }
+
+  for i = 1, frames do
+    local x, y, z = framePosition(i)
+    table.insert(chunks, float(frameDelta(i)))
+    for _, value in ipairs({ x, y, z, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0 }) do
+      table.insert(chunks, float(value))
+    end
+    table.insert(chunks, uint32(0)) -- controllers
+  end
+
+  t.identity = 'replay-test'
+  lovr.filesystem.setIdentity(t.identity)
+  lovr.filesystem.write('replay.rec', table.concat(chunks))
+
+  t.headset.replay = 'replay.rec'
+  t.window.visible = false
+  t.modules.audio = false
+  t.modules.physics = false
+end
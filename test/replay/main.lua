@@ -0,0 +1,26 @@
+local frame = 0
+
+function lovr.update(dt)
+  assert(lovr.headset.getDriver() == 'replay', 'Expected the replay driver, got ' .. tostring(lovr.headset.getDriver()))
+
+  frame = frame + 1
+  local x, y, z = lovr.headset.getPosition()
+  local ex, ey, ez = framePosition(frame)
+  if math.abs(x - ex) > 1e-6 or math.abs(y - ey) > 1e-6 or math.abs(z - ez) > 1e-6 then
+    error(('Frame %d replayed at %f, %f, %f instead of %f, %f, %f'):format(frame, x, y, z, ex, ey, ez))
+  end
+
+  -- The recording has no velocity and the eyes sit at the head, so a predicted eye is the head
+  local lx, ly, lz = lovr.headset.getPosition('left', .1)
+  if math.abs(lx - x) > 1e-5 or math.abs(ly - y) > 1e-5 or math.abs(lz - z) > 1e-5 then
+    error(('Frame %d predicted the left eye at %f, %f, %f instead of %f, %f, %f'):format(frame, lx, ly, lz, x, y, z))
+  end
+
+  if math.abs(dt - frameDelta(frame)) > 1e-6 then
+    error(('Frame %d replayed with a dt of %f instead of %f'):format(frame, dt, frameDelta(frame)))
+  end
+
+  if frame == frames then
+    lovr.event.quit(0)
+  end
+end
@@ -0,0 +1,20 @@
+-- Pass 'singlepass' after the project to render both eyes in one pass, the report is named after
+-- the mode so the two runs can be compared:
+--
+--   lovr test/stereo --benchmark 300 multipass
+--   lovr test/stereo --benchmark 300 singlepass
+
+function lovr.conf(t)
+  local mode = 'multipass'
+  for _, argument in ipairs(arg) do
+    if argument == 'singlepass' then
+      mode = 'singlepass'
+    end
+  end
+
+  t.identity = 'stereo-benchmark'
+  t.headset.stereo = mode
+  t.benchmark.report = mode .. '.json'
+  t.modules.audio = false
+  t.modules.physics = false
+end
@@ -0,0 +1,12 @@
+-- A grid of small cubes, so the frame is dominated by the per-draw work that single pass stereo
+-- does once instead of once per eye
+
+local size = 48
+
+function lovr.draw()
+  for x = 1, size do
+    for z = 1, size do
+      lovr.graphics.cube('fill', (x - size / 2) * .2, 0, -z * .2, .1)
+    end
+  end
+end
@@ -0,0 +1,35 @@
+#include "util.h"
+#include <stdio.h>
+#include <string.h>
+
+#pragma once
+
+// Tests return the number of failed checks from main, so ctest passes when it's 0.  Passing
+// --bench to a test also runs its benchmarks, which print timings but never fail.
+
+static int testFailures;
+
+#define check(c, ...) if (!(c)) { testFailures++; printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); }
+
+static inline bool testWantsBenchmarks(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--bench")) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static inline double testSeconds() {
+  return lovrGetTicks() / 1e9;
+}
+
+// Small deterministic generator so failures reproduce, independent of lovr's RandomGenerator
+static inline float testRandom(uint32_t* state) {
+  *state = *state * 1664525u + 1013904223u;
+  return (*state >> 8) / 16777216.f;
+}
+
+static inline float testRandomRange(uint32_t* state, float min, float max) {
+  return min + (max - min) * testRandom(state);
+}
@@ -0,0 +1,32 @@
+-- Draws thousands of cubes along deep transform hierarchies, deeper than the initial size of the
+-- transform stack.  Run it with the benchmark mode and compare the draw scope between builds:
+--
+--   lovr test/transforms --benchmark 300
+
+local chains = 32
+local depth = 128
+
+function lovr.draw()
+  local time = lovr.timer.getTime()
+
+  for i = 1, chains do
+    lovr.graphics.push()
+    lovr.graphics.rotate(i / chains * 2 * math.pi, 0, 1, 0)
+
+    for level = 1, depth do
+      lovr.graphics.push()
+      lovr.graphics.translate(0, .015, -.02)
+      lovr.graphics.rotate(math.sin(time + level * .1) * .05, 1, 0, 0)
+
+      -- The second draw at the same level reuses the matrices derived for the first
+      lovr.graphics.cube('fill', 0, 0, 0, .01)
+      lovr.graphics.cube('line', 0, 0, 0, .015)
+    end
+
+    for level = 1, depth do
+      lovr.graphics.pop()
+    end
+
+    lovr.graphics.pop()
+  end
+end